@@ -0,0 +1,41 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cstdlib>
+#include <new>
+
+#include "RuntimeStats.h"
+
+/*
+*  Replacement of the global operator new that counts the allocations for
+*  RuntimeStats. It is not part of the xes library, a host application
+*  keeps its own allocator; only the interpreter and the benchmarks are
+*  linked with it.
+*/
+void* operator new(size_t size)
+{
+	RuntimeCounters& counters = RuntimeStats::local();
+	counters.allocations++;
+	counters.allocatedBytes += size;
+
+	void* memory;
+	while ((memory = malloc(size > 0 ? size : 1)) == nullptr)
+	{
+		new_handler handler = get_new_handler();
+		if (handler == nullptr)
+		{
+			throw bad_alloc();
+		}
+		handler();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
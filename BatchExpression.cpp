@@ -0,0 +1,393 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cmath>
+
+#include "BatchExpression.h"
+#include "ExecutionBudget.h"
+#include "ParserFunction.h"
+#include "ScriptHelper.h"
+
+const size_t BatchExpression::BLOCK_SIZE;
+
+BatchExpression::BatchExpression(const string& script, const vector<string>& columns, const string& result) :
+	m_columns(columns), m_script(toScript(script)), m_resultName(result)
+{
+	m_vectorized = compile(m_script.getData());
+	m_names.clear();
+
+	if (!m_vectorized)
+	{
+		m_registers.clear();
+		m_instructions.clear();
+	}
+}
+
+ParsingScript BatchExpression::toScript(const string& script)
+{
+	unordered_map<size_t, size_t> char2Line;
+	string data = ScriptHelper::convertToScript(script, char2Line);
+
+	//the expression may be given without the closing ';'
+	if (!data.empty() && data.back() != Tokens::END_STATEMENT && data.back() != Tokens::END_GROUP)
+	{
+		data += Tokens::END_STATEMENT;
+	}
+
+	ParsingScript result(data);
+	result.setChar2Line(char2Line);
+	result.setRawScript(script);
+	return result;
+}
+
+bool BatchExpression::compile(const string& data)
+{
+	for (size_t i = 0; i < m_columns.size(); i++)
+	{
+		m_names[m_columns[i]] = addRegister(COLUMN, i);
+	}
+
+	//splits the script into statements, blocks mean control flow that stays with the Parser
+	vector<string> statements;
+	size_t start = 0;
+	int depth = 0;
+	bool inQuotes = false;
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		char ch = data[i];
+		if (ch == Tokens::QUOTE && (i == 0 || data[i - 1] != '\\'))
+		{
+			inQuotes = !inQuotes;
+		}
+		else if (inQuotes)
+		{
+			continue;
+		}
+		else if (ch == Tokens::START_GROUP)
+		{
+			return false;
+		}
+		else if (ch == Tokens::START_ARG)
+		{
+			depth++;
+		}
+		else if (ch == Tokens::END_ARG)
+		{
+			depth--;
+		}
+		else if (ch == Tokens::END_STATEMENT && depth == 0)
+		{
+			statements.push_back(data.substr(start, i - start));
+			start = i + 1;
+		}
+	}
+
+	if (start < data.size())
+	{
+		statements.push_back(data.substr(start));
+	}
+	if (statements.empty())
+	{
+		return false;
+	}
+
+	for (const string& statement : statements)
+	{
+		CompiledExpression expression(statement);
+		if (!expression.isCompiled())
+		{
+			return false;
+		}
+
+		m_result = compileNode(expression.getRoot());
+		if (m_result == UNSUPPORTED)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t BatchExpression::compileNode(const CompiledExpression::Node& node)
+{
+	switch (node.type)
+	{
+		case CompiledExpression::CONSTANT:
+			if (node.value.m_type != Tokens::NUMERIC)
+			{
+				return UNSUPPORTED;
+			}
+			return addRegister(CONSTANT, 0, node.value.m_numericValue);
+
+		case CompiledExpression::VARIABLE:
+		{
+			auto it = m_names.find(node.name);
+			if (it != m_names.end())
+			{
+				return it->second;
+			}
+
+			//read once per evaluate() call
+			size_t index = addRegister(SCRIPT_VARIABLE, 0, 0, node.name);
+			m_names[node.name] = index;
+			return index;
+		}
+
+		case CompiledExpression::NOT:
+		{
+			size_t value = compileNode(*node.left);
+			if (value == UNSUPPORTED)
+			{
+				return UNSUPPORTED;
+			}
+			return addInstruction(CompiledExpression::NONE, value, value, true);
+		}
+
+		case CompiledExpression::BINARY:
+		{
+			size_t left = compileNode(*node.left);
+			size_t right = left == UNSUPPORTED ? UNSUPPORTED : compileNode(*node.right);
+			if (right == UNSUPPORTED)
+			{
+				return UNSUPPORTED;
+			}
+			return addInstruction(node.op, left, right);
+		}
+
+		case CompiledExpression::ASSIGN:
+		{
+			size_t value = compileNode(*node.right);
+			if (value != UNSUPPORTED)
+			{
+				m_names[node.name] = value;
+			}
+			return value;
+		}
+
+		case CompiledExpression::OPERATOR_ASSIGN:
+		{
+			//the remaining ones (%=, &=, ...) differ for numbers and strings
+			CompiledExpression::Operator op = node.action.size() == 2 ?
+				CompiledExpression::toOperator(node.action.substr(0, 1)) : CompiledExpression::NONE;
+			if (op != CompiledExpression::ADD && op != CompiledExpression::SUB && op != CompiledExpression::MUL &&
+				op != CompiledExpression::DIV && op != CompiledExpression::POW)
+			{
+				return UNSUPPORTED;
+			}
+
+			CompiledExpression::Node variable;
+			variable.type = CompiledExpression::VARIABLE;
+			variable.name = node.name;
+
+			size_t right = compileNode(*node.right);
+			if (right == UNSUPPORTED)
+			{
+				return UNSUPPORTED;
+			}
+			size_t left = compileNode(variable);
+
+			size_t value = addInstruction(op, left, right);
+			m_names[node.name] = value;
+			return value;
+		}
+
+		case CompiledExpression::INCREMENT:
+		{
+			CompiledExpression::Node variable;
+			variable.type = CompiledExpression::VARIABLE;
+			variable.name = node.name;
+
+			size_t current = compileNode(variable);
+			size_t value = addInstruction(CompiledExpression::ADD, current, addRegister(CONSTANT, 0, node.delta));
+			m_names[node.name] = value;
+			return node.prefix ? value : current;
+		}
+
+		default:
+			return UNSUPPORTED;
+	}
+}
+
+size_t BatchExpression::addRegister(RegisterType type, size_t column, double value, const string& name)
+{
+	Register reg;
+	reg.type = type;
+	reg.column = column;
+	reg.value = value;
+	reg.name = name;
+
+	m_registers.push_back(reg);
+	return m_registers.size() - 1;
+}
+
+size_t BatchExpression::addInstruction(CompiledExpression::Operator op, size_t left, size_t right, bool negate)
+{
+	Instruction instruction;
+	instruction.op = op;
+	instruction.negate = negate;
+	instruction.left = left;
+	instruction.right = right;
+	instruction.target = addRegister(COMPUTED);
+
+	m_instructions.push_back(instruction);
+	return instruction.target;
+}
+
+void BatchExpression::run(const Instruction& instruction, const double* left, const double* right, double* __restrict target, size_t count)
+{
+	//no branches inside the loops, && and || evaluate both sides which is safe since nothing here has side effects
+	if (instruction.negate)
+	{
+		for (size_t i = 0; i < count; i++) target[i] = left[i] == 0;
+		return;
+	}
+
+	switch (instruction.op)
+	{
+		case CompiledExpression::ADD:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] + right[i];
+			break;
+		case CompiledExpression::SUB:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] - right[i];
+			break;
+		case CompiledExpression::MUL:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] * right[i];
+			break;
+		case CompiledExpression::DIV:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] / right[i];
+			break;
+		case CompiledExpression::MOD:
+			for (size_t i = 0; i < count; i++) target[i] = (int)left[i] % (int)right[i];
+			break;
+		case CompiledExpression::POW:
+			for (size_t i = 0; i < count; i++) target[i] = pow(left[i], right[i]);
+			break;
+		case CompiledExpression::AND:
+			for (size_t i = 0; i < count; i++) target[i] = (left[i] != 0) & (right[i] != 0);
+			break;
+		case CompiledExpression::OR:
+			for (size_t i = 0; i < count; i++) target[i] = (left[i] != 0) | (right[i] != 0);
+			break;
+		case CompiledExpression::LESS:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] < right[i];
+			break;
+		case CompiledExpression::GREATER:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] > right[i];
+			break;
+		case CompiledExpression::LESS_EQ:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] <= right[i];
+			break;
+		case CompiledExpression::GREATER_EQ:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] >= right[i];
+			break;
+		case CompiledExpression::EQUAL:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] == right[i];
+			break;
+		case CompiledExpression::NOT_EQUAL:
+			for (size_t i = 0; i < count; i++) target[i] = left[i] != right[i];
+			break;
+		default:
+			throw ParsingException("Syntax Error: Unsupported operator in a batch expression!");
+	}
+}
+
+void BatchExpression::evaluate(const vector<const double*>& inputs, size_t rows, double* output) const
+{
+	if (inputs.size() != m_columns.size())
+	{
+		throw ParsingException("Runtime Error: Batch expression expects " + to_string(m_columns.size()) +
+			" columns but got " + to_string(inputs.size()));
+	}
+
+	if (!m_vectorized)
+	{
+		evaluateRows(inputs, rows, output);
+		return;
+	}
+
+	//constants and script variables are broadcast into their registers once
+	vector<double> storage(m_registers.size() * BLOCK_SIZE);
+	for (size_t i = 0; i < m_registers.size(); i++)
+	{
+		const Register& reg = m_registers[i];
+		double value = reg.value;
+
+		if (reg.type == SCRIPT_VARIABLE)
+		{
+			Variable variable = CompiledExpression::getVariable(reg.name);
+			if (variable.m_type != Tokens::NUMERIC)
+			{
+				//strings and collections are only handled by the Parser
+				evaluateRows(inputs, rows, output);
+				return;
+			}
+			value = variable.m_numericValue;
+		}
+
+		if (reg.type == CONSTANT || reg.type == SCRIPT_VARIABLE)
+		{
+			fill(storage.begin() + i * BLOCK_SIZE, storage.begin() + (i + 1) * BLOCK_SIZE, value);
+		}
+	}
+
+	vector<const double*> registers(m_registers.size());
+
+	for (size_t start = 0; start < rows; start += BLOCK_SIZE)
+	{
+		size_t count = min(BLOCK_SIZE, rows - start);
+
+		for (size_t i = 0; i < m_registers.size(); i++)
+		{
+			registers[i] = m_registers[i].type == COLUMN ? inputs[m_registers[i].column] + start : &storage[i * BLOCK_SIZE];
+		}
+
+		for (const Instruction& instruction : m_instructions)
+		{
+			run(instruction, registers[instruction.left], registers[instruction.right], &storage[instruction.target * BLOCK_SIZE], count);
+		}
+
+		copy(registers[m_result], registers[m_result] + count, output + start);
+	}
+}
+
+void BatchExpression::evaluateRows(const vector<const double*>& inputs, size_t rows, double* output) const
+{
+	ParsingScript script(m_script);
+
+	for (size_t row = 0; row < rows; row++)
+	{
+		ExecutionBudget::step();
+		for (size_t i = 0; i < m_columns.size(); i++)
+		{
+			ParserFunction::assignVariable(m_columns[i], Variable(inputs[i][row]));
+		}
+
+		//the value of the previous row doesn't count
+		if (!m_resultName.empty())
+		{
+			ParserFunction::assignVariable(m_resultName, Variable());
+		}
+
+		script.setPointer(0);
+		Variable result = script.executeAll();
+
+		//the script ends with a block
+		if (result.m_type == Tokens::VOID && !m_resultName.empty())
+		{
+			result = CompiledExpression::getVariable(m_resultName);
+			if (result.m_type == Tokens::VOID)
+			{
+				throw ParsingException("Runtime Error: Batch expression [" + script.getRawScript() +
+					"] didn't set [" + m_resultName + "] in row " + to_string(row));
+			}
+		}
+
+		if (result.m_type != Tokens::NUMERIC)
+		{
+			throw ParsingException("Runtime Error: Batch expression [" + script.getRawScript() +
+				"] must be numeric, got " + Tokens::typeToString(result.m_type));
+		}
+		output[row] = result.m_numericValue;
+	}
+}
@@ -0,0 +1,87 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include "CompiledExpression.h"
+
+/*
+*  An expression, or a sequence of assignments ending with an expression,
+*  that is compiled once and then evaluated over columns of input rows:
+*
+*    BatchExpression score("base = price * qty; base - base * discount", { "price", "qty", "discount" });
+*    score.evaluate({ prices, quantities, discounts }, rows, scores);
+*
+*  Arithmetic, comparisons and logic are turned into a list of instructions
+*  that each process a block of BLOCK_SIZE rows in a plain loop the compiler
+*  can vectorize. Variables that are not columns are read once per call.
+*  Anything else (strings, function calls, control flow) falls back to
+*  running the script for every row. A script that ends with a block has
+*  no value, its rows get the value of the result variable instead. It is
+*  cleared before every row, a row that doesn't set it is an error:
+*
+*    BatchExpression fee("if (qty > 10) { fee = 0; } else { fee = 5; }", { "qty" }, "fee");
+*
+*  Variables assigned by a vectorized expression only exist within a row.
+*/
+class BatchExpression
+{
+public:
+	static const size_t BLOCK_SIZE = 256;
+
+	BatchExpression(const string& script, const vector<string>& columns, const string& result = Tokens::EMPTY);
+
+	bool isVectorized() const { return m_vectorized; }
+
+	//inputs[i] holds the values of columns[i] for all rows, output receives one value per row
+	void evaluate(const vector<const double*>& inputs, size_t rows, double* output) const;
+
+private:
+	enum RegisterType
+	{
+		COLUMN,
+		CONSTANT,
+		SCRIPT_VARIABLE,
+		COMPUTED
+	};
+
+	struct Register
+	{
+		RegisterType type;
+		size_t		 column = 0;
+		double		 value = 0;
+		string		 name;
+	};
+
+	//NOT is the only unary operation, its right operand is ignored
+	struct Instruction
+	{
+		CompiledExpression::Operator op;
+		bool   negate = false;
+		size_t left = 0;
+		size_t right = 0;
+		size_t target = 0;
+	};
+
+	static ParsingScript toScript(const string& script);
+
+	bool compile(const string& data);
+	size_t compileNode(const CompiledExpression::Node& node);
+	size_t addRegister(RegisterType type, size_t column = 0, double value = 0, const string& name = Tokens::EMPTY);
+	size_t addInstruction(CompiledExpression::Operator op, size_t left, size_t right, bool negate = false);
+
+	static void run(const Instruction& instruction, const double* left, const double* right, double* __restrict target, size_t count);
+
+	void evaluateRows(const vector<const double*>& inputs, size_t rows, double* output) const;
+
+	static const size_t UNSUPPORTED = (size_t)-1;
+
+	vector<string>		m_columns;
+	ParsingScript		m_script;
+	string				m_resultName; //value of the rows that end without a value of their own
+	bool				m_vectorized = false;
+
+	vector<Register>	m_registers;
+	vector<Instruction> m_instructions;
+	unordered_map<string, size_t> m_names; //current register of every variable while compiling
+	size_t				m_result = 0;
+};
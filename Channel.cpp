@@ -0,0 +1,180 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <thread>
+
+#include "Channel.h"
+#include "Scheduler.h"
+#include "ScriptHelper.h"
+#include "ThreadPool.h"
+
+class ChannelIterator : public ScriptIterator
+{
+public:
+	ChannelIterator(const shared_ptr<ScriptObject>& channel) : m_object(channel), m_channel(static_cast<ScriptChannel*>(channel.get())) {}
+
+	virtual bool next(Variable& item)
+	{
+		return m_channel->recv(item);
+	}
+
+private:
+	shared_ptr<ScriptObject> m_object;
+	ScriptChannel* m_channel;
+};
+
+ScriptChannel::ScriptChannel(size_t capacity) : m_sendPosition(0), m_recvPosition(0), m_closed(false)
+{
+	//with a single cell a written value would look like a free cell of the next lap
+	size_t size = 2;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+
+	m_cells.reset(new Cell[size]);
+	m_mask = size - 1;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		m_cells[i].sequence.store(i, memory_order_relaxed);
+	}
+}
+
+bool ScriptChannel::trySend(const Variable& value)
+{
+	Cell* cell;
+	size_t position = m_sendPosition.load(memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+		if (difference == 0)
+		{
+			//the cell is free in this lap, try to claim it
+			if (m_sendPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//the cell still holds a value of the previous lap
+			return false;
+		}
+		else
+		{
+			position = m_sendPosition.load(memory_order_relaxed);
+		}
+	}
+
+	cell->value = value;
+	cell->value.m_action.clear();
+	cell->sequence.store(position + 1, memory_order_release);
+	return true;
+}
+
+bool ScriptChannel::tryRecv(Variable& value)
+{
+	Cell* cell;
+	size_t position = m_recvPosition.load(memory_order_relaxed);
+
+	while (true)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->sequence.load(memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+		if (difference == 0)
+		{
+			if (m_recvPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			//nothing was sent to this cell in the current lap yet
+			return false;
+		}
+		else
+		{
+			position = m_recvPosition.load(memory_order_relaxed);
+		}
+	}
+
+	value = move(cell->value);
+	cell->value = Variable();
+	cell->sequence.store(position + m_mask + 1, memory_order_release);
+	return true;
+}
+
+void ScriptChannel::send(const Variable& value)
+{
+	size_t rounds = 0;
+	while (true)
+	{
+		if (isClosed())
+		{
+			throw ParsingException("Runtime Error: Can't send to a closed channel");
+		}
+		if (trySend(value))
+		{
+			return;
+		}
+		wait(rounds, "send");
+	}
+}
+
+bool ScriptChannel::recv(Variable& value)
+{
+	size_t rounds = 0;
+	while (true)
+	{
+		if (tryRecv(value))
+		{
+			return true;
+		}
+
+		//a value might have been sent right before closing
+		if (isClosed())
+		{
+			return tryRecv(value);
+		}
+		wait(rounds, "recv");
+	}
+}
+
+void ScriptChannel::wait(size_t& rounds, const string& operation) const
+{
+	rounds++;
+
+	//on a thread without tasks that is not a pfor worker nobody else could ever make progress
+	if (!Scheduler::inTask() && !ThreadPool::isWorker() && Scheduler::getTaskCount() == 0)
+	{
+		throw ParsingException("Runtime Error: " + operation + "() on " + toString() + " would wait forever");
+	}
+
+	if (rounds < SPIN_ROUNDS)
+	{
+		Scheduler::yield();
+		this_thread::yield();
+	}
+	else
+	{
+		//also lets the event loop sleep if every task is waiting
+		Scheduler::sleep(1);
+	}
+}
+
+string ScriptChannel::toString() const
+{
+	return "channel(" + to_string(capacity()) + ")";
+}
+
+unique_ptr<ScriptIterator> ScriptChannel::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new ChannelIterator(self));
+}
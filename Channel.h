@@ -0,0 +1,69 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+
+#include "Collections.h"
+
+/*
+*  Bounded channel between script tasks and pfor workers (channel(capacity)).
+*  Lock free multi producer / multi consumer ring buffer: every cell carries
+*  a sequence number that tells whether it can be written or read for the
+*  current lap, so producers and consumers only compete on their own index.
+*  The capacity is rounded up to a power of two, and to at least 2, so
+*  channel(1) holds two values. There are no unbuffered channels.
+*  send() and recv() fall back to waiting when the ring is full or empty:
+*  a task lets the other tasks run, a thread backs off until another
+*  thread made progress.
+*/
+class ScriptChannel : public ScriptObject
+{
+public:
+	ScriptChannel(size_t capacity);
+
+	size_t capacity() const { return m_mask + 1; }
+
+	//non blocking, return false if the channel is full or empty
+	bool trySend(const Variable& value);
+	bool tryRecv(Variable& value);
+
+	void send(const Variable& value);
+
+	//returns false once the channel is closed and empty
+	bool recv(Variable& value);
+
+	//no more values can be sent, the remaining ones can still be received
+	void close() { m_closed.store(true, memory_order_release); }
+	bool isClosed() const { return m_closed.load(memory_order_acquire); }
+
+	virtual string toString() const;
+
+	//iterates until the channel is closed and empty
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	struct Cell
+	{
+		atomic<size_t> sequence;
+		Variable	   value;
+	};
+
+	//waits for another task or thread to make progress, 'operation' is only used for errors
+	void wait(size_t& rounds, const string& operation) const;
+
+	static const size_t SPIN_ROUNDS = 16;
+	static const size_t CACHE_LINE = 64;
+
+	unique_ptr<Cell[]> m_cells;
+	size_t			   m_mask;
+
+	//the indices are kept on their own cache lines, producers and consumers don't share one
+	char		   m_padding0[CACHE_LINE];
+	atomic<size_t> m_sendPosition;
+	char		   m_padding1[CACHE_LINE - sizeof(atomic<size_t>)];
+	atomic<size_t> m_recvPosition;
+	char		   m_padding2[CACHE_LINE - sizeof(atomic<size_t>)];
+
+	atomic<bool> m_closed;
+};
@@ -0,0 +1,495 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include "Collections.h"
+#include "ScriptHelper.h"
+
+atomic<size_t> ScriptObject::m_epochs(0);
+
+Variable ScriptObject::getElement(const Variable& index) const
+{
+	throw ParsingException("Semantic Error: Value [" + toString() + "] can't be indexed!");
+}
+
+void ScriptObject::setElement(const Variable& index, const Variable& value)
+{
+	throw ParsingException("Semantic Error: Value [" + toString() + "] can't be indexed!");
+}
+
+unique_ptr<ScriptIterator> ScriptObject::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	throw ParsingException("Semantic Error: Can't iterate over [" + toString() + "]");
+}
+
+//ITERATORS
+class MapIterator : public ScriptIterator
+{
+public:
+	MapIterator(const shared_ptr<ScriptObject>& map) : m_object(map), m_map(static_cast<ScriptMap*>(map.get()))
+	{
+		m_map->addIterator();
+	}
+
+	virtual ~MapIterator()
+	{
+		m_map->removeIterator();
+	}
+
+	virtual bool next(Variable& item)
+	{
+		m_position = m_map->nextPosition(m_position);
+		if (m_position == string::npos) 
+		{
+			return false;
+		}
+		item = m_map->keyAt(m_position++);
+		return true;
+	}
+
+private:
+	shared_ptr<ScriptObject> m_object;
+	ScriptMap* m_map;
+	size_t m_position = 0;
+};
+
+class ArrayIterator : public ScriptIterator
+{
+public:
+	ArrayIterator(const shared_ptr<ScriptObject>& arr) : m_object(arr), m_array(static_cast<ScriptArray*>(arr.get())) {}
+
+	virtual bool next(Variable& item)
+	{
+		//the size is checked on every step since the loop body may change the array
+		if (m_index >= m_array->size()) 
+		{
+			return false;
+		}
+		item = m_array->at(m_index++);
+		return true;
+	}
+
+private:
+	shared_ptr<ScriptObject> m_object;
+	ScriptArray* m_array;
+	size_t m_index = 0;
+};
+
+class RangeIterator : public ScriptIterator
+{
+public:
+	RangeIterator(const ScriptRange& range) : m_range(range) {}
+
+	virtual bool next(Variable& item)
+	{
+		if (m_index >= m_range.size()) 
+		{
+			return false;
+		}
+		item.set(m_range.at(m_index++));
+		return true;
+	}
+
+private:
+	ScriptRange m_range;
+	size_t m_index = 0;
+};
+
+class StringIterator : public ScriptIterator
+{
+public:
+	StringIterator(const string& str) : m_string(str) {}
+
+	virtual bool next(Variable& item)
+	{
+		if (m_index >= m_string.size()) 
+		{
+			return false;
+		}
+		item.set(string(1, m_string[m_index++]));
+		return true;
+	}
+
+private:
+	string m_string;
+	size_t m_index = 0;
+};
+
+unique_ptr<ScriptIterator> ScriptIterator::create(const Variable& collection)
+{
+	if (collection.m_object) 
+	{
+		return collection.m_object->createIterator(collection.m_object);
+	}
+	if (collection.m_type == Tokens::STRING) 
+	{
+		return unique_ptr<ScriptIterator>(new StringIterator(collection.m_stringValue));
+	}
+
+	throw ParsingException("Semantic Error: Can't iterate over [" + collection.toString() + "]");
+}
+
+size_t ScriptMap::hashKey(const Variable& key)
+{
+	uint64_t hash = 0;
+
+	if (key.m_type == Tokens::STRING)
+	{
+		hash = std::hash<string>()(key.m_stringValue);
+	}
+	else if (key.m_type == Tokens::NUMERIC)
+	{
+		//-0.0 and 0.0 have to end up in the same slot, and so do all NaNs
+		double value = key.m_numericValue == 0 ? 0.0 : isnan(key.m_numericValue) ? numeric_limits<double>::quiet_NaN() : key.m_numericValue;
+		hash = std::hash<double>()(value) ^ 0x9E3779B97F4A7C15ULL;
+	}
+	else
+	{
+		throw ParsingException("Semantic Error: Only strings and numbers can be used as map keys, found [" + Tokens::typeToString(key.m_type) + "]");
+	}
+
+	//the standard hashes are often the identity, mix them so the low bits used for the slot are spread
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	return (size_t)hash;
+}
+
+bool ScriptMap::keysEqual(const Variable& left, const Variable& right)
+{
+	if (left.m_type != right.m_type)
+	{
+		return false;
+	}
+	if (left.m_type == Tokens::STRING)
+	{
+		return left.m_stringValue == right.m_stringValue;
+	}
+	return left.m_numericValue == right.m_numericValue || (isnan(left.m_numericValue) && isnan(right.m_numericValue));
+}
+
+size_t ScriptMap::findSlot(const Variable& key, size_t hash) const
+{
+	if (m_slots.empty())
+	{
+		return string::npos;
+	}
+
+	size_t mask = m_slots.size() - 1;
+	uint32_t hashFragment = fragment(hash);
+
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		const Slot& slot = m_slots[i];
+
+		if (slot.index == EMPTY_SLOT)
+		{
+			return string::npos;
+		}
+		if (slot.index != REMOVED_SLOT && slot.hash == hashFragment && keysEqual(m_entries[slot.index].key, key))
+		{
+			return i;
+		}
+	}
+}
+
+const uint32_t ScriptMap::EMPTY_SLOT;
+const uint32_t ScriptMap::REMOVED_SLOT;
+const size_t   ScriptMap::MIN_SLOTS;
+
+const Variable* ScriptMap::find(const Variable& key) const
+{
+	size_t slot = findSlot(key, hashKey(key));
+
+	if (slot == string::npos)
+	{
+		return nullptr;
+	}
+	return &m_entries[m_slots[slot].index].value;
+}
+
+void ScriptMap::set(const Variable& key, const Variable& value)
+{
+	size_t hash = hashKey(key);
+	size_t slot = findSlot(key, hash);
+
+	if (slot != string::npos)
+	{
+		m_entries[m_slots[slot].index].value = value;
+		return;
+	}
+
+	//every entry (also a removed one) occupies a slot, keep the load factor below 3/4
+	if ((m_entries.size() + 1) * 4 > m_slots.size() * 3)
+	{
+		//an open iterator would skip entries if the removed ones before it were compacted
+		bool compact = m_iterators.load(memory_order_relaxed) == 0;
+		size_t used = compact ? m_count : m_entries.size();
+
+		size_t slotCount = max(m_slots.size(), MIN_SLOTS);
+		while ((used + 1) * 2 > slotCount)
+		{
+			slotCount *= 2;
+		}
+		rehash(slotCount, compact);
+	}
+
+	size_t mask = m_slots.size() - 1;
+	size_t i = hash & mask;
+
+	while (m_slots[i].index != EMPTY_SLOT)
+	{
+		i = (i + 1) & mask;
+	}
+
+	m_slots[i].hash = fragment(hash);
+	m_slots[i].index = (uint32_t)m_entries.size();
+
+	Entry entry = { hash, key, value, false };
+	entry.key.m_action.clear();
+	entry.value.m_action.clear();
+	m_entries.emplace_back(entry);
+	m_count++;
+}
+
+bool ScriptMap::remove(const Variable& key)
+{
+	size_t slot = findSlot(key, hashKey(key));
+
+	if (slot == string::npos)
+	{
+		return false;
+	}
+
+	Entry& entry = m_entries[m_slots[slot].index];
+	entry.removed = true;
+	entry.key = Variable::emptyInstance;
+	entry.value = Variable::emptyInstance;
+
+	m_slots[slot].index = REMOVED_SLOT;
+	m_count--;
+	return true;
+}
+
+void ScriptMap::clear()
+{
+	m_slots.clear();
+	m_entries.clear();
+	m_count = 0;
+}
+
+void ScriptMap::rehash(size_t slotCount, bool compact)
+{
+	//compact the entries, the cached hashes make this a pure move without hashing a key again
+	if (compact)
+	{
+		size_t alive = 0;
+		for (size_t i = 0; i < m_entries.size(); i++)
+		{
+			if (m_entries[i].removed)
+			{
+				continue;
+			}
+			if (alive != i)
+			{
+				m_entries[alive] = std::move(m_entries[i]);
+			}
+			alive++;
+		}
+		m_entries.resize(alive);
+	}
+
+	Slot empty = { 0, EMPTY_SLOT };
+	m_slots.assign(slotCount, empty);
+	size_t mask = slotCount - 1;
+
+	for (size_t index = 0; index < m_entries.size(); index++)
+	{
+		if (m_entries[index].removed)
+		{
+			continue;
+		}
+
+		size_t i = m_entries[index].hash & mask;
+		while (m_slots[i].index != EMPTY_SLOT)
+		{
+			i = (i + 1) & mask;
+		}
+		m_slots[i].hash = fragment(m_entries[index].hash);
+		m_slots[i].index = (uint32_t)index;
+	}
+}
+
+size_t ScriptMap::nextPosition(size_t from) const
+{
+	for (size_t i = from; i < m_entries.size(); i++)
+	{
+		if (!m_entries[i].removed)
+		{
+			return i;
+		}
+	}
+	return string::npos;
+}
+
+string ScriptMap::toString() const
+{
+	string result(1, Tokens::START_GROUP);
+
+	for (size_t i = nextPosition(0); i != string::npos; i = nextPosition(i + 1))
+	{
+		if (result.size() > 1)
+		{
+			result += ", ";
+		}
+
+		const Entry& entry = m_entries[i];
+		result += entry.key.m_type == Tokens::STRING ? Tokens::QUOTE + entry.key.m_stringValue + Tokens::QUOTE : entry.key.toString();
+		result += ": ";
+		result += entry.value.m_type == Tokens::STRING ? Tokens::QUOTE + entry.value.m_stringValue + Tokens::QUOTE : entry.value.toString();
+	}
+
+	return result + Tokens::END_GROUP;
+}
+
+Variable ScriptMap::getElement(const Variable& index) const
+{
+	const Variable* value = find(index);
+	return value != nullptr ? *value : Variable::emptyInstance;
+}
+
+void ScriptMap::setElement(const Variable& index, const Variable& value)
+{
+	set(index, value);
+}
+
+unique_ptr<ScriptIterator> ScriptMap::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new MapIterator(self));
+}
+
+//ARRAY
+void ScriptArray::push(const Variable& item)
+{
+	m_items.emplace_back(item);
+	m_items.back().m_action.clear();
+}
+
+bool ScriptArray::removeAt(size_t index)
+{
+	if (index >= m_items.size()) 
+	{
+		return false;
+	}
+	m_items.erase(m_items.begin() + index);
+	return true;
+}
+
+bool ScriptArray::contains(const Variable& item) const
+{
+	for (size_t i = 0; i < m_items.size(); i++) 
+	{
+		if (m_items[i].m_type == item.m_type && m_items[i].toString() == item.toString()) 
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t ScriptArray::checkIndex(const Variable& index, size_t limit) const
+{
+	ScriptHelper::checkNonNegativeInteger(index);
+
+	if (index.m_numericValue >= limit) 
+	{
+		throw ParsingException("Semantic Error: Index [" + index.toString() + "] is out of bounds, the array has " + to_string(m_items.size()) + " elements");
+	}
+	return (size_t)index.m_numericValue;
+}
+
+string ScriptArray::toString() const
+{
+	string result(1, Tokens::START_ARRAY);
+
+	for (size_t i = 0; i < m_items.size(); i++) 
+	{
+		if (i > 0) 
+		{
+			result += ", ";
+		}
+		const Variable& item = m_items[i];
+		result += item.m_type == Tokens::STRING ? Tokens::QUOTE + item.m_stringValue + Tokens::QUOTE : item.toString();
+	}
+
+	return result + Tokens::END_ARRAY;
+}
+
+Variable ScriptArray::getElement(const Variable& index) const
+{
+	return m_items[checkIndex(index, m_items.size())];
+}
+
+void ScriptArray::setElement(const Variable& index, const Variable& value)
+{
+	size_t position = checkIndex(index, m_items.size() + 1);
+
+	if (position == m_items.size()) 
+	{
+		push(value);
+		return;
+	}
+	m_items[position] = value;
+	m_items[position].m_action.clear();
+}
+
+unique_ptr<ScriptIterator> ScriptArray::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new ArrayIterator(self));
+}
+
+//RANGE
+ScriptRange::ScriptRange(double start, double end, double step) : m_start(start), m_end(end), m_step(step), m_size(0)
+{
+	if (step == 0) 
+	{
+		throw ParsingException("Semantic Error: The step of a range can't be 0");
+	}
+
+	if (!isfinite(start) || !isfinite(end) || !isfinite(step)) 
+	{
+		throw ParsingException("Semantic Error: The bounds and the step of a range must be finite numbers");
+	}
+
+	//beyond 2^53 the items can't be told apart anymore
+	double count = ceil((end - start) / step);
+	if (count >= 9007199254740992.0) 
+	{
+		throw ParsingException("Semantic Error: A range can't have more than 2^53 elements");
+	}
+	m_size = count > 0 ? (size_t)count : 0;
+}
+
+string ScriptRange::toString() const
+{
+	return Tokens::CREATE_RANGE + Tokens::START_ARG + Variable(m_start).toString() + ", " +
+		Variable(m_end).toString() + ", " + Variable(m_step).toString() + Tokens::END_ARG;
+}
+
+Variable ScriptRange::getElement(const Variable& index) const
+{
+	ScriptHelper::checkNonNegativeInteger(index);
+
+	if (index.m_numericValue >= m_size) 
+	{
+		throw ParsingException("Semantic Error: Index [" + index.toString() + "] is out of bounds, the range has " + to_string(m_size) + " elements");
+	}
+	return Variable(at((size_t)index.m_numericValue));
+}
+
+unique_ptr<ScriptIterator> ScriptRange::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new RangeIterator(*this));
+}
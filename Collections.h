@@ -0,0 +1,188 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Tokens.h"
+#include "Variable.h"
+
+/*
+*  Iteration protocol used by "for (item : collection)".
+*  next() produces one item at a time, nothing gets materialized.
+*/
+class ScriptIterator
+{
+public:
+	virtual ~ScriptIterator() {}
+
+	//stores the next item and returns false once the iteration is done
+	virtual bool next(Variable& item) = 0;
+
+	static unique_ptr<ScriptIterator> create(const Variable& collection);
+};
+
+/*
+*  Base class of all values that are not a plain NUMERIC or STRING.
+*  Objects are held by a shared_ptr inside of the Variable, so copying
+*  a Variable never copies the object itself.
+*/
+class ScriptObject
+{
+public:
+	ScriptObject() : m_epoch(m_epochs.load(memory_order_relaxed)) {}
+	virtual ~ScriptObject() {}
+
+	virtual string toString() const = 0;
+
+	virtual Variable getElement(const Variable& index) const;
+	virtual void setElement(const Variable& index, const Variable& value);
+
+	//the iterator keeps the object alive through the passed shared_ptr
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+	//every Environment::fork() starts a new epoch, objects of an earlier one may belong to a VariableLayer
+	size_t getEpoch() const { return m_epoch; }
+	static size_t nextEpoch() { return ++m_epochs; }
+
+private:
+	size_t m_epoch;
+
+	static atomic<size_t> m_epochs;
+};
+
+/*
+*  Dictionary type of the scripting language (map()).
+*  Open addressing table with linear probing. The slot array only holds
+*  a cached hash fragment and an index into the dense entry vector,
+*  so a probe never touches a key unless the hashes already match
+*  and no entry needs its own heap node. Entries keep insertion order,
+*  removed entries are left as holes until the next rehash. While the map
+*  is iterated a rehash keeps them, so the positions of the entries stay.
+*  All NaN keys are the same key, like 0 and -0.
+*/
+class ScriptMap : public ScriptObject
+{
+public:
+	ScriptMap() : m_iterators(0) {}
+
+	size_t size() const { return m_count; }
+
+	bool contains(const Variable& key) const { return find(key) != nullptr; }
+	const Variable* find(const Variable& key) const;
+
+	void set(const Variable& key, const Variable& value);
+	bool remove(const Variable& key);
+	void clear();
+
+	//iteration over the dense entries, removed positions are skipped
+	size_t nextPosition(size_t from) const;
+	const Variable& keyAt(size_t position) const	{ return m_entries[position].key; }
+	const Variable& valueAt(size_t position) const	{ return m_entries[position].value; }
+
+	//open iterators, counted by MapIterator
+	void addIterator() const	{ m_iterators.fetch_add(1, memory_order_relaxed); }
+	void removeIterator() const { m_iterators.fetch_sub(1, memory_order_relaxed); }
+
+	virtual string toString() const;
+
+	virtual Variable getElement(const Variable& index) const;
+	virtual void setElement(const Variable& index, const Variable& value);
+
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+	static size_t hashKey(const Variable& key);
+	static bool keysEqual(const Variable& left, const Variable& right);
+
+private:
+	struct Slot
+	{
+		uint32_t hash;	//fragment of the cached hash
+		uint32_t index; //position in m_entries
+	};
+
+	struct Entry
+	{
+		size_t	 hash;
+		Variable key;
+		Variable value;
+		bool	 removed;
+	};
+
+	static const uint32_t EMPTY_SLOT	= 0xFFFFFFFF;
+	static const uint32_t REMOVED_SLOT	= 0xFFFFFFFE;
+	static const size_t   MIN_SLOTS		= 8;
+
+	size_t findSlot(const Variable& key, size_t hash) const;
+	void rehash(size_t slotCount, bool compact);
+
+	static uint32_t fragment(size_t hash) { return (uint32_t)(hash >> 7); }
+
+	vector<Slot>  m_slots;
+	vector<Entry> m_entries;
+	size_t		  m_count = 0;
+
+	mutable atomic<size_t> m_iterators; //shared maps are iterated by several pfor workers at once
+};
+
+/*
+*  Array type of the scripting language (array()).
+*  Assigning to the index right after the last element appends.
+*/
+class ScriptArray : public ScriptObject
+{
+public:
+	ScriptArray() {}
+	ScriptArray(const vector<Variable>& items) : m_items(items) {}
+
+	size_t size() const { return m_items.size(); }
+
+	const Variable& at(size_t index) const	{ return m_items[index]; }
+	void push(const Variable& item);
+	bool removeAt(size_t index);
+	bool contains(const Variable& item) const;
+
+	vector<Variable>& items() { return m_items; }
+
+	virtual string toString() const;
+
+	virtual Variable getElement(const Variable& index) const;
+	virtual void setElement(const Variable& index, const Variable& value);
+
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	size_t checkIndex(const Variable& index, size_t limit) const;
+
+	vector<Variable> m_items;
+};
+
+/*
+*  Lazy numeric sequence (range(end), range(start, end) or range(start, end, step)).
+*  Only the bounds are stored, the items are computed while iterating.
+*/
+class ScriptRange : public ScriptObject
+{
+public:
+	ScriptRange(double start, double end, double step);
+
+	double start() const { return m_start; }
+	double end() const	 { return m_end; }
+	double step() const	 { return m_step; }
+	size_t size() const	 { return m_size; }
+
+	double at(size_t index) const { return m_start + index * m_step; }
+
+	virtual string toString() const;
+
+	virtual Variable getElement(const Variable& index) const;
+
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	double m_start;
+	double m_end;
+	double m_step;
+	size_t m_size;
+};
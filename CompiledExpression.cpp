@@ -0,0 +1,426 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <cmath>
+
+#include "CompiledExpression.h"
+#include "Functions.h"
+#include "ParserFunction.h"
+#include "ScriptHelper.h"
+
+CompiledExpression::CompiledExpression(const string& expression) : m_expression(ScriptHelper::trim(expression))
+{
+	if (!m_expression.empty() && m_expression[m_expression.size() - 1] == Tokens::END_STATEMENT)
+	{
+		m_expression.erase(m_expression.size() - 1);
+	}
+
+	if (parseStatement(m_root) && atEnd())
+	{
+		return;
+	}
+
+	//not supported by the compiler, the regular parser takes care of it
+	m_root.reset(new Node());
+	m_root->type = SCRIPT;
+	m_root->script.reset(new ParsingScript(m_expression + Tokens::END_STATEMENT));
+}
+
+bool CompiledExpression::parseStatement(unique_ptr<Node>& node)
+{
+	skipSpaces();
+	string action = peekAction();
+
+	//prefix increment or decrement: ++i
+	if (action == Tokens::INCREMENT || action == Tokens::DECREMENT)
+	{
+		m_position += action.size();
+		string name = peekIdentifier();
+		if (name.empty())
+		{
+			return false;
+		}
+		m_position += name.size();
+
+		node.reset(new Node());
+		node->type = INCREMENT;
+		node->name = name;
+		node->action = action;
+		node->delta = action == Tokens::INCREMENT ? 1 : -1;
+		node->prefix = true;
+		return true;
+	}
+
+	string name = peekIdentifier();
+	if (!name.empty())
+	{
+		size_t expressionStart = m_position;
+		m_position += name.size();
+		skipSpaces();
+		action = peekAction();
+
+		if (action == Tokens::INCREMENT || action == Tokens::DECREMENT)
+		{
+			m_position += action.size();
+
+			node.reset(new Node());
+			node->type = INCREMENT;
+			node->name = name;
+			node->action = action;
+			node->delta = action == Tokens::INCREMENT ? 1 : -1;
+			return true;
+		}
+
+		bool isAssignment = action == Tokens::ASSIGNMENT;
+		bool isOperatorAssignment = find(Tokens::OPERATOR_ACTIONS.begin(), Tokens::OPERATOR_ACTIONS.end(), action) != Tokens::OPERATOR_ACTIONS.end();
+
+		if (isAssignment || isOperatorAssignment)
+		{
+			m_position += action.size();
+
+			node.reset(new Node());
+			node->type = isAssignment ? ASSIGN : OPERATOR_ASSIGN;
+			node->name = name;
+			node->action = action;
+			return parseExpression(node->right, 0);
+		}
+
+		//not a statement, start over with the expression
+		m_position = expressionStart;
+	}
+
+	return parseExpression(node, 0);
+}
+
+bool CompiledExpression::parseExpression(unique_ptr<Node>& node, int minPriority)
+{
+	unique_ptr<Node> left;
+	if (!parsePrimary(left))
+	{
+		return false;
+	}
+
+	while (true)
+	{
+		skipSpaces();
+		string action = peekAction();
+		if (action.empty())
+		{
+			break;
+		}
+
+		//assignments and increments inside of an expression are left to the regular parser
+		Operator op = toOperator(action);
+		if (op == NONE)
+		{
+			return false;
+		}
+
+		//same priorities as Parser::merge(), operators with equal priority are merged left to right
+		int priority = Variable::getPriority(action);
+		if (priority < minPriority)
+		{
+			break;
+		}
+		m_position += action.size();
+
+		unique_ptr<Node> binary(new Node());
+		binary->type = BINARY;
+		binary->op = op;
+		binary->action = action;
+		binary->left = std::move(left);
+
+		if (!parseExpression(binary->right, priority + 1))
+		{
+			return false;
+		}
+		left = std::move(binary);
+	}
+
+	node = std::move(left);
+	return true;
+}
+
+bool CompiledExpression::parsePrimary(unique_ptr<Node>& node)
+{
+	skipSpaces();
+	if (atEnd())
+	{
+		return false;
+	}
+
+	char ch = m_expression[m_position];
+	char next = m_position + 1 < m_expression.size() ? m_expression[m_position + 1] : Tokens::NULL_CHAR;
+
+	if (ch == Tokens::NOT[0] && next != Tokens::ASSIGNMENT[0])
+	{
+		m_position++;
+		node.reset(new Node());
+		node->type = NOT;
+		return parsePrimary(node->left);
+	}
+
+	if (ch == Tokens::START_ARG)
+	{
+		m_position++;
+		if (!parseExpression(node, 0))
+		{
+			return false;
+		}
+		skipSpaces();
+		if (atEnd() || m_expression[m_position] != Tokens::END_ARG)
+		{
+			return false;
+		}
+		m_position++;
+		return true;
+	}
+
+	if (ch == Tokens::QUOTE)
+	{
+		size_t end = m_expression.find(Tokens::QUOTE, m_position + 1);
+		if (end == string::npos)
+		{
+			return false;
+		}
+
+		string value = m_expression.substr(m_position + 1, end - m_position - 1);
+		if (value.find('\\') != string::npos)
+		{
+			return false;
+		}
+
+		node.reset(new Node());
+		node->value = Variable(value);
+		m_position = end + 1;
+		return true;
+	}
+
+	if (isdigit(ch) || ch == '.' || (ch == '-' && (isdigit(next) || next == '.')))
+	{
+		//take the whole item like the Parser does and convert it the same way StringOrNumericFunction does
+		size_t end = m_position + 1;
+		while (end < m_expression.size() && (isalnum(m_expression[end]) || m_expression[end] == '.' || m_expression[end] == '_'))
+		{
+			end++;
+		}
+
+		string item = m_expression.substr(m_position, end - m_position);
+		node.reset(new Node());
+		node->value = Variable(::strtod(item.c_str(), nullptr));
+		m_position = end;
+		return true;
+	}
+
+	string name = peekIdentifier();
+	if (name.empty())
+	{
+		return false;
+	}
+	m_position += name.size();
+
+	//function calls and indices are not compiled
+	skipSpaces();
+	if (!atEnd() && (m_expression[m_position] == Tokens::START_ARG || m_expression[m_position] == Tokens::START_ARRAY))
+	{
+		return false;
+	}
+
+	node.reset(new Node());
+	node->type = VARIABLE;
+	node->name = name;
+	return true;
+}
+
+void CompiledExpression::skipSpaces()
+{
+	while (m_position < m_expression.size() && Tokens::WHITESPACE.find(m_expression[m_position]) != string::npos)
+	{
+		m_position++;
+	}
+}
+
+string CompiledExpression::peekAction()
+{
+	if (atEnd())
+	{
+		return Tokens::EMPTY;
+	}
+	return ScriptHelper::findStartingToken(m_expression.substr(m_position, 2), Tokens::ACTIONS);
+}
+
+string CompiledExpression::peekIdentifier()
+{
+	if (atEnd() || !(isalpha(m_expression[m_position]) || m_expression[m_position] == '_'))
+	{
+		return Tokens::EMPTY;
+	}
+
+	size_t end = m_expression.find_first_of(Tokens::TOKEN_SEPARATORS + Tokens::QUOTE, m_position);
+	if (end == string::npos)
+	{
+		end = m_expression.size();
+	}
+	return m_expression.substr(m_position, end - m_position);
+}
+
+bool CompiledExpression::atEnd()
+{
+	return m_position >= m_expression.size();
+}
+
+CompiledExpression::Operator CompiledExpression::toOperator(const string& action)
+{
+	static const unordered_map<string, Operator> operators = {
+		{ "+", ADD }, { "-", SUB }, { "*", MUL }, { "/", DIV }, { "%", MOD }, { "^", POW },
+		{ "&&", AND }, { "||", OR }, { "<", LESS }, { ">", GREATER }, { "<=", LESS_EQ },
+		{ ">=", GREATER_EQ }, { "==", EQUAL }, { "!=", NOT_EQUAL }
+	};
+
+	auto it = operators.find(action);
+	return it == operators.end() ? NONE : it->second;
+}
+
+Variable CompiledExpression::getVariable(const string& name)
+{
+	ParserFunction* function = ParserFunction::getFunction(name);
+
+	//an unknown name is a number for the Parser, see StringOrNumericFunction
+	if (function == nullptr)
+	{
+		return Variable(::strtod(name.c_str(), nullptr));
+	}
+
+	GetVarFunction* variable = dynamic_cast<GetVarFunction*>(function);
+	if (variable != nullptr)
+	{
+		return variable->getValue();
+	}
+
+	ParsingScript empty(Tokens::EMPTY);
+	return function->getValue(empty);
+}
+
+void CompiledExpression::numberOperator(Operator op, double& left, double right)
+{
+	switch (op)
+	{
+		case ADD:			left += right; break;
+		case SUB:			left -= right; break;
+		case MUL:			left *= right; break;
+		case DIV:			left /= right; break;
+		case MOD:			left = (int)left % (int)right; break;
+		case POW:			left = pow(left, right); break;
+		case AND:			left = left && right; break;
+		case OR:			left = left || right; break;
+		case LESS:			left = left < right; break;
+		case GREATER:		left = left > right; break;
+		case LESS_EQ:		left = left <= right; break;
+		case GREATER_EQ:	left = left >= right; break;
+		case EQUAL:			left = left == right; break;
+		case NOT_EQUAL:		left = left != right; break;
+		default:
+			throw ParsingException("Syntax Error: Unsupported operator in a compiled expression!");
+	}
+}
+
+Variable CompiledExpression::evaluateBinary(const Node& node)
+{
+	Variable left = evaluate(*node.left);
+
+	//short circuit evaluation
+	if (node.op == AND && left.m_numericValue == 0)
+	{
+		return Variable(0.0);
+	}
+	if (node.op == OR && left.m_numericValue != 0)
+	{
+		return Variable(1.0);
+	}
+
+	Variable right = evaluate(*node.right);
+
+	if (left.m_type == Tokens::NUMERIC && right.m_type == Tokens::NUMERIC)
+	{
+		numberOperator(node.op, left.m_numericValue, right.m_numericValue);
+		return left;
+	}
+
+	//strings and everything else are merged exactly like the Parser does it
+	left.m_action = node.action;
+	left.merge(right);
+	left.m_action.clear();
+	return left;
+}
+
+Variable CompiledExpression::evaluate(const Node& node)
+{
+	RuntimeStats::local().nodes++;
+
+	switch (node.type)
+	{
+		case CONSTANT:
+			return node.value;
+
+		case VARIABLE:
+			return getVariable(node.name);
+
+		case NOT:
+		{
+			Variable value = evaluate(*node.left);
+			if (value.m_type == Tokens::NUMERIC)
+			{
+				return Variable(!ScriptHelper::toBool(value.m_numericValue));
+			}
+			return value;
+		}
+
+		case BINARY:
+			return evaluateBinary(node);
+
+		case ASSIGN:
+		{
+			Variable value = evaluate(*node.right);
+			value.m_action.clear();
+			ParserFunction::assignVariable(node.name, value);
+			return value;
+		}
+
+		case OPERATOR_ASSIGN:
+		{
+			Variable right = evaluate(*node.right);
+
+			ParserFunction* function = ParserFunction::getFunction(node.name);
+			ScriptHelper::checkNotNull(node.name, function);
+			Variable left = getVariable(node.name);
+
+			if (left.m_type == Tokens::NUMERIC)
+			{
+				OperatorAssignFunction::numberOperator(left, right, node.action);
+			}
+			else
+			{
+				OperatorAssignFunction::stringOperator(left, right, node.action);
+			}
+
+			ParserFunction::assignVariable(node.name, left);
+			return left;
+		}
+
+		case INCREMENT:
+		{
+			ParserFunction* function = ParserFunction::getFunction(node.name);
+			ScriptHelper::checkNotNull(node.name, function);
+			Variable current = getVariable(node.name);
+
+			double result = current.m_numericValue + (node.prefix ? node.delta : 0);
+			current.m_numericValue += node.delta;
+
+			ParserFunction::assignVariable(node.name, current);
+			return Variable(result);
+		}
+
+		default:
+			return node.script->executeFrom(0);
+	}
+}
@@ -0,0 +1,80 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include "Tokens.h"
+#include "Variable.h"
+#include "ParsingScript.h"
+
+/*
+*  An expression or simple statement (assignment, operator assignment,
+*  increment and decrement) that is parsed once into a tree and can then
+*  be evaluated any number of times without touching the script text.
+*  Whatever the compiler doesn't support (function calls, indices, ...)
+*  is kept as a single SCRIPT node that runs through the regular Parser.
+*/
+class CompiledExpression
+{
+public:
+	enum NodeType
+	{
+		CONSTANT,
+		VARIABLE,
+		NOT,
+		BINARY,
+		ASSIGN,
+		OPERATOR_ASSIGN,
+		INCREMENT,
+		SCRIPT
+	};
+
+	enum Operator
+	{
+		NONE, ADD, SUB, MUL, DIV, MOD, POW, AND, OR, LESS, GREATER, LESS_EQ, GREATER_EQ, EQUAL, NOT_EQUAL
+	};
+
+	struct Node
+	{
+		NodeType type = CONSTANT;
+		Operator op = NONE;
+		string	 action;	//operator as written in the script, e.g. "<=" or "+="
+		string	 name;		//variable name of VARIABLE, ASSIGN, OPERATOR_ASSIGN and INCREMENT
+		Variable value;		//value of a CONSTANT
+		double	 delta = 0; //+1 or -1 for INCREMENT
+		bool	 prefix = false;
+
+		unique_ptr<Node> left;
+		unique_ptr<Node> right;
+		unique_ptr<ParsingScript> script;
+	};
+
+	CompiledExpression(const string& expression);
+
+	bool isCompiled() const { return m_root->type != SCRIPT; }
+	const Node& getRoot() const { return *m_root; }
+	const string& getExpression() const { return m_expression; }
+
+	Variable evaluate() const { return evaluate(*m_root); }
+
+	static Variable evaluate(const Node& node);
+
+	static Variable getVariable(const string& name);
+	static void numberOperator(Operator op, double& left, double right);
+	static Operator toOperator(const string& action);
+
+private:
+	bool parseStatement(unique_ptr<Node>& node);
+	bool parseExpression(unique_ptr<Node>& node, int minPriority);
+	bool parsePrimary(unique_ptr<Node>& node);
+
+	void skipSpaces();
+	string peekAction();
+	string peekIdentifier();
+	bool atEnd();
+
+	static Variable evaluateBinary(const Node& node);
+
+	string m_expression;
+	size_t m_position = 0;
+	unique_ptr<Node> m_root;
+};
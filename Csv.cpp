@@ -0,0 +1,268 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XES_CSV_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Csv.h"
+#include "RecordReader.h"
+#include "ScriptHelper.h"
+
+static inline size_t countTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+class CsvRowIterator : public ScriptIterator
+{
+public:
+	CsvRowIterator(const string& path, char separator) :
+		m_file(path), m_scanner(m_file.data(), m_file.size(), separator) {}
+
+	virtual bool next(Variable& item)
+	{
+		vector<Variable> fields;
+		if (!m_scanner.nextRow(fields))
+		{
+			return false;
+		}
+
+		shared_ptr<ScriptArray> row = make_shared<ScriptArray>();
+		row->items().swap(fields);
+		item = Variable(Tokens::ARRAY, row);
+		return true;
+	}
+
+private:
+	MappedFile m_file;
+	CsvScanner m_scanner;
+};
+
+CsvScanner::CsvScanner(const char* data, size_t size, char separator) :
+	m_data(data), m_size(size), m_separator(separator), m_blockStart(size)
+{
+	if (separator == Tokens::QUOTE || separator == '\n' || separator == '\r')
+	{
+		throw ParsingException("Syntax Error: [" + string(1, separator) + "] can't separate the fields of a row");
+	}
+}
+
+uint32_t CsvScanner::scanBlock(size_t start) const
+{
+#ifdef XES_CSV_SSE2
+	const __m128i separator = _mm_set1_epi8(m_separator);
+	const __m128i quote = _mm_set1_epi8(Tokens::QUOTE);
+	const __m128i newLine = _mm_set1_epi8('\n');
+
+	__m128i block = _mm_loadu_si128((const __m128i*)(m_data + start));
+	__m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, separator), _mm_cmpeq_epi8(block, quote)),
+		_mm_cmpeq_epi8(block, newLine));
+	return (uint32_t)_mm_movemask_epi8(special);
+#else
+	uint32_t mask = 0;
+	for (size_t i = 0; i < BLOCK_SIZE; i++)
+	{
+		char ch = m_data[start + i];
+		if (ch == m_separator || ch == Tokens::QUOTE || ch == '\n')
+		{
+			mask |= 1u << i;
+		}
+	}
+	return mask;
+#endif
+}
+
+size_t CsvScanner::findSpecial(size_t from)
+{
+	while (from + BLOCK_SIZE <= m_size)
+	{
+		//the scanned block is reused until all of its special characters were consumed
+		if (from < m_blockStart || from >= m_blockStart + BLOCK_SIZE)
+		{
+			m_blockStart = from;
+			m_blockMask = scanBlock(from);
+		}
+
+		uint32_t mask = m_blockMask & (0xFFFFFFFFu << (from - m_blockStart));
+		if (mask != 0)
+		{
+			return m_blockStart + countTrailingZeros(mask);
+		}
+		from = m_blockStart + BLOCK_SIZE;
+	}
+
+	//the end of the data is shorter than a block
+	for (; from < m_size; from++)
+	{
+		char ch = m_data[from];
+		if (ch == m_separator || ch == Tokens::QUOTE || ch == '\n')
+		{
+			return from;
+		}
+	}
+	return m_size;
+}
+
+bool CsvScanner::nextRow(vector<Variable>& fields)
+{
+	fields.clear();
+
+	//empty lines don't count as rows
+	while (m_position < m_size && (m_data[m_position] == '\n' ||
+		(m_data[m_position] == '\r' && m_position + 1 < m_size && m_data[m_position + 1] == '\n')))
+	{
+		m_position += m_data[m_position] == '\r' ? 2 : 1;
+	}
+	if (m_position >= m_size)
+	{
+		return false;
+	}
+
+	size_t position = m_position;
+	while (true)
+	{
+		size_t end;
+		if (position < m_size && m_data[position] == Tokens::QUOTE)
+		{
+			end = parseQuoted(position, fields);
+		}
+		else
+		{
+			//a quote in the middle of a field is part of it
+			end = findSpecial(position);
+			while (end < m_size && m_data[end] == Tokens::QUOTE)
+			{
+				end = findSpecial(end + 1);
+			}
+
+			size_t length = end - position;
+			if (length > 0 && m_data[end - 1] == '\r' && (end == m_size || m_data[end] == '\n'))
+			{
+				length--;
+			}
+			fields.push_back(RecordReader::toField(m_data + position, length));
+		}
+
+		if (end >= m_size)
+		{
+			m_position = m_size;
+			return true;
+		}
+		if (m_data[end] == '\n')
+		{
+			m_position = end + 1;
+			return true;
+		}
+		position = end + 1;
+	}
+}
+
+//returns the position of the separator or new line after the field
+size_t CsvScanner::parseQuoted(size_t position, vector<Variable>& fields)
+{
+	m_quoted.clear();
+	position++;
+
+	while (position < m_size)
+	{
+		const char* quote = (const char*)memchr(m_data + position, Tokens::QUOTE, m_size - position);
+		if (quote == nullptr)
+		{
+			//not terminated, the field goes on until the end
+			m_quoted.append(m_data + position, m_size - position);
+			position = m_size;
+			break;
+		}
+
+		size_t end = quote - m_data;
+		m_quoted.append(m_data + position, end - position);
+		position = end + 1;
+
+		if (position < m_size && m_data[position] == Tokens::QUOTE)
+		{
+			m_quoted += Tokens::QUOTE;
+			position++;
+			continue;
+		}
+		break;
+	}
+	fields.push_back(Variable(m_quoted));
+
+	//anything between the closing quote and the separator is dropped
+	size_t end = findSpecial(position);
+	while (end < m_size && m_data[end] == Tokens::QUOTE)
+	{
+		end = findSpecial(end + 1);
+	}
+	return end;
+}
+
+const size_t CsvScanner::SAMPLE_ROWS;
+const size_t CsvScanner::MAX_RESERVED_ROWS;
+
+Variable CsvScanner::readColumns(const string& path, char separator)
+{
+	MappedFile file(path);
+	CsvScanner scanner(file.data(), file.size(), separator);
+
+	shared_ptr<ScriptMap> table = make_shared<ScriptMap>();
+	vector<Variable> header;
+	if (!scanner.nextRow(header))
+	{
+		return Variable(Tokens::MAP, table);
+	}
+
+	vector<vector<Variable>> columns(header.size());
+	vector<Variable> fields;
+	size_t dataStart = scanner.m_position;
+	size_t rows = 0;
+	while (scanner.nextRow(fields))
+	{
+		//missing fields are empty, additional ones have no column
+		for (size_t i = 0; i < columns.size(); i++)
+		{
+			columns[i].push_back(i < fields.size() ? move(fields[i]) : Variable(Tokens::EMPTY));
+		}
+
+		//the first rows tell how many rows there are about, the columns don't need to grow as often then
+		if (++rows == SAMPLE_ROWS)
+		{
+			size_t estimate = min(file.size() / max((size_t)1, (scanner.m_position - dataStart) / rows) + 1, MAX_RESERVED_ROWS);
+			for (vector<Variable>& column : columns)
+			{
+				column.reserve(estimate);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < columns.size(); i++)
+	{
+		shared_ptr<ScriptArray> column = make_shared<ScriptArray>();
+		column->items().swap(columns[i]);
+		table->set(Variable(header[i].toString()), Variable(Tokens::ARRAY, column));
+	}
+	return Variable(Tokens::MAP, table);
+}
+
+string ScriptCsvRows::toString() const
+{
+	return "csvRows(" + m_path + ")";
+}
+
+unique_ptr<ScriptIterator> ScriptCsvRows::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new CsvRowIterator(m_path, m_separator));
+}
@@ -0,0 +1,72 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <cstdint>
+
+#include "File.h"
+
+/*
+*  Scanner of delimited files for csvRead() and csvRows(). It looks for
+*  the characters that matter (separator, quote and new line) 16 bytes at
+*  a time with SSE2 and keeps the mask of the current block, so every
+*  character is compared only once no matter how many fields a block
+*  holds. The rest of a field is copied without looking at it again.
+*  Quoted fields may contain separators, new lines and "" for a quote,
+*  they always stay strings. Other fields that are numbers become NUMERIC.
+*  Empty lines are skipped, "\r\n" ends a line as well.
+*/
+class CsvScanner
+{
+public:
+	static const size_t BLOCK_SIZE = 16;
+
+	//rows read by readColumns() before the columns are reserved, a larger estimate is left to the growth of the vectors
+	static const size_t SAMPLE_ROWS = 64;
+	static const size_t MAX_RESERVED_ROWS = 1 << 20;
+
+	CsvScanner(const char* data, size_t size, char separator);
+
+	//parses the next row into fields, returns false at the end of the data
+	bool nextRow(vector<Variable>& fields);
+
+	//the first row names the columns, the result maps every name to the array of its values
+	static Variable readColumns(const string& path, char separator);
+
+private:
+	//position of the next separator, quote or new line at or after from, m_size if there is none
+	size_t findSpecial(size_t from);
+	uint32_t scanBlock(size_t start) const;
+
+	size_t parseQuoted(size_t position, vector<Variable>& fields);
+
+	const char* m_data;
+	size_t		m_size;
+	size_t		m_position = 0;
+	char		m_separator;
+
+	//the block that was scanned last, bit i is set if character i is special
+	size_t	 m_blockStart;
+	uint32_t m_blockMask = 0;
+
+	string m_quoted;
+};
+
+/*
+*  Rows of a delimited file (csvRows(path)). Nothing is read up front,
+*  every iteration maps the file and parses one row per step into an
+*  array of its fields, the header isn't treated differently.
+*/
+class ScriptCsvRows : public ScriptObject
+{
+public:
+	ScriptCsvRows(const string& path, char separator) : m_path(path), m_separator(separator) {}
+
+	virtual string toString() const;
+
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	string m_path;
+	char   m_separator;
+};
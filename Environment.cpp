@@ -0,0 +1,259 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Collections.h"
+#include "Environment.h"
+#include "Functions.h"
+
+VariableLayer::VariableLayer(unordered_map<string, ParserFunction*>&& variables, unordered_map<const ScriptObject*, Variable>&& copies,
+	const shared_ptr<const VariableLayer>& parent) : m_variables(move(variables)), m_copies(move(copies)), m_parent(parent)
+{
+}
+
+VariableLayer::~VariableLayer()
+{
+	for (auto it = m_variables.begin(); it != m_variables.end(); ++it)
+	{
+		delete it->second;
+	}
+}
+
+Environment::Environment(Environment&& other)
+{
+	swap(other);
+}
+
+Environment& Environment::operator=(Environment&& other)
+{
+	clear();
+	swap(other);
+	return *this;
+}
+
+Environment::~Environment()
+{
+	clear();
+}
+
+Environment Environment::fork()
+{
+	//nothing changed since the last fork, the current layer can be shared as it is
+	if (!m_variables.empty() || !m_copies.empty())
+	{
+		m_layer = make_shared<VariableLayer>(move(m_variables), move(m_copies), m_layer);
+		m_variables.clear();
+		m_copies.clear();
+	}
+
+	//the collections of the layer are frozen for both from now on
+	m_epoch = ScriptObject::nextEpoch();
+	m_detached = false;
+
+	Environment child;
+	child.m_layer = m_layer;
+	child.m_epoch = m_epoch;
+	return child;
+}
+
+ParserFunction* Environment::findInLayers(const string& name)
+{
+	for (const VariableLayer* layer = m_layer.get(); layer != nullptr; layer = layer->m_parent.get())
+	{
+		auto it = layer->m_variables.find(name);
+		if (it != layer->m_variables.end())
+		{
+			return it->second;
+		}
+	}
+	return nullptr;
+}
+
+Variable Environment::detach(const Variable& value)
+{
+	if (!m_detached)
+	{
+		detach();
+	}
+
+	//a collection that none of the variables refers to isn't shared through the layers
+	auto it = m_copies.find(value.m_object.get());
+	return it != m_copies.end() ? it->second : value;
+}
+
+void Environment::detach()
+{
+	unordered_set<const ScriptObject*> visited;
+	for (auto it = m_variables.begin(); it != m_variables.end(); ++it)
+	{
+		GetVarFunction* variable = dynamic_cast<GetVarFunction*>(it->second);
+		if (variable != nullptr)
+		{
+			variable->setValue(remap(variable->getValue(), visited));
+		}
+	}
+
+	for (const VariableLayer* layer = m_layer.get(); layer != nullptr; layer = layer->m_parent.get())
+	{
+		for (auto it = layer->m_variables.begin(); it != layer->m_variables.end(); ++it)
+		{
+			//shadowed by an own variable or by a layer above
+			GetVarFunction* variable = dynamic_cast<GetVarFunction*>(it->second);
+			if (variable == nullptr || !isFrozen(variable->getValue()) || find(it->first) != it->second)
+			{
+				continue;
+			}
+
+			GetVarFunction* own = new GetVarFunction(copy(variable->getValue()));
+			own->setName(it->first);
+			m_variables[it->first] = own;
+		}
+	}
+	m_detached = true;
+}
+
+Variable Environment::copy(const Variable& value)
+{
+	if (value.m_type != Tokens::MAP && value.m_type != Tokens::ARRAY)
+	{
+		return value;
+	}
+
+	const ScriptObject* original = value.m_object.get();
+	auto it = m_copies.find(original);
+	if (it != m_copies.end())
+	{
+		return it->second;
+	}
+
+	//a layer above the one of the collection could have a copy of it already, which is frozen as well
+	for (const VariableLayer* layer = m_layer.get(); layer != nullptr; layer = layer->m_parent.get())
+	{
+		auto frozen = layer->m_copies.find(original);
+		if (frozen != layer->m_copies.end())
+		{
+			Variable result = copy(frozen->second);
+			m_copies[original] = result;
+			return result;
+		}
+	}
+
+	//registered before the elements are copied, a collection can contain itself
+	if (value.m_type == Tokens::MAP)
+	{
+		ScriptMap* map = value.getMap();
+		shared_ptr<ScriptMap> result = make_shared<ScriptMap>();
+		Variable variable(Tokens::MAP, result);
+		m_copies[original] = variable;
+
+		for (size_t i = map->nextPosition(0); i != string::npos; i = map->nextPosition(i + 1))
+		{
+			result->set(map->keyAt(i), copy(map->valueAt(i)));
+		}
+		return variable;
+	}
+
+	ScriptArray* arr = value.getArray();
+	shared_ptr<ScriptArray> result = make_shared<ScriptArray>();
+	Variable variable(Tokens::ARRAY, result);
+	m_copies[original] = variable;
+
+	result->items().reserve(arr->size());
+	for (size_t i = 0; i < arr->size(); i++)
+	{
+		result->push(copy(arr->at(i)));
+	}
+	return variable;
+}
+
+Variable Environment::remap(const Variable& value, unordered_set<const ScriptObject*>& visited)
+{
+	if (isFrozen(value))
+	{
+		return copy(value);
+	}
+	if ((value.m_type != Tokens::MAP && value.m_type != Tokens::ARRAY) || !visited.insert(value.m_object.get()).second)
+	{
+		return value;
+	}
+
+	if (value.m_type == Tokens::MAP)
+	{
+		ScriptMap* map = value.getMap();
+		for (size_t i = map->nextPosition(0); i != string::npos; i = map->nextPosition(i + 1))
+		{
+			Variable item = remap(map->valueAt(i), visited);
+			if (item.m_object != map->valueAt(i).m_object)
+			{
+				map->set(map->keyAt(i), item);
+			}
+		}
+		return value;
+	}
+
+	vector<Variable>& items = value.getArray()->items();
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		items[i] = remap(items[i], visited);
+	}
+	return value;
+}
+
+unordered_map<string, Variable> Environment::getValues()
+{
+	//the values get shared with a task or a worker, which could change the collections
+	if (m_layer && !m_detached)
+	{
+		detach();
+	}
+
+	unordered_map<string, Variable> values;
+	for (const VariableLayer* layer = m_layer.get(); layer != nullptr; layer = layer->m_parent.get())
+	{
+		for (auto it = layer->m_variables.begin(); it != layer->m_variables.end(); ++it)
+		{
+			if (values.count(it->first) == 0 && m_variables.count(it->first) == 0)
+			{
+				GetVarFunction* variable = dynamic_cast<GetVarFunction*>(find(it->first));
+				if (variable != nullptr)
+				{
+					values[it->first] = variable->getValue();
+				}
+			}
+		}
+	}
+
+	for (auto it = m_variables.begin(); it != m_variables.end(); ++it)
+	{
+		GetVarFunction* variable = dynamic_cast<GetVarFunction*>(it->second);
+		if (variable != nullptr)
+		{
+			values[it->first] = variable->getValue();
+		}
+	}
+	return values;
+}
+
+void Environment::reset()
+{
+	for (auto it = m_variables.begin(); it != m_variables.end(); ++it)
+	{
+		delete it->second;
+	}
+	m_variables.clear();
+	m_copies.clear();
+	m_detached = false;
+}
+
+void Environment::clear()
+{
+	reset();
+	m_layer.reset();
+}
+
+void Environment::swap(Environment& other)
+{
+	m_variables.swap(other.m_variables);
+	m_copies.swap(other.m_copies);
+	m_layer.swap(other.m_layer);
+	std::swap(m_epoch, other.m_epoch);
+	std::swap(m_detached, other.m_detached);
+}
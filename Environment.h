@@ -0,0 +1,105 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Collections.h"
+
+using namespace std;
+
+class ParserFunction;
+
+//variables that were frozen by a fork, shared by all environments forked from them
+class VariableLayer
+{
+public:
+	VariableLayer(unordered_map<string, ParserFunction*>&& variables, unordered_map<const ScriptObject*, Variable>&& copies,
+		const shared_ptr<const VariableLayer>& parent);
+	~VariableLayer();
+
+	VariableLayer(const VariableLayer&) = delete;
+	VariableLayer& operator=(const VariableLayer&) = delete;
+
+	unordered_map<string, ParserFunction*>		 m_variables;
+	unordered_map<const ScriptObject*, Variable> m_copies; //maps and arrays of the layers below, copied for this one
+	shared_ptr<const VariableLayer>				 m_parent;
+};
+
+/*
+*  The global variables of a thread. fork() freezes the own variables
+*  into a VariableLayer that this and the forked environment share, both
+*  continue with an empty map on top of it, so forking is O(1) and only
+*  the variables that get assigned are copied.
+*  Lookups return the variables of the layers as they are. Maps and arrays
+*  are changed in place, so before the first write to a collection of the
+*  layers (one that is older than the fork) all collections of the layers
+*  are copied into the own variables. m_copies remembers the copy of every
+*  collection, so variables that shared a collection still share it.
+*/
+class Environment
+{
+public:
+	Environment() {}
+	Environment(Environment&& other);
+	Environment& operator=(Environment&& other);
+	~Environment();
+
+	Environment(const Environment&) = delete;
+	Environment& operator=(const Environment&) = delete;
+
+	//a copy-on-write copy of this environment
+	Environment fork();
+
+	//the own variable or one of the layers, nullptr if there is none
+	inline ParserFunction* find(const string& name)
+	{
+		auto it = m_variables.find(name);
+		if (it != m_variables.end())
+		{
+			return it->second;
+		}
+		return m_layer ? findInLayers(name) : nullptr;
+	}
+
+	//the values of all variables, collections of the layers are copied first
+	unordered_map<string, Variable> getValues();
+
+	//the collection a write to value has to change, the copy if value belongs to the layers
+	inline Variable writable(const Variable& value)
+	{
+		return isFrozen(value) ? detach(value) : value;
+	}
+
+	//drops the variables that were assigned or copied since the fork, the layers stay
+	void reset();
+	void clear();
+	void swap(Environment& other);
+
+	//the variables that were assigned since the last fork, new ones are added here
+	unordered_map<string, ParserFunction*>& variables() { return m_variables; }
+
+private:
+	ParserFunction* findInLayers(const string& name);
+
+	inline bool isFrozen(const Variable& value) const
+	{
+		return m_layer && (value.m_type == Tokens::MAP || value.m_type == Tokens::ARRAY) && value.m_object->getEpoch() < m_epoch;
+	}
+
+	//copies the collections of the layers once and returns the copy of value
+	Variable detach(const Variable& value);
+	void detach();
+	Variable copy(const Variable& value);
+	//replaces the collections of the layers that an own collection refers to
+	Variable remap(const Variable& value, unordered_set<const ScriptObject*>& visited);
+
+	unordered_map<string, ParserFunction*>		 m_variables;
+	unordered_map<const ScriptObject*, Variable> m_copies;
+	shared_ptr<const VariableLayer>				 m_layer;
+	size_t										 m_epoch = 0;		 //collections of an earlier epoch may belong to the layers
+	bool										 m_detached = false; //the collections of the layers were copied
+};
@@ -0,0 +1,119 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "ExecutionBudget.h"
+#include "ScriptHelper.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+ExecutionLimits ExecutionBudget::m_limits;
+
+thread_local size_t ExecutionBudget::m_countdown = CHECK_INTERVAL;
+thread_local size_t ExecutionBudget::m_chunk = CHECK_INTERVAL;
+thread_local size_t ExecutionBudget::m_used = 0;
+thread_local chrono::steady_clock::time_point ExecutionBudget::m_deadline;
+
+void ExecutionBudget::start()
+{
+	m_used = 0;
+	m_deadline = chrono::steady_clock::now() + chrono::milliseconds(m_limits.timeoutMs);
+	nextChunk();
+}
+
+void ExecutionBudget::resume(size_t used, const chrono::steady_clock::time_point& deadline)
+{
+	m_used = used;
+	m_deadline = deadline;
+	nextChunk();
+}
+
+void ExecutionBudget::addSteps(size_t steps)
+{
+	m_used = getSteps() + steps;
+
+	//nothing of the current chunk is left, check() starts the next one
+	m_chunk = 0;
+	check();
+}
+
+void ExecutionBudget::nextChunk()
+{
+	m_chunk = CHECK_INTERVAL;
+
+	//with a step limit the countdown has to end exactly at the first step above the limit
+	if (m_limits.maxSteps > 0 && m_limits.maxSteps - m_used + 1 < m_chunk)
+	{
+		m_chunk = m_limits.maxSteps - m_used + 1;
+	}
+	m_countdown = m_chunk;
+}
+
+void ExecutionBudget::check()
+{
+	m_used += m_chunk;
+
+	if (m_limits.maxSteps > 0 && m_used > m_limits.maxSteps)
+	{
+		throw ParsingException("Runtime Error: Execution budget of " + to_string(m_limits.maxSteps) + " steps exceeded");
+	}
+
+	if (m_limits.timeoutMs > 0 && chrono::steady_clock::now() > m_deadline)
+	{
+		throw ParsingException("Runtime Error: Execution time limit of " + to_string(m_limits.timeoutMs) + " ms exceeded after " + to_string(m_used) + " steps");
+	}
+
+	if (m_limits.maxMemoryMb > 0)
+	{
+		size_t memory = getMemoryMb();
+		if (memory > m_limits.maxMemoryMb)
+		{
+			throw ParsingException("Runtime Error: Memory limit of " + to_string(m_limits.maxMemoryMb) + " MB exceeded (" + to_string(memory) + " MB in use)");
+		}
+	}
+
+	nextChunk();
+}
+
+size_t ExecutionBudget::getMemoryMb()
+{
+	//the current resident memory, the peak would stay above the limit for the rest of the process (e.g. of --serve)
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.WorkingSetSize / (1024 * 1024);
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+	{
+		return 0;
+	}
+	return info.resident_size / (1024 * 1024);
+#else
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == nullptr)
+	{
+		return 0;
+	}
+	unsigned long long size = 0;
+	unsigned long long resident = 0;
+	int fields = fscanf(file, "%llu %llu", &size, &resident);
+	fclose(file);
+	if (fields != 2)
+	{
+		return 0;
+	}
+	return (size_t)(resident * sysconf(_SC_PAGESIZE) / (1024 * 1024));
+#endif
+}
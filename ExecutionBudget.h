@@ -0,0 +1,64 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <chrono>
+
+#include "Tokens.h"
+
+//Limits of a script execution, 0 means unlimited
+struct ExecutionLimits
+{
+	size_t maxSteps		= 0; //statements and loop iterations
+	size_t timeoutMs	= 0; //wall clock time
+	size_t maxMemoryMb	= 0; //resident memory of the process
+};
+
+/*
+*  Keeps track of how much of its budget the running script has used.
+*  step() only decrements a counter, the limits themselves (including the
+*  clock and the memory usage) are checked once the counter runs out,
+*  i.e. every CHECK_INTERVAL steps at most.
+*  The counters are per thread, pfor workers continue from the budget
+*  of the calling thread and hand their steps back with addSteps().
+*/
+class ExecutionBudget
+{
+public:
+	static const size_t CHECK_INTERVAL = 4096;
+
+	static void setLimits(const ExecutionLimits& limits) { m_limits = limits; }
+	static const ExecutionLimits& getLimits() { return m_limits; }
+
+	//resets the used budget, called before a script gets evaluated
+	static void start();
+
+	//continues with an already used budget, e.g. on a pfor worker
+	static void resume(size_t used, const chrono::steady_clock::time_point& deadline);
+	static const chrono::steady_clock::time_point& getDeadline() { return m_deadline; }
+
+	static size_t getSteps() { return m_used + m_chunk - m_countdown; }
+
+	//counts steps that were made on other threads
+	static void addSteps(size_t steps);
+
+	static inline void step()
+	{
+		if (--m_countdown == 0)
+		{
+			check();
+		}
+	}
+
+private:
+	static void check();
+	static void nextChunk();
+	static size_t getMemoryMb();
+
+	static ExecutionLimits m_limits;
+
+	static thread_local size_t m_countdown;
+	static thread_local size_t m_chunk;
+	static thread_local size_t m_used;
+	static thread_local chrono::steady_clock::time_point m_deadline;
+};
@@ -0,0 +1,264 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "File.h"
+#include "ScriptHelper.h"
+
+class FileIterator : public ScriptIterator
+{
+public:
+	FileIterator(const shared_ptr<ScriptObject>& file) : m_object(file), m_file(static_cast<ScriptFile*>(file.get())) {}
+
+	virtual bool next(Variable& item)
+	{
+		string line;
+		if (!m_file->readLine(line))
+		{
+			return false;
+		}
+		item = Variable(line);
+		return true;
+	}
+
+private:
+	shared_ptr<ScriptObject> m_object;
+	ScriptFile* m_file;
+};
+
+MappedFile::MappedFile(const string& path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw ParsingException("Runtime Error: Could not open [" + path + "] for reading");
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		throw ParsingException("Runtime Error: Could not get the size of [" + path + "]");
+	}
+	m_size = (size_t)size.QuadPart;
+
+	//an empty file can't be mapped, there is nothing to read anyway
+	if (m_size > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_mapping = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (mapping != nullptr)
+		{
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		throw ParsingException("Runtime Error: Could not open [" + path + "] for reading");
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw ParsingException("Runtime Error: Could not get the size of [" + path + "]");
+	}
+	m_size = (size_t)status.st_size;
+
+	//an empty file can't be mapped, there is nothing to read anyway
+	if (m_size > 0)
+	{
+		m_mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (m_mapping == MAP_FAILED)
+		{
+			m_mapping = nullptr;
+		}
+		else
+		{
+			//files are read front to back
+			madvise(m_mapping, m_size, MADV_SEQUENTIAL);
+		}
+	}
+	close(file);
+#endif
+
+	if (m_size > 0 && m_mapping == nullptr)
+	{
+		throw ParsingException("Runtime Error: Could not map [" + path + "] into memory");
+	}
+}
+
+void MappedFile::unmap()
+{
+	if (m_mapping != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_mapping);
+#else
+		munmap(m_mapping, m_size);
+#endif
+		m_mapping = nullptr;
+	}
+	m_size = 0;
+}
+
+ScriptFile::ScriptFile(const string& path, const string& mode) : m_path(path), m_writing(mode != "r")
+{
+	if (mode == "r")
+	{
+		m_mapping.reset(new MappedFile(path));
+		return;
+	}
+	if (mode != "w" && mode != "a")
+	{
+		throw ParsingException("Syntax Error: Unknown file mode [" + mode + "], expecting \"r\", \"w\" or \"a\"");
+	}
+
+	m_file = fopen(path.c_str(), mode == "w" ? "wb" : "ab");
+	if (m_file == nullptr)
+	{
+		throw ParsingException("Runtime Error: Could not open [" + path + "] for writing");
+	}
+	m_buffer.reserve(WRITE_BUFFER_SIZE);
+}
+
+ScriptFile::~ScriptFile()
+{
+	release();
+}
+
+bool ScriptFile::readLine(string& line)
+{
+	lock_guard<mutex> lock(m_mutex);
+	check(false, Tokens::READ_LINE);
+
+	size_t size = m_mapping->size();
+	if (m_position >= size)
+	{
+		return false;
+	}
+
+	const char* begin = m_mapping->data() + m_position;
+	const char* newLine = (const char*)memchr(begin, '\n', size - m_position);
+	size_t length = newLine != nullptr ? newLine - begin : size - m_position;
+	m_position += length + (newLine != nullptr ? 1 : 0);
+
+	if (length > 0 && begin[length - 1] == '\r')
+	{
+		length--;
+	}
+	line.assign(begin, length);
+	return true;
+}
+
+string ScriptFile::readAll()
+{
+	lock_guard<mutex> lock(m_mutex);
+	check(false, Tokens::READ_ALL);
+
+	string rest(m_mapping->data() + m_position, m_mapping->size() - m_position);
+	m_position = m_mapping->size();
+	return rest;
+}
+
+void ScriptFile::write(const string& text)
+{
+	lock_guard<mutex> lock(m_mutex);
+	check(true, Tokens::WRITE);
+
+	//large writes go to the file directly instead of through the buffer
+	if (m_buffer.size() + text.size() > WRITE_BUFFER_SIZE)
+	{
+		bool written = flush();
+		if (written && text.size() >= WRITE_BUFFER_SIZE)
+		{
+			written = fwrite(text.data(), 1, text.size(), m_file) == text.size();
+			if (written)
+			{
+				return;
+			}
+		}
+		if (!written)
+		{
+			throw ParsingException("Runtime Error: Could not write to " + toString());
+		}
+	}
+	m_buffer += text;
+}
+
+bool ScriptFile::flush()
+{
+	if (m_buffer.empty())
+	{
+		return true;
+	}
+
+	bool written = fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size();
+	m_buffer.clear();
+	return written;
+}
+
+void ScriptFile::close()
+{
+	lock_guard<mutex> lock(m_mutex);
+	if (!release())
+	{
+		throw ParsingException("Runtime Error: Could not write all of " + toString() + " before closing it");
+	}
+}
+
+bool ScriptFile::release()
+{
+	if (m_closed)
+	{
+		return true;
+	}
+	m_closed = true;
+
+	bool written = true;
+	if (m_file != nullptr)
+	{
+		written = flush();
+
+		//fclose() writes what is left in the buffer of the stream, that can fail as well
+		written = fclose(m_file) == 0 && written;
+		m_file = nullptr;
+	}
+	m_mapping.reset();
+	return written;
+}
+
+void ScriptFile::check(bool writing, const string& operation) const
+{
+	if (m_closed)
+	{
+		throw ParsingException("Runtime Error: " + operation + "() on the closed " + toString());
+	}
+	if (writing != m_writing)
+	{
+		throw ParsingException("Runtime Error: " + operation + "() on " + toString() + ", which is open for " + (m_writing ? "writing" : "reading"));
+	}
+}
+
+string ScriptFile::toString() const
+{
+	return "file(" + m_path + ")";
+}
+
+unique_ptr<ScriptIterator> ScriptFile::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new FileIterator(self));
+}
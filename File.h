@@ -0,0 +1,88 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+
+#include "Collections.h"
+
+/*
+*  Read only view of a whole file in memory (mmap on POSIX and
+*  MapViewOfFile on Windows). Empty files have no mapping, data() is
+*  nullptr then.
+*/
+class MappedFile
+{
+public:
+	MappedFile(const string& path);
+	~MappedFile() { unmap(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* data() const { return (const char*)m_mapping; }
+	size_t size() const		 { return m_size; }
+
+private:
+	void unmap();
+
+	void*  m_mapping = nullptr;
+	size_t m_size = 0;
+};
+
+/*
+*  File of the scripts (open(path, mode)), mode is "r", "w" or "a".
+*  A file that is read gets mapped into memory as a whole, readLine()
+*  only searches for the next line end in the mapping and copies the
+*  line into its Variable.
+*  Writes are collected in a buffer and written once it is full or the
+*  file gets closed. A file can be shared by tasks and pfor workers,
+*  every operation holds the lock of the file.
+*/
+class ScriptFile : public ScriptObject
+{
+public:
+	static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+	ScriptFile(const string& path, const string& mode);
+	virtual ~ScriptFile();
+
+	//returns false at the end of the file, the line end isn't part of the line
+	bool readLine(string& line);
+
+	//everything from the current position up to the end of the file
+	string readAll();
+
+	//an error if the text or the buffer before it could not be written
+	void write(const string& text);
+
+	//an error if the buffered text could not be written or the file not closed
+	void close();
+
+	virtual string toString() const;
+
+	//iterates over the remaining lines
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	//false if not all of the buffer could be written
+	bool flush();
+	//closes the file without throwing, as the destructor has to, false if something was lost
+	bool release();
+	void check(bool writing, const string& operation) const;
+
+	string m_path;
+	bool   m_writing;
+	bool   m_closed = false;
+
+	//reading
+	unique_ptr<MappedFile> m_mapping;
+	size_t				   m_position = 0;
+
+	//writing
+	FILE*  m_file = nullptr;
+	string m_buffer;
+
+	mutex m_mutex;
+};
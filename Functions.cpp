@@ -1,8 +1,16 @@
 //NOTE: project was based on https://github.com/vassilych/cscscpp
 
+#include <cmath>
+
+#include "Channel.h"
+#include "Collections.h"
+#include "Csv.h"
+#include "File.h"
 #include "Functions.h"
 #include "Interpreter.h"
+#include "Json.h"
 #include "Parser.h"
+#include "Scheduler.h"
 #include "ScriptHelper.h"
 
 Variable IdentityFunction::evaluate(ParsingScript& script)
@@ -34,21 +42,376 @@ Variable PrintFunction::evaluate(ParsingScript& script)
 {
 	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
 
+	//printed at once so that lines from pfor workers don't get mixed up
+	string output;
+	for (size_t i = 0; i < arguments.size(); i++) 
+	{
+		output += arguments[i].toString();
+	}
+
+	ScriptHelper::print(output, m_newLine);
+	return Variable::emptyInstance;
+}
+
+//COLLECTION FUNCTIONS
+Variable MapFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+
+	if (arguments.size() % 2 != 0) 
+	{
+		throw ParsingException("Syntax Error: Expecting \"map(key, value, ...)\" with key value pairs", script);
+	}
+
+	shared_ptr<ScriptMap> map = make_shared<ScriptMap>();
+	for (size_t i = 0; i < arguments.size(); i += 2) 
+	{
+		map->set(arguments[i], arguments[i + 1]);
+	}
+
+	return Variable(Tokens::MAP, map);
+}
+
+Variable ArrayFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+
+	shared_ptr<ScriptArray> arr = make_shared<ScriptArray>();
 	for (size_t i = 0; i < arguments.size(); i++) 
 	{
-		ScriptHelper::print(arguments[i].toString());
+		arr->push(arguments[i]);
+	}
+
+	return Variable(Tokens::ARRAY, arr);
+}
+
+Variable RangeFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+
+	if (arguments.empty() || arguments.size() > 3) 
+	{
+		throw ParsingException("Syntax Error: Expecting \"range(end)\", \"range(start, end)\" or \"range(start, end, step)\"", script);
+	}
+
+	double start = arguments.size() > 1 ? arguments[0].m_numericValue : 0.0;
+	double end = arguments.size() > 1 ? arguments[1].m_numericValue : arguments[0].m_numericValue;
+	double step = arguments.size() > 2 ? arguments[2].m_numericValue : 1.0;
+
+	return Variable(Tokens::RANGE, make_shared<ScriptRange>(start, end, step));
+}
+
+Variable PushFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+
+	Variable target = arguments.empty() ? Variable::emptyInstance : ParserFunction::writable(arguments[0]);
+	ScriptArray* arr = target.getArray();
+	if (arr == nullptr) 
+	{
+		throw ParsingException("Semantic Error: Function [" + m_name + "] expects an array as first argument", script);
+	}
+
+	for (size_t i = 1; i < arguments.size(); i++) 
+	{
+		arr->push(arguments[i]);
+	}
+	return Variable((double)arr->size());
+}
+
+Variable ContainsFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(2, arguments.size(), m_name);
+
+	if (ScriptMap* map = arguments[0].getMap()) 
+	{
+		return Variable(map->contains(arguments[1]));
+	}
+	if (ScriptArray* arr = arguments[0].getArray()) 
+	{
+		return Variable(arr->contains(arguments[1]));
+	}
+	if (arguments[0].m_type == Tokens::JSON) 
+	{
+		return Variable(static_cast<ScriptJson*>(arguments[0].m_object.get())->contains(arguments[1]));
+	}
+
+	throw ParsingException("Semantic Error: Function [" + m_name + "] expects a map or an array but found [" + arguments[0].toString() + "]", script);
+}
+
+Variable RemoveFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(2, arguments.size(), m_name);
+
+	Variable target = ParserFunction::writable(arguments[0]);
+	if (ScriptMap* map = target.getMap()) 
+	{
+		return Variable(map->remove(arguments[1]));
+	}
+	if (ScriptArray* arr = target.getArray()) 
+	{
+		ScriptHelper::checkNonNegativeInteger(arguments[1]);
+		return Variable(arr->removeAt((size_t)arguments[1].m_numericValue));
+	}
+
+	throw ParsingException("Semantic Error: Function [" + m_name + "] expects a map or an array but found [" + arguments[0].toString() + "]", script);
+}
+
+Variable SizeFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	const Variable& value = arguments[0];
+	switch (value.m_type) 
+	{
+		case Tokens::MAP:		return Variable((double)value.getMap()->size());
+		case Tokens::ARRAY:		return Variable((double)value.getArray()->size());
+		case Tokens::RANGE:		return Variable((double)static_cast<ScriptRange*>(value.m_object.get())->size());
+		case Tokens::JSON:		return Variable((double)static_cast<ScriptJson*>(value.m_object.get())->size());
+		case Tokens::STRING:	return Variable((double)value.m_stringValue.size());
+		default:				return Variable(0.0);
+	}
+}
+
+//TASK FUNCTIONS
+Variable YieldFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(0, arguments.size(), m_name);
+
+	Scheduler::yield();
+	return Variable::emptyInstance;
+}
+
+Variable SleepFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+	ScriptHelper::checkNonNegativeInteger(arguments[0]);
+
+	Scheduler::sleep((size_t)arguments[0].m_numericValue);
+	return Variable::emptyInstance;
+}
+
+Variable AwaitFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	return Scheduler::await(arguments[0]);
+}
+
+//CHANNEL FUNCTIONS
+static ScriptChannel* getChannelArgument(const Variable& value, const string& function)
+{
+	ScriptChannel* channel = value.getChannel();
+	if (channel == nullptr) 
+	{
+		throw ParsingException("Syntax Error: Function [" + function + "] expects a channel but got [" + value.toString() + "]");
+	}
+	return channel;
+}
+
+Variable ChannelFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+	ScriptHelper::checkNonNegativeInteger(arguments[0]);
+
+	if (arguments[0].m_numericValue < 1) 
+	{
+		throw ParsingException("Semantic Error: The capacity of a channel has to be at least 1");
+	}
+	return Variable(Tokens::CHANNEL, make_shared<ScriptChannel>((size_t)arguments[0].m_numericValue));
+}
+
+Variable SendFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(2, arguments.size(), m_name);
+
+	getChannelArgument(arguments[0], m_name)->send(arguments[1]);
+	return Variable::emptyInstance;
+}
+
+Variable RecvFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	Variable value;
+	if (!getChannelArgument(arguments[0], m_name)->recv(value)) 
+	{
+		throw ParsingException("Runtime Error: recv() on a closed and empty " + arguments[0].toString());
+	}
+	return value;
+}
+
+//tryRecv(channel) or tryRecv(channel, default), the default is returned if nothing is waiting
+Variable TryRecvFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	if (arguments.size() != 2) 
+	{
+		ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+	}
+
+	Variable value;
+	if (!getChannelArgument(arguments[0], m_name)->tryRecv(value)) 
+	{
+		return arguments.size() == 2 ? arguments[1] : Variable::emptyInstance;
+	}
+	return value;
+}
+
+//close(channel) or close(file)
+Variable CloseFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	if (ScriptFile* file = arguments[0].getFile()) 
+	{
+		file->close();
+	}
+	else 
+	{
+		getChannelArgument(arguments[0], m_name)->close();
+	}
+	return Variable::emptyInstance;
+}
+
+//FILE FUNCTIONS
+static ScriptFile* getFileArgument(const Variable& value, const string& function)
+{
+	ScriptFile* file = value.getFile();
+	if (file == nullptr) 
+	{
+		throw ParsingException("Syntax Error: Function [" + function + "] expects a file but got [" + value.toString() + "]");
+	}
+	return file;
+}
+
+//open(path) reads the file, open(path, "w") and open(path, "a") write it
+Variable OpenFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	if (arguments.size() != 2) 
+	{
+		ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+	}
+
+	string mode = arguments.size() == 2 ? arguments[1].toString() : "r";
+	return Variable(Tokens::FILE, make_shared<ScriptFile>(arguments[0].toString(), mode));
+}
+
+//readLine(file) or readLine(file, default), the default is returned at the end of the file
+Variable ReadLineFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	if (arguments.size() != 2) 
+	{
+		ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+	}
+
+	string line;
+	if (!getFileArgument(arguments[0], m_name)->readLine(line)) 
+	{
+		return arguments.size() == 2 ? arguments[1] : Variable::emptyInstance;
+	}
+	return Variable(line);
+}
+
+Variable ReadAllFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	return Variable(getFileArgument(arguments[0], m_name)->readAll());
+}
+
+//write(file, value, ...) writes the values one after the other, writeLine() adds a new line
+Variable WriteFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	if (arguments.size() < 2) 
+	{
+		ScriptHelper::checkArgsNumber(2, arguments.size(), m_name);
 	}
 
+	ScriptFile* file = getFileArgument(arguments[0], m_name);
+	for (size_t i = 1; i < arguments.size(); i++) 
+	{
+		file->write(arguments[i].toString());
+	}
 	if (m_newLine) 
 	{
-		ScriptHelper::print("", true);
+		file->write(Tokens::NEW_LINE);
 	}
 	return Variable::emptyInstance;
 }
 
+//csvRead(path) or csvRead(path, separator), the separator is "," by default and "\t" stands for a tab
+static char getSeparatorArgument(const vector<Variable>& arguments, const string& function)
+{
+	if (arguments.size() != 2) 
+	{
+		ScriptHelper::checkArgsNumber(1, arguments.size(), function);
+		return ',';
+	}
+
+	string separator = arguments[1].toString();
+	if (separator == "\\t") 
+	{
+		return '\t';
+	}
+	if (separator.size() != 1) 
+	{
+		throw ParsingException("Syntax Error: Function [" + function + "] expects a single character as separator but got [" + separator + "]");
+	}
+	return separator[0];
+}
+
+Variable CsvReadFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	char separator = getSeparatorArgument(arguments, m_name);
+
+	return CsvScanner::readColumns(arguments[0].toString(), separator);
+}
+
+Variable CsvRowsFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	char separator = getSeparatorArgument(arguments, m_name);
+
+	return Variable(Tokens::ROWS, make_shared<ScriptCsvRows>(arguments[0].toString(), separator));
+}
+
+//JSON FUNCTIONS
+Variable JsonParseFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	return Json::parse(arguments[0].toString());
+}
+
+Variable JsonStringifyFunction::evaluate(ParsingScript& script)
+{
+	vector<Variable> arguments = ScriptHelper::getArguments(script, Tokens::START_ARG, Tokens::END_ARG);
+	ScriptHelper::checkArgsNumber(1, arguments.size(), m_name);
+
+	return Variable(Json::stringify(arguments[0]));
+}
+
 //VARIABLES
 Variable GetVarFunction::evaluate(ParsingScript& script)
 {
+	RuntimeStats::local().stringBytes += m_value.m_stringValue.size();
 	return m_value;
 }
 
@@ -58,6 +421,16 @@ Variable ForStatement::evaluate(ParsingScript& script)
 	return Interpreter::evaluateFor(script);
 }
 
+Variable ParallelForStatement::evaluate(ParsingScript& script)
+{
+	return Interpreter::evaluateParallelFor(script);
+}
+
+Variable SpawnStatement::evaluate(ParsingScript& script)
+{
+	return Interpreter::evaluateSpawn(script);
+}
+
 Variable IfStatement::evaluate(ParsingScript& script)
 {
 	return Interpreter::evaluateIf(script);
@@ -90,6 +463,12 @@ Variable AssignFunction::evaluate(ParsingScript& script)
 		varValue.m_stringValue += addition.toString();
 	}
 
+	if (ScriptHelper::isArrayElement(m_name)) 
+	{
+		ParserFunction::setArrayElement(m_name, varValue, script);
+		return varValue;
+	}
+
 	ParserFunction::addGlobalOrLocalVariable(m_name, new GetVarFunction(varValue));
 	return varValue;
 }
@@ -107,10 +486,29 @@ Variable OperatorAssignFunction::evaluate(ParsingScript& script)
 	Variable right = ScriptHelper::getItem(script);
 
 	bool isGlobal = true;
-	ParserFunction* parserFunction = ParserFunction::getFunction(m_name, isGlobal);
-	ScriptHelper::checkNotNull(m_name, parserFunction);
-	Variable currentValue = parserFunction->getValue(script);
-	Variable left = currentValue;
+	bool isElement = ScriptHelper::isArrayElement(m_name);
+	Variable left;
+
+	if (isElement) 
+	{
+		left = ParserFunction::getArrayElement(m_name, script);
+
+		//a missing map entry starts out as 0 or as an empty string
+		if (left.m_type == Tokens::VOID && right.m_type == Tokens::STRING)
+		{
+			left.set(Tokens::EMPTY);
+		}
+		else if (left.m_type == Tokens::VOID)
+		{
+			left.set(0.0);
+		}
+	}
+	else 
+	{
+		ParserFunction* parserFunction = ParserFunction::getFunction(m_name, isGlobal);
+		ScriptHelper::checkNotNull(m_name, parserFunction);
+		left = parserFunction->getValue(script);
+	}
 
 	if (left.m_type == Tokens::NUMERIC) 
 	{
@@ -121,6 +519,12 @@ Variable OperatorAssignFunction::evaluate(ParsingScript& script)
 		stringOperator(left, right, m_action);
 	}
 
+	if (isElement) 
+	{
+		ParserFunction::setArrayElement(m_name, left, script);
+		return left;
+	}
+
 	ParserFunction::addGlobalOrLocalVariable(m_name, new GetVarFunction(left), isGlobal);
 
 	return left;
@@ -192,6 +596,17 @@ Variable IncrementDecrementFunction::evaluate(ParsingScript& script)
 	double newValue = 0;
 
 	bool isGlobal = true;
+	if (ScriptHelper::isArrayElement(m_name)) 
+	{
+		Variable element = ParserFunction::getArrayElement(m_name, script);
+
+		newValue = element.m_numericValue + returnDelta;
+		element.set(element.m_numericValue + valueDelta);
+
+		ParserFunction::setArrayElement(m_name, element, script);
+		return newValue;
+	}
+
 	ParserFunction* func = ParserFunction::getFunction(m_name, isGlobal);
 	ScriptHelper::checkNotNull(m_name, func);
 
@@ -32,34 +32,207 @@ private:
 	bool m_newLine;
 };
 
+//COLLECTION FUNCTIONS
+class MapFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class ArrayFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class RangeFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class PushFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class ContainsFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class RemoveFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class SizeFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+//TASK FUNCTIONS
+class YieldFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class SleepFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class AwaitFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+//CHANNEL FUNCTIONS
+class ChannelFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class SendFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class RecvFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class TryRecvFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class CloseFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+//FILE FUNCTIONS
+class OpenFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class ReadLineFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class ReadAllFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class WriteFunction : public ParserFunction
+{
+public:
+	WriteFunction(bool newLine = false) : m_newLine(newLine) {}
+
+	virtual Variable evaluate(ParsingScript& script);
+private:
+	bool m_newLine;
+};
+
+class CsvReadFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class CsvRowsFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+//JSON FUNCTIONS
+class JsonParseFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class JsonStringifyFunction : public ParserFunction
+{
+public:
+	virtual Variable evaluate(ParsingScript& script);
+};
+
 //CONTROL FLOW
 class ForStatement : public ParserFunction
 {
 public:
+	ForStatement() { setTraceCategory("loop"); }
+
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class ParallelForStatement : public ParserFunction
+{
+public:
+	ParallelForStatement() { setTraceCategory("loop"); }
+
+	virtual Variable evaluate(ParsingScript& script);
+};
+
+class SpawnStatement : public ParserFunction
+{
+public:
+	SpawnStatement() { setTraceCategory("task"); }
+
 	virtual Variable evaluate(ParsingScript& script);
 };
 
 class IfStatement : public ParserFunction
 {
 public:
+	IfStatement() { setTraceCategory("if"); }
+
 	virtual Variable evaluate(ParsingScript& script);
 };
 
 class WhileStatement : public ParserFunction
 {
 public:
+	WhileStatement() { setTraceCategory("loop"); }
+
 	virtual Variable evaluate(ParsingScript& script);
 };
 
 class BreakStatement : public ParserFunction
 {
 public:
+	BreakStatement() { setTraceCategory("control"); }
+
 	virtual Variable evaluate(ParsingScript& script);
 };
 
 class ContinueStatement : public ParserFunction
 {
 public:
+	ContinueStatement() { setTraceCategory("control"); }
+
 	virtual Variable evaluate(ParsingScript& script);
 };
 
@@ -70,6 +243,7 @@ public:
 
 	virtual Variable evaluate(ParsingScript& script);
 	const Variable& getValue() const { return m_value; }
+	void setValue(const Variable& value) { m_value = value; }
 	void setDelta(size_t delta) { m_delta = delta; }
 
 private:
@@ -0,0 +1,47 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "HostVariable.h"
+
+Variable HostVariable::getHostValue() const
+{
+	switch (m_hostType)
+	{
+		case DOUBLE:	return Variable(*static_cast<double*>(m_address));
+		case INT64:		return Variable((double)*static_cast<int64_t*>(m_address));
+		default:		return Variable(*static_cast<string*>(m_address));
+	}
+}
+
+void HostVariable::setHostValue(const Variable& value)
+{
+	if (m_readOnly)
+	{
+		throw ParsingException("Semantic Error: The host variable [" + m_name + "] is read only");
+	}
+
+	switch (m_hostType)
+	{
+		case DOUBLE:
+		case INT64:
+			if (value.m_type != Tokens::NUMERIC)
+			{
+				throw ParsingException("Semantic Error: The host variable [" + m_name + "] expects a number but got [" + value.toString() + "]");
+			}
+			if (m_hostType == DOUBLE)
+			{
+				*static_cast<double*>(m_address) = value.m_numericValue;
+				return;
+			}
+			ScriptHelper::checkInteger(value);
+			*static_cast<int64_t*>(m_address) = (int64_t)value.m_numericValue;
+			return;
+
+		default:
+			if (value.m_type != Tokens::STRING)
+			{
+				throw ParsingException("Semantic Error: The host variable [" + m_name + "] expects a string but got [" + value.toString() + "]");
+			}
+			*static_cast<string*>(m_address) = value.m_stringValue;
+			return;
+	}
+}
@@ -0,0 +1,41 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <cstdint>
+
+#include "ParserFunction.h"
+
+/*
+*  Variable of the host application exposed to the scripts by reference
+*  (Interpreter::bindVariable). Reading it reads the host memory, assigning
+*  to it writes the host memory unless it is read only. Nothing is copied
+*  into the script environment, so the host can change the value at any
+*  time without registering it again.
+*/
+class HostVariable : public ParserFunction
+{
+public:
+	HostVariable(double* address, bool readOnly) : m_hostType(DOUBLE), m_address(address), m_readOnly(readOnly) {}
+	HostVariable(int64_t* address, bool readOnly) : m_hostType(INT64), m_address(address), m_readOnly(readOnly) {}
+	HostVariable(string* address, bool readOnly) : m_hostType(STRING), m_address(address), m_readOnly(readOnly) {}
+
+	bool isReadOnly() const { return m_readOnly; }
+
+	Variable getHostValue() const;
+	void setHostValue(const Variable& value);
+
+	virtual Variable evaluate(ParsingScript& script) { return getHostValue(); }
+
+private:
+	enum HostType
+	{
+		DOUBLE,
+		INT64,
+		STRING
+	};
+
+	HostType m_hostType;
+	void*	 m_address;
+	bool	 m_readOnly;
+};
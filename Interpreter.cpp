@@ -1,24 +1,89 @@
 //NOTE: project was based on https://github.com/vassilych/cscscpp
 
+#include <cmath>
+#include <fstream>
 #include <iostream>
 
 #include "Interpreter.h"
+#include "Collections.h"
+#include "CompiledExpression.h"
+#include "ExecutionBudget.h"
 #include "Functions.h"
+#include "HostVariable.h"
 #include "Parser.h"
 #include "ParserFunction.h"
+#include "Profiler.h"
+#include "RuntimeStats.h"
+#include "Scheduler.h"
+#include "ScriptOptimizer.h"
+#include "ScriptServer.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
+
+once_flag Interpreter::m_initialized;
 
 void Interpreter::initialize() 
+{
+	//builtins and actions are shared by all threads and environments, they are only registered once
+	call_once(m_initialized, registerFunctions);
+}
+
+void Interpreter::registerFunctions() 
 {
 	// Add control flow functions	  
 	ParserFunction::addGlobalFunction(Tokens::BREAK, new BreakStatement());
 	ParserFunction::addGlobalFunction(Tokens::CONTINUE, new ContinueStatement());
 	ParserFunction::addGlobalFunction(Tokens::FOR, new ForStatement());
+	ParserFunction::addGlobalFunction(Tokens::PARALLEL_FOR, new ParallelForStatement());
+	ParserFunction::addGlobalFunction(Tokens::SPAWN, new SpawnStatement());
 	ParserFunction::addGlobalFunction(Tokens::IF, new IfStatement());
 	ParserFunction::addGlobalFunction(Tokens::WHILE, new WhileStatement());
 
 	// Add global functions
 	ParserFunction::addGlobalFunction(Tokens::PRINT, new PrintFunction(true));
 
+	// Add collection functions
+	ParserFunction::addGlobalFunction(Tokens::CREATE_MAP, new MapFunction());
+	ParserFunction::addGlobalFunction(Tokens::CREATE_ARRAY, new ArrayFunction());
+	ParserFunction::addGlobalFunction(Tokens::CREATE_RANGE, new RangeFunction());
+	ParserFunction::addGlobalFunction(Tokens::PUSH, new PushFunction());
+	ParserFunction::addGlobalFunction(Tokens::CONTAINS, new ContainsFunction());
+	ParserFunction::addGlobalFunction(Tokens::REMOVE, new RemoveFunction());
+	ParserFunction::addGlobalFunction(Tokens::SIZE, new SizeFunction());
+
+	// Add math functions
+	bind(Tokens::ABS, [](double value) { return fabs(value); });
+	bind(Tokens::SQRT, [](double value) { return sqrt(value); });
+	bind(Tokens::FLOOR, [](double value) { return floor(value); });
+	bind(Tokens::CEIL, [](double value) { return ceil(value); });
+	bind(Tokens::ROUND, [](double value) { return round(value); });
+
+	// Add channel functions
+	ParserFunction::addGlobalFunction(Tokens::CREATE_CHANNEL, new ChannelFunction());
+	ParserFunction::addGlobalFunction(Tokens::SEND, new SendFunction());
+	ParserFunction::addGlobalFunction(Tokens::RECV, new RecvFunction());
+	ParserFunction::addGlobalFunction(Tokens::TRY_RECV, new TryRecvFunction());
+	ParserFunction::addGlobalFunction(Tokens::CLOSE, new CloseFunction());
+
+	// Add file functions
+	ParserFunction::addGlobalFunction(Tokens::OPEN, new OpenFunction());
+	ParserFunction::addGlobalFunction(Tokens::READ_LINE, new ReadLineFunction());
+	ParserFunction::addGlobalFunction(Tokens::READ_ALL, new ReadAllFunction());
+	ParserFunction::addGlobalFunction(Tokens::WRITE, new WriteFunction(false));
+	ParserFunction::addGlobalFunction(Tokens::WRITE_LINE, new WriteFunction(true));
+	ParserFunction::addGlobalFunction(Tokens::CSV_READ, new CsvReadFunction());
+	ParserFunction::addGlobalFunction(Tokens::CSV_ROWS, new CsvRowsFunction());
+
+	// Add JSON functions
+	ParserFunction::addGlobalFunction(Tokens::JSON_PARSE, new JsonParseFunction());
+	ParserFunction::addGlobalFunction(Tokens::JSON_STRINGIFY, new JsonStringifyFunction());
+
+	// Add task functions
+	ParserFunction::addGlobalFunction(Tokens::YIELD, new YieldFunction());
+	ParserFunction::addGlobalFunction(Tokens::SLEEP, new SleepFunction());
+	ParserFunction::addGlobalFunction(Tokens::AWAIT, new AwaitFunction());
+
 	// Operator Functions
 	ParserFunction::addAction(Tokens::ASSIGNMENT, new AssignFunction());
 	ParserFunction::addAction(Tokens::INCREMENT, new IncrementDecrementFunction());
@@ -31,11 +96,153 @@ void Interpreter::initialize()
 	}
 }
 
+void Interpreter::setExecutionLimits(const ExecutionLimits& limits) 
+{
+	ExecutionBudget::setLimits(limits);
+}
+
+void Interpreter::bindVariable(const string& name, double& value, bool readOnly) 
+{
+	ParserFunction::addGlobalFunction(name, new HostVariable(&value, readOnly));
+}
+
+void Interpreter::bindVariable(const string& name, int64_t& value, bool readOnly) 
+{
+	ParserFunction::addGlobalFunction(name, new HostVariable(&value, readOnly));
+}
+
+void Interpreter::bindVariable(const string& name, string& value, bool readOnly) 
+{
+	ParserFunction::addGlobalFunction(name, new HostVariable(&value, readOnly));
+}
+
+void Interpreter::setThreadCount(size_t threadCount) 
+{
+	ThreadPool::setDefaultSize(threadCount);
+}
+
+void Interpreter::setProfiling(bool enabled) 
+{
+	Profiler::setEnabled(enabled);
+}
+
+void Interpreter::setOptimization(bool enabled) 
+{
+	ScriptOptimizer::setEnabled(enabled);
+}
+
+void Interpreter::printProfile(ostream& out) 
+{
+	Profiler::report(out);
+}
+
+void Interpreter::printStatistics(ostream& out) 
+{
+	RuntimeStats::report(out);
+}
+
+void Interpreter::startTrace(const string& filename) 
+{
+	Tracer::start(filename);
+}
+
+void Interpreter::stopTrace() 
+{
+	Tracer::stop();
+}
+
+void Interpreter::startSampling(size_t intervalMs) 
+{
+	Profiler::startSampling(intervalMs);
+}
+
+void Interpreter::stopSampling(ostream& out) 
+{
+	Profiler::stopSampling(out);
+}
+
+void Interpreter::saveSnapshot(const string& path) 
+{
+	string data = Snapshot::save();
+
+	ofstream file(path, ios::out | ios::binary | ios::trunc);
+	if (!file || !file.write(data.data(), data.size()))
+	{
+		throw ParsingException("Could not write the snapshot to [" + path + "]");
+	}
+}
+
+void Interpreter::loadSnapshot(const string& path) 
+{
+	ifstream file(path, ios::in | ios::binary | ios::ate);
+	if (!file)
+	{
+		throw ParsingException("Could not read the snapshot from [" + path + "]");
+	}
+
+	string data((size_t)file.tellg(), '\0');
+	file.seekg(0);
+	if (!file.read(&data[0], data.size()))
+	{
+		throw ParsingException("Could not read the snapshot from [" + path + "]");
+	}
+
+	Snapshot::restore(data);
+}
+
+void Interpreter::serve(const string& socketPath, size_t workerCount) 
+{
+	ScriptServer server(socketPath, workerCount);
+	server.run();
+}
+
+Environment Interpreter::fork() 
+{
+	return ParserFunction::forkGlobals();
+}
+
+void Interpreter::swapEnvironment(Environment& environment) 
+{
+	ParserFunction::swapGlobals(environment);
+}
+
 Variable Interpreter::evaluate(const string& script) 
 {
 	unordered_map<size_t, size_t> char2Line;
+	string data = convertToScript(script, char2Line);
+	return evaluate(script, data, char2Line, nullptr, 0);
+}
+
+Variable Interpreter::evaluate(const PreparedScript& script) 
+{
+	return evaluate(script.source, script.data, script.char2Line, nullptr, 0);
+}
+
+Variable Interpreter::evaluateEachLine(const string& script, RecordReader& records, char separator) 
+{
+	unordered_map<size_t, size_t> char2Line;
+	string data = convertToScript(script, char2Line);
+	return evaluate(script, data, char2Line, &records, separator);
+}
+
+PreparedScript Interpreter::prepare(const string& script) 
+{
+	PreparedScript prepared;
+	prepared.source = script;
+	prepared.data = convertToScript(script, prepared.char2Line);
+	return prepared;
+}
+
+string Interpreter::convertToScript(const string& script, unordered_map<size_t, size_t>& char2Line) 
+{
 	string data = ScriptHelper::convertToScript(script, char2Line);
-	
+	ScriptOptimizer::optimize(data, char2Line);
+	return data;
+}
+
+Variable Interpreter::evaluate(const string& script, const string& data, const unordered_map<size_t, size_t>& char2Line, 
+	RecordReader* records, char separator) 
+{
 	if (data.empty()) 
 	{
 		return Variable::emptyInstance;
@@ -45,13 +252,75 @@ Variable Interpreter::evaluate(const string& script)
 	parsingScript.setChar2Line(char2Line);
 	parsingScript.setRawScript(script);
 	Variable result;
+	ExecutionBudget::start();
+	RuntimeStats::registerThread();
+
+	// Statements of a script that isn't profiled must not be mapped to the lines of the profiled one
+	bool wasPaused = Profiler::isPaused();
+	Profiler::pause(!Profiler::start(parsingScript));
+
+	TraceScript traceScript;
+	const TraceScript* previousTraceScript = Tracer::getScript();
+	if (Tracer::isEnabled()) 
+	{
+		traceScript.index.load(parsingScript);
+		traceScript.source = ScriptHelper::tokenize(script);
+		Tracer::setScript(&traceScript);
+	}
+	TraceScope trace("evaluate", "phase");
 
-	while (parsingScript.hasNext()) 
+	// Errors only get here if they are recoverable, the caller may evaluate another script afterwards
+	try 
 	{
-		result = Parser::loadAndCalculate(parsingScript, Tokens::END_PARSING_STR);
-		ScriptHelper::goToNextStatement(parsingScript);
+		if (records == nullptr) 
+		{
+			result = evaluateStatements(parsingScript);
+		}
+		else 
+		{
+			// The script is converted only once, every record starts over at its first statement
+			const char* line;
+			size_t length;
+			while (records->next(line, length)) 
+			{
+				ParserFunction::assignVariable(Tokens::RECORD_LINE, Variable(string(line, length)));
+				ParserFunction::assignVariable(Tokens::RECORD_FIELDS, RecordReader::split(line, length, separator));
+				ParserFunction::assignVariable(Tokens::RECORD_NUMBER, Variable((double)records->getCount()));
+
+				parsingScript.setPointer(0);
+				result = evaluateStatements(parsingScript);
+			}
+		}
+
+		// Tasks that are still running get finished before the script ends
+		Scheduler::runAll();
 	}
+	catch (...) 
+	{
+		Scheduler::reset();
+		Profiler::pause(wasPaused);
+		Tracer::setScript(previousTraceScript);
+		throw;
+	}
+	Profiler::pause(wasPaused);
+	Tracer::setScript(previousTraceScript);
+
+	return result;
+}
 
+Variable Interpreter::evaluateStatements(ParsingScript& script) 
+{
+	Variable result;
+	while (script.hasNext()) 
+	{
+		ExecutionBudget::step();
+		RuntimeStats::local().statements++;
+		Profiler::enter(script.getPointer());
+		TraceScope trace(script.getPointer());
+		result = Parser::loadAndCalculate(script, Tokens::END_PARSING_STR);
+		Profiler::leave();
+		ScriptHelper::goToNextStatement(script);
+	}
 	return result;
 }
 
@@ -72,7 +341,7 @@ Variable Interpreter::evaluateIf(ParsingScript& script)
 			skipBlock(script);
 		}
 		skipRemainingBlocks(script);
-		return result;
+		return result.m_type == Tokens::BREAK_STATEMENT || result.m_type == Tokens::CONTINUE_STATEMENT ? result : Variable::emptyInstance;
 	}
 
 	// If above code is not called, we are in else and need to skip the whole if part
@@ -100,11 +369,80 @@ Variable Interpreter::evaluateFor(ParsingScript& script)
 	string forStatement = ScriptHelper::getBodyBetween(script, Tokens::START_ARG, Tokens::END_ARG);
 	script.increasePointer();
 
-	evaluateStandardFor(script, forStatement);
+	if (isForEach(forStatement)) 
+	{
+		evaluateForEach(script, forStatement);
+	}
+	else 
+	{
+		evaluateStandardFor(script, forStatement);
+	}
 
 	return Variable::emptyInstance;
 }
 
+bool Interpreter::isForEach(const string& forStatement) 
+{
+	bool inQuotes = false;
+
+	for (size_t i = 0; i < forStatement.size(); i++) 
+	{
+		char ch = forStatement[i];
+		if (ch == Tokens::QUOTE) 
+		{
+			inQuotes = !inQuotes;
+		}
+		else if (!inQuotes && ch == Tokens::END_STATEMENT) 
+		{
+			return false;
+		}
+		else if (!inQuotes && ch == Tokens::FOR_EACH) 
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Interpreter::evaluateForEach(ParsingScript& script, const string& forStatement) 
+{
+	size_t separator = forStatement.find(Tokens::FOR_EACH);
+	string varName = ScriptHelper::trim(forStatement.substr(0, separator));
+
+	if (varName.empty()) 
+	{
+		throw ParsingException("Syntax Error: Expecting \"for (item : collection)\"", script);
+	}
+
+	// The collection is evaluated once, afterwards the iterator produces one item per
+	// iteration without building a temporary container or parsing a condition again.
+	ParsingScript collectionPart(forStatement.substr(separator + 1));
+	Variable collection = collectionPart.execute();
+	unique_ptr<ScriptIterator> iterator = ScriptIterator::create(collection);
+
+	size_t startForCondition = script.getPointer();
+	Variable item;
+	Variable result;
+
+	while (iterator->next(item)) 
+	{
+		ParserFunction::assignVariable(varName, item);
+
+		script.setPointer(startForCondition);
+		ExecutionBudget::step();
+		result = evaluateBlock(script);
+
+		if (result.m_type == Tokens::BREAK_STATEMENT) 
+		{
+			break;
+		}
+	}
+
+	script.setPointer(startForCondition);
+	skipBlock(script);
+}
+
 void Interpreter::evaluateStandardFor(ParsingScript& script, const string& forStatement) 
 {
 	vector<string> forTokens = ScriptHelper::tokenize(forStatement, string(1, Tokens::END_STATEMENT));
@@ -114,49 +452,400 @@ void Interpreter::evaluateStandardFor(ParsingScript& script, const string& forSt
 		throw ParsingException("Syntax Error: Expecting \"for (init; condition; loopStatement)\"", script);
 	}
 
-	ParsingScript initPart(forTokens[0] + Tokens::END_STATEMENT);
-	ParsingScript conditionPart(forTokens[1] + Tokens::END_STATEMENT);
-	ParsingScript loopPart(forTokens[2] + Tokens::END_STATEMENT);
+	// The header is compiled once per loop entry, the iterations don't parse it again
+	CompiledExpression initPart(forTokens[0]);
+	CompiledExpression conditionPart(forTokens[1]);
+	CompiledExpression loopPart(forTokens[2]);
 
-	initPart.execute();
+	initPart.evaluate();
 
 	size_t startForCondition = script.getPointer();
 
-	int iterations = 0;
-	bool isValid = true;
-	Variable result;
+	if (!evaluateCountedFor(script, initPart, conditionPart, loopPart)) 
+	{
+		Variable result;
 
-	while (isValid) 
+		while (conditionPart.evaluate().m_numericValue != 0) 
+		{
+			script.setPointer(startForCondition);
+			ExecutionBudget::step();
+
+			result = evaluateBlock(script);
+
+			if (result.m_type == Tokens::BREAK_STATEMENT) 
+			{
+				break;
+			}
+			loopPart.evaluate();
+		}
+	}
+
+	// Also needed if the body was never executed or was left by continue
+	script.setPointer(startForCondition);
+	skipBlock(script);
+}
+
+bool Interpreter::evaluateCountedFor(ParsingScript& script, const CompiledExpression& initPart, 
+	const CompiledExpression& conditionPart, const CompiledExpression& loopPart) 
+{
+	// Only loops like "i = a; i < b; i++" with an integer counter qualify,
+	// the step can also be i--, i += c or i -= c with a constant integer c.
+	typedef CompiledExpression::Node Node;
+	const Node& init = initPart.getRoot();
+	const Node& condition = conditionPart.getRoot();
+	const Node& loop = loopPart.getRoot();
+
+	if (init.type != CompiledExpression::ASSIGN || condition.type != CompiledExpression::BINARY ||
+		condition.left->type != CompiledExpression::VARIABLE || condition.left->name != init.name || loop.name != init.name) 
 	{
-		Variable conditionResult = conditionPart.executeFrom(0);
-		isValid = conditionResult.m_numericValue != 0;
+		return false;
+	}
 
-		if (!isValid) { break; }
+	switch (condition.op) 
+	{
+		case CompiledExpression::LESS:
+		case CompiledExpression::LESS_EQ:
+		case CompiledExpression::GREATER:
+		case CompiledExpression::GREATER_EQ:
+		case CompiledExpression::NOT_EQUAL:
+			break;
+		default:
+			return false;
+	}
 
-		script.setPointer(startForCondition);
+	long long step = 0;
+	if (loop.type == CompiledExpression::INCREMENT) 
+	{
+		step = (long long)loop.delta;
+	}
+	else if (loop.type == CompiledExpression::OPERATOR_ASSIGN && (loop.action == "+=" || loop.action == "-=") &&
+		loop.right->type == CompiledExpression::CONSTANT && loop.right->value.m_type == Tokens::NUMERIC && 
+		ScriptHelper::isInt(loop.right->value.m_numericValue)) 
+	{
+		step = (long long)loop.right->value.m_numericValue * (loop.action == "+=" ? 1 : -1);
+	}
+	else 
+	{
+		return false;
+	}
+
+	const string& name = init.name;
+	Variable counterValue = CompiledExpression::getVariable(name);
+
+	if (counterValue.m_type != Tokens::NUMERIC || !ScriptHelper::isInt(counterValue.m_numericValue)) 
+	{
+		return false;
+	}
+
+	size_t startForCondition = script.getPointer();
+	long long counter = (long long)counterValue.m_numericValue;
+	Variable result;
+
+	while (true) 
+	{
+		// The loop variable is written before the bound is evaluated since the bound may use it
+		counterValue.m_numericValue = (double)counter;
+		ParserFunction::assignVariable(name, counterValue);
+
+		Variable bound = CompiledExpression::evaluate(*condition.right);
+		if (bound.m_type != Tokens::NUMERIC) 
+		{
+			// e.g. a string comparison, the regular loop continues from here
+			return false;
+		}
 
-		if (++iterations >= Tokens::MAX_LOOPS) 
+		double current = (double)counter;
+		CompiledExpression::numberOperator(condition.op, current, bound.m_numericValue);
+		if (current == 0) 
 		{
-			throw ParsingException("Semantic Error: Seems like an infinite loop after" + to_string(iterations) + " iterations", script);
+			return true;
 		}
 
+		script.setPointer(startForCondition);
+		ExecutionBudget::step();
+
 		result = evaluateBlock(script);
 
 		if (result.m_type == Tokens::BREAK_STATEMENT) 
 		{
-			script.setPointer(startForCondition);
-			skipBlock(script);
+			return true;
+		}
+
+		// The body may have changed the loop variable itself
+		Variable changed = CompiledExpression::getVariable(name);
+		if (changed.m_type != Tokens::NUMERIC || changed.m_numericValue != (double)counter) 
+		{
+			if (changed.m_type != Tokens::NUMERIC || !ScriptHelper::isInt(changed.m_numericValue)) 
+			{
+				loopPart.evaluate();
+				return false;
+			}
+			counter = (long long)changed.m_numericValue;
+		}
+
+		counter += step;
+	}
+}
+
+Variable Interpreter::evaluateParallelFor(ParsingScript& script) 
+{
+	string forStatement = ScriptHelper::getBodyBetween(script, Tokens::START_ARG, Tokens::END_ARG);
+	script.increasePointer();
+
+	// pfor (item : collection; sum(total), max(best))
+	size_t reductionStart = forStatement.size();
+	bool inQuotes = false;
+
+	for (size_t i = 0; i < forStatement.size(); i++) 
+	{
+		if (forStatement[i] == Tokens::QUOTE) 
+		{
+			inQuotes = !inQuotes;
+		}
+		else if (!inQuotes && forStatement[i] == Tokens::END_STATEMENT) 
+		{
+			reductionStart = i;
 			break;
 		}
-		loopPart.executeFrom(0);
 	}
+
+	string loopStatement = forStatement.substr(0, reductionStart);
+	size_t separator = loopStatement.find(Tokens::FOR_EACH);
+
+	if (!isForEach(loopStatement) || ScriptHelper::trim(loopStatement.substr(0, separator)).empty()) 
+	{
+		throw ParsingException("Syntax Error: Expecting \"pfor (item : collection; reductions)\"", script);
+	}
+
+	vector<Reduction> reductions;
+	if (reductionStart < forStatement.size()) 
+	{
+		reductions = getReductions(forStatement.substr(reductionStart + 1), script);
+	}
+
+	// A pfor inside of a pfor body runs on its worker like a regular for loop
+	if (ThreadPool::isWorker()) 
+	{
+		evaluateForEach(script, loopStatement);
+		return Variable::emptyInstance;
+	}
+
+	string varName = ScriptHelper::trim(loopStatement.substr(0, separator));
+	ParsingScript collectionPart(loopStatement.substr(separator + 1));
+	Variable collection = collectionPart.execute();
+
+	// Ranges and arrays are split by index, the items of anything else are collected first
+	const ScriptRange* range = collection.m_type == Tokens::RANGE ? static_cast<const ScriptRange*>(collection.m_object.get()) : nullptr;
+	const ScriptArray* items = collection.getArray();
+	vector<Variable> collected;
+	size_t count;
+
+	if (range != nullptr) 
+	{
+		count = range->size();
+	}
+	else if (items != nullptr) 
+	{
+		count = items->size();
+	}
+	else 
+	{
+		unique_ptr<ScriptIterator> iterator = ScriptIterator::create(collection);
+		Variable item;
+		while (iterator->next(item)) 
+		{
+			collected.push_back(item);
+		}
+		count = collected.size();
+	}
+
+	vector<Variable> totals;
+	vector<Variable> starts;
+
+	for (size_t i = 0; i < reductions.size(); i++) 
+	{
+		const Reduction& reduction = reductions[i];
+		ParserFunction* function = ParserFunction::getFunction(reduction.name);
+
+		if (function == nullptr && reduction.type != Tokens::REDUCE_SUM) 
+		{
+			throw ParsingException("Syntax Error: The reduction variable [" + reduction.name + "] has to be set before the pfor loop", script);
+		}
+
+		Variable total = function != nullptr ? CompiledExpression::getVariable(reduction.name) : Variable(0.0);
+		totals.push_back(total);
+
+		// Sums start from zero in every chunk, min and max from the current value
+		if (reduction.type != Tokens::REDUCE_SUM) 
+		{
+			starts.push_back(total);
+		}
+		else 
+		{
+			starts.push_back(total.m_type == Tokens::STRING ? Variable(Tokens::EMPTY) : Variable(0.0));
+		}
+	}
+
+	ThreadPool& pool = ThreadPool::getDefault();
+	size_t chunkCount = min(count, pool.size() * CHUNKS_PER_THREAD);
+
+	unordered_map<string, Variable> globals = ParserFunction::getGlobalValues();
+	size_t startForBody = script.getPointer();
+	size_t stepsBefore = ExecutionBudget::getSteps();
+	chrono::steady_clock::time_point deadline = ExecutionBudget::getDeadline();
+	const TraceScript* traceScript = Tracer::getScript();
+	ostream* output = ScriptHelper::getOutput();
+
+	vector<vector<Variable>> partials(chunkCount);
+	vector<size_t> steps(chunkCount);
+
+	pool.run(chunkCount, [&](size_t chunk) 
+	{
+		// Every chunk works on its own copy of the variables, only the reductions are passed back.
+		// Collections are shared, so the body may only write to distinct elements of an array.
+		ParserFunction::setGlobalValues(globals);
+		ExecutionBudget::resume(stepsBefore, deadline);
+		Tracer::setScript(traceScript);
+		ScriptHelper::setOutput(output);
+
+		for (size_t i = 0; i < reductions.size(); i++) 
+		{
+			ParserFunction::assignVariable(reductions[i].name, starts[i]);
+		}
+
+		ParsingScript body(script);
+		size_t from = chunk * count / chunkCount;
+		size_t to = (chunk + 1) * count / chunkCount;
+
+		for (size_t i = from; i < to; i++) 
+		{
+			ParserFunction::assignVariable(varName, range != nullptr ? Variable(range->at(i)) : items != nullptr ? items->at(i) : collected[i]);
+
+			body.setPointer(startForBody);
+			ExecutionBudget::step();
+
+			Variable result = evaluateBlock(body);
+
+			if (result.m_type == Tokens::BREAK_STATEMENT) 
+			{
+				throw ParsingException("Syntax Error: break is not supported in a pfor loop", body);
+			}
+		}
+
+		Scheduler::runAll();
+
+		for (size_t i = 0; i < reductions.size(); i++) 
+		{
+			partials[chunk].push_back(CompiledExpression::getVariable(reductions[i].name));
+		}
+
+		steps[chunk] = ExecutionBudget::getSteps() - stepsBefore;
+		ParserFunction::clearGlobals();
+	});
+
+	// The chunks are merged in order, so the result doesn't depend on the scheduling
+	size_t totalSteps = 0;
+	for (size_t chunk = 0; chunk < chunkCount; chunk++) 
+	{
+		totalSteps += steps[chunk];
+		for (size_t i = 0; i < reductions.size(); i++) 
+		{
+			mergeReduction(reductions[i], totals[i], partials[chunk][i]);
+		}
+	}
+
+	for (size_t i = 0; i < reductions.size(); i++) 
+	{
+		ParserFunction::assignVariable(reductions[i].name, totals[i]);
+	}
+	ExecutionBudget::addSteps(totalSteps);
+
+	script.setPointer(startForBody);
+	skipBlock(script);
+
+	return Variable::emptyInstance;
+}
+
+vector<Interpreter::Reduction> Interpreter::getReductions(const string& reductions, ParsingScript& script) 
+{
+	vector<Reduction> result;
+	vector<string> parts = ScriptHelper::tokenize(reductions, string(1, Tokens::NEXT_ARG), 0, string::npos, true);
+
+	for (size_t i = 0; i < parts.size(); i++) 
+	{
+		string part = ScriptHelper::trim(parts[i]);
+		size_t start = part.find(Tokens::START_ARG);
+
+		Reduction reduction;
+		if (start != string::npos && part.back() == Tokens::END_ARG) 
+		{
+			reduction.type = ScriptHelper::trim(part.substr(0, start));
+			reduction.name = ScriptHelper::trim(part.substr(start + 1, part.size() - start - 2));
+		}
+
+		if (reduction.name.empty() || (reduction.type != Tokens::REDUCE_SUM && 
+			reduction.type != Tokens::REDUCE_MIN && reduction.type != Tokens::REDUCE_MAX)) 
+		{
+			throw ParsingException("Syntax Error: Expecting a reduction like sum(name), min(name) or max(name) but got [" + part + "]", script);
+		}
+		result.push_back(reduction);
+	}
+
+	return result;
+}
+
+void Interpreter::mergeReduction(const Reduction& reduction, Variable& total, const Variable& partial) 
+{
+	if (reduction.type == Tokens::REDUCE_SUM) 
+	{
+		if (total.m_type == Tokens::NUMERIC) 
+		{
+			OperatorAssignFunction::numberOperator(total, partial, "+=");
+		}
+		else 
+		{
+			OperatorAssignFunction::stringOperator(total, partial, "+=");
+		}
+		return;
+	}
+
+	int order;
+	if (total.m_type == Tokens::NUMERIC && partial.m_type == Tokens::NUMERIC) 
+	{
+		order = partial.m_numericValue < total.m_numericValue ? -1 : partial.m_numericValue > total.m_numericValue ? 1 : 0;
+	}
+	else 
+	{
+		order = partial.toString().compare(total.toString());
+	}
+
+	if ((reduction.type == Tokens::REDUCE_MIN && order < 0) || (reduction.type == Tokens::REDUCE_MAX && order > 0)) 
+	{
+		total = partial;
+	}
+}
+
+Variable Interpreter::evaluateSpawn(ParsingScript& script) 
+{
+	string arguments = ScriptHelper::getBodyBetween(script, Tokens::START_ARG, Tokens::END_ARG);
+	script.increasePointer();
+
+	if (!ScriptHelper::trim(arguments).empty()) 
+	{
+		throw ParsingException("Syntax Error: Expecting \"spawn() { ... }\"", script);
+	}
+
+	// The task runs the block later, here it only gets skipped
+	Variable task = Scheduler::spawn(script, script.getPointer());
+	skipBlock(script);
+
+	return task;
 }
 
 Variable Interpreter::evaluateWhile(ParsingScript& script) 
 {
 	size_t startWhileCondition = script.getPointer();
 
-	int iterations = 0;
 	bool isValid = true;
 	Variable result;
 
@@ -168,11 +857,8 @@ Variable Interpreter::evaluateWhile(ParsingScript& script)
 		isValid = result.m_numericValue != 0;
 
 		if (!isValid) { break; }
-		
-		if (++iterations >= Tokens::MAX_LOOPS) 
-		{
-			throw ParsingException("Semantic Error: Seems like an infinite loop after" + to_string(iterations) + " iterations");
-		}
+
+		ExecutionBudget::step();
 
 		result = evaluateBlock(script);
 
@@ -206,7 +892,11 @@ Variable Interpreter::evaluateBlock(ParsingScript& script)
 			throw ParsingException("Syntax Error: Could not process block [" + script.substr(blockBegin) + "]", script);
 		}
 
+		ExecutionBudget::step();
+		RuntimeStats::local().statements++;
+		Profiler::enter(script.getPointer());
 		result = Parser::loadAndCalculate(script, Tokens::END_PARSING_STR);
+		Profiler::leave();
 
 		if (result.m_type == Tokens::BREAK_STATEMENT || result.m_type == Tokens::CONTINUE_STATEMENT) 
 		{
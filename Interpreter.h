@@ -2,20 +2,108 @@
 
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+
+#include "CompiledExpression.h"
+#include "ExecutionBudget.h"
+#include "NativeFunction.h"
+#include "RecordReader.h"
 #include "ScriptHelper.h"
 
+//a script that was converted once and can be evaluated many times, e.g. by the daemon of --serve
+struct PreparedScript
+{
+	string source;
+	string data;
+	unordered_map<size_t, size_t> char2Line;
+};
+
 class Interpreter
 {
 public:
+	//registers the builtins, calling it again does nothing
 	static void initialize();
+	static void setExecutionLimits(const ExecutionLimits& limits);
+	static void setThreadCount(size_t threadCount);
+	static void setProfiling(bool enabled);
+	//constant folding and removal of constant branches when a script is converted, on by default
+	static void setOptimization(bool enabled);
+	static void printProfile(ostream& out);
+	static void printStatistics(ostream& out);
+	static void startTrace(const string& filename);
+	static void stopTrace();
+	static void startSampling(size_t intervalMs);
+	static void stopSampling(ostream& out);
+
+	//writes the global variables of the calling thread to a binary snapshot file
+	static void saveSnapshot(const string& path);
+	//replaces the global variables of the calling thread with those of a snapshot file
+	static void loadSnapshot(const string& path);
+
 	static Variable evaluate(const string& script);
+	static Variable evaluate(const PreparedScript& script);
+	static PreparedScript prepare(const string& script);
+
+	//runs the script once for every line of the records, with line, fields and NR set to the current one
+	static Variable evaluateEachLine(const string& script, RecordReader& records, char separator = 0);
+
+	//a copy-on-write copy of the global variables of the calling thread, forking is O(1)
+	static Environment fork();
+	//exchanges the global variables of the calling thread with the environment, e.g. to evaluate a script in a fork
+	static void swapEnvironment(Environment& environment);
+
+	//answers the requests of local clients on a Unix socket until SIGINT or SIGTERM, see ScriptServer
+	static void serve(const string& socketPath, size_t workerCount);
+
+	//exposes a host variable to the scripts by reference, reads and writes go directly to its memory
+	static void bindVariable(const string& name, double& value, bool readOnly = false);
+	static void bindVariable(const string& name, int64_t& value, bool readOnly = false);
+	static void bindVariable(const string& name, string& value, bool readOnly = false);
+
+	//registers a C++ function or lambda as a builtin, argument and return types come from its signature
+	template<class F>
+	static void bind(const string& name, F function)
+	{
+		ParserFunction::addGlobalFunction(name, new typename NativeSignature<F>::template Function<F>(function));
+	}
 	
 	static Variable evaluateIf(ParsingScript& script);
 	static Variable evaluateWhile(ParsingScript& script);
 	static Variable evaluateFor(ParsingScript& script);
 	static void		evaluateStandardFor(ParsingScript& script, const string& forStatement);
+	static void		evaluateForEach(ParsingScript& script, const string& forStatement);
+	static Variable evaluateParallelFor(ParsingScript& script);
+	static Variable evaluateSpawn(ParsingScript& script);
 
 private:
+	friend class ScriptTask;
+
+	//reduction variable of a pfor loop, e.g. sum(total)
+	struct Reduction
+	{
+		string type;
+		string name;
+	};
+
+	//a pfor loop is split into this many chunks per worker thread
+	static const size_t CHUNKS_PER_THREAD = 4;
+
+	static void registerFunctions();
+
+	static once_flag m_initialized;
+
+	static vector<Reduction> getReductions(const string& reductions, ParsingScript& script);
+	static void mergeReduction(const Reduction& reduction, Variable& total, const Variable& partial);
+
+	static bool isForEach(const string& forStatement);
+	static bool evaluateCountedFor(ParsingScript& script, const CompiledExpression& initPart,
+		const CompiledExpression& conditionPart, const CompiledExpression& loopPart);
+
+	static string convertToScript(const string& script, unordered_map<size_t, size_t>& char2Line);
+	static Variable evaluate(const string& script, const string& data, const unordered_map<size_t, size_t>& char2Line, 
+		RecordReader* records, char separator);
+	static Variable evaluateStatements(ParsingScript& script);
 	static Variable evaluateBlock(ParsingScript& script);
 	static void skipBlock(ParsingScript& script);
 	static void skipRemainingBlocks(ParsingScript& script);
@@ -0,0 +1,57 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Interpreter.h"
+#include "InterpreterPool.h"
+
+InterpreterPool::Lease::Lease(InterpreterPool& pool) : m_pool(pool), m_environment(pool.acquire())
+{
+	Interpreter::swapEnvironment(m_environment);
+}
+
+InterpreterPool::Lease::~Lease()
+{
+	Interpreter::swapEnvironment(m_environment);
+	m_pool.release(move(m_environment));
+}
+
+Variable InterpreterPool::Lease::evaluate(const string& script)
+{
+	return Interpreter::evaluate(script);
+}
+
+InterpreterPool::InterpreterPool(size_t size) : m_template(Interpreter::fork())
+{
+	m_free.reserve(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		m_free.push_back(m_template.fork());
+	}
+}
+
+Environment InterpreterPool::acquire()
+{
+	lock_guard<mutex> lock(m_mutex);
+	if (m_free.empty())
+	{
+		//the template has no variables of its own, so forking it doesn't change it
+		return m_template.fork();
+	}
+
+	Environment environment = move(m_free.back());
+	m_free.pop_back();
+	return environment;
+}
+
+void InterpreterPool::release(Environment&& environment)
+{
+	environment.reset();
+
+	lock_guard<mutex> lock(m_mutex);
+	m_free.push_back(move(environment));
+}
+
+size_t InterpreterPool::available() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_free.size();
+}
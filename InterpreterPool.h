@@ -0,0 +1,60 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "Environment.h"
+#include "Variable.h"
+
+/*
+*  Environments that are ready to run a script, for hosts that run one
+*  script per request. They are forks of the globals the creating thread
+*  had at the time, e.g. the tables of a preamble. A script only adds to
+*  the own variables of its environment, they are the dirty list: release()
+*  deletes just these and the environment is as fresh as before, without
+*  registering the builtins or running the preamble again.
+*  acquire() and release() can be called from any thread.
+*/
+class InterpreterPool
+{
+public:
+	/*
+	*  Makes an environment of the pool the one of the calling thread,
+	*  the previous one is restored and the environment is returned to the
+	*  pool once the lease goes out of scope.
+	*/
+	class Lease
+	{
+	public:
+		Lease(InterpreterPool& pool);
+		~Lease();
+
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		Variable evaluate(const string& script);
+
+	private:
+		InterpreterPool& m_pool;
+		Environment		 m_environment;
+	};
+
+	//forks size environments from the globals of the calling thread
+	InterpreterPool(size_t size);
+
+	//an environment of the pool, a new one if all of them are in use
+	Environment acquire();
+
+	//resets the variables the script changed and keeps the environment for the next acquire()
+	void release(Environment&& environment);
+
+	size_t available() const;
+
+private:
+	Environment m_template; //never used itself, only forked
+
+	mutable mutex		m_mutex;
+	vector<Environment> m_free;
+};
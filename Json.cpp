@@ -0,0 +1,679 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Json.h"
+#include "ScriptHelper.h"
+
+class JsonIterator : public ScriptIterator
+{
+public:
+	JsonIterator(const shared_ptr<ScriptObject>& json) : m_object(json), m_json(static_cast<ScriptJson*>(json.get())) {}
+
+	virtual bool next(Variable& item)
+	{
+		if (m_position >= m_json->size())
+		{
+			return false;
+		}
+		item = m_json->isObject() ? m_json->keyAt(m_position) : m_json->valueAt(m_position);
+		m_position++;
+		return true;
+	}
+
+private:
+	shared_ptr<ScriptObject> m_object;
+	ScriptJson* m_json;
+	size_t m_position = 0;
+};
+
+static int hexValue(char ch)
+{
+	if (ch >= '0' && ch <= '9') return ch - '0';
+	if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+	return -1;
+}
+
+static void appendUtf8(uint32_t code, string& out)
+{
+	if (code < 0x80)
+	{
+		out += (char)code;
+	}
+	else if (code < 0x800)
+	{
+		out += (char)(0xC0 | (code >> 6));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		out += (char)(0xE0 | (code >> 12));
+		out += (char)(0x80 | ((code >> 6) & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		out += (char)(0xF0 | (code >> 18));
+		out += (char)(0x80 | ((code >> 12) & 0x3F));
+		out += (char)(0x80 | ((code >> 6) & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+}
+
+//DOCUMENT
+JsonDocument::JsonDocument(string text) : m_text(move(text))
+{
+	//most documents need about one entry per eight characters
+	m_tape.reserve(m_text.size() / 8 + 1);
+
+	size_t position = 0;
+	parseValue(position, 0);
+
+	skipWhitespace(position);
+	if (position < m_text.size())
+	{
+		fail(position, "unexpected text after the value");
+	}
+
+	listChildren();
+}
+
+void JsonDocument::parseValue(size_t& position, size_t depth)
+{
+	skipWhitespace(position);
+	if (position >= m_text.size())
+	{
+		fail(position, "unexpected end of the text");
+	}
+	if (depth > MAX_DEPTH)
+	{
+		fail(position, "the values are nested too deep");
+	}
+
+	char ch = m_text[position];
+	if (ch == '{' || ch == '[')
+	{
+		bool isObject = ch == '{';
+		char close = isObject ? '}' : ']';
+
+		size_t index = m_tape.size();
+		m_tape.push_back({ isObject ? OBJECT : ARRAY, false, position, 0, 0, 0, 0 });
+		position++;
+
+		size_t count = 0;
+		skipWhitespace(position);
+		if (position < m_text.size() && m_text[position] == close)
+		{
+			position++;
+		}
+		else
+		{
+			while (true)
+			{
+				if (isObject)
+				{
+					skipWhitespace(position);
+					if (position >= m_text.size() || m_text[position] != Tokens::QUOTE)
+					{
+						fail(position, "expecting the key of a member");
+					}
+					parseString(position);
+					expect(position, ':');
+				}
+				parseValue(position, depth + 1);
+				count++;
+
+				skipWhitespace(position);
+				if (position < m_text.size() && m_text[position] == ',')
+				{
+					position++;
+					continue;
+				}
+				expect(position, close);
+				break;
+			}
+		}
+
+		Entry& entry = m_tape[index];
+		entry.end = position;
+		entry.next = m_tape.size();
+		entry.count = count;
+	}
+	else if (ch == Tokens::QUOTE)
+	{
+		parseString(position);
+	}
+	else if (ch == '-' || (ch >= '0' && ch <= '9'))
+	{
+		parseNumber(position);
+	}
+	else if (ch == 't')
+	{
+		parseLiteral(position, "true", TRUE_VALUE);
+	}
+	else if (ch == 'f')
+	{
+		parseLiteral(position, "false", FALSE_VALUE);
+	}
+	else if (ch == 'n')
+	{
+		parseLiteral(position, "null", NULL_VALUE);
+	}
+	else
+	{
+		fail(position, "unexpected character");
+	}
+}
+
+void JsonDocument::listChildren()
+{
+	//every entry but the first is the child of one object or array, keys included
+	m_children.reserve(m_tape.size());
+	for (size_t index = 0; index < m_tape.size(); index++)
+	{
+		Entry& entry = m_tape[index];
+		if (entry.kind != OBJECT && entry.kind != ARRAY)
+		{
+			continue;
+		}
+
+		entry.children = m_children.size();
+		size_t child = index + 1;
+		for (size_t i = 0; i < entry.count; i++)
+		{
+			m_children.push_back(child);
+			child = m_tape[entry.kind == OBJECT ? child + 1 : child].next;
+		}
+	}
+}
+
+void JsonDocument::parseString(size_t& position)
+{
+	static const char* ESCAPES = "\"\\/bfnrtu";
+
+	size_t start = position + 1;
+	size_t current = start;
+	bool escaped = false;
+
+	while (true)
+	{
+		const char* quote = (const char*)memchr(m_text.data() + current, Tokens::QUOTE, m_text.size() - current);
+		if (quote == nullptr)
+		{
+			fail(position, "the string isn't terminated");
+		}
+
+		//only the part up to the quote can have escapes, one of them may be the quote itself
+		size_t end = quote - m_text.data();
+		const char* backslash = (const char*)memchr(m_text.data() + current, '\\', end - current);
+		if (backslash == nullptr)
+		{
+			m_tape.push_back({ STRING, escaped, start, end, m_tape.size() + 1, 0, 0 });
+			position = end + 1;
+			return;
+		}
+
+		escaped = true;
+		current = backslash - m_text.data() + 1;
+		char escape = current < m_text.size() ? m_text[current] : 0;
+		if (escape == 0 || strchr(ESCAPES, escape) == nullptr)
+		{
+			fail(current, "invalid escape sequence");
+		}
+		if (escape == 'u')
+		{
+			for (size_t i = 1; i <= 4; i++)
+			{
+				if (current + i >= m_text.size() || hexValue(m_text[current + i]) < 0)
+				{
+					fail(current, "invalid unicode escape");
+				}
+			}
+			current += 4;
+		}
+		current++;
+	}
+}
+
+void JsonDocument::parseNumber(size_t& position)
+{
+	size_t start = position;
+	auto digits = [&]()
+	{
+		size_t from = position;
+		while (position < m_text.size() && m_text[position] >= '0' && m_text[position] <= '9')
+		{
+			position++;
+		}
+		if (position == from)
+		{
+			fail(position, "expecting a digit");
+		}
+	};
+
+	if (m_text[position] == '-')
+	{
+		position++;
+	}
+	digits();
+	if (position < m_text.size() && m_text[position] == '.')
+	{
+		position++;
+		digits();
+	}
+	if (position < m_text.size() && (m_text[position] == 'e' || m_text[position] == 'E'))
+	{
+		position++;
+		if (position < m_text.size() && (m_text[position] == '+' || m_text[position] == '-'))
+		{
+			position++;
+		}
+		digits();
+	}
+
+	m_tape.push_back({ NUMBER, false, start, position, m_tape.size() + 1, 0, 0 });
+}
+
+void JsonDocument::parseLiteral(size_t& position, const char* literal, Kind kind)
+{
+	size_t length = strlen(literal);
+	if (m_text.compare(position, length, literal) != 0)
+	{
+		fail(position, "unexpected character");
+	}
+
+	m_tape.push_back({ kind, false, position, position + length, m_tape.size() + 1, 0, 0 });
+	position += length;
+}
+
+void JsonDocument::skipWhitespace(size_t& position) const
+{
+	while (position < m_text.size())
+	{
+		char ch = m_text[position];
+		if (ch != ' ' && ch != '\n' && ch != '\r' && ch != '\t')
+		{
+			return;
+		}
+		position++;
+	}
+}
+
+void JsonDocument::expect(size_t& position, char expected)
+{
+	skipWhitespace(position);
+	if (position >= m_text.size() || m_text[position] != expected)
+	{
+		fail(position, string("expecting [") + expected + "]");
+	}
+	position++;
+}
+
+void JsonDocument::fail(size_t position, const string& message) const
+{
+	size_t from = position > 20 ? position - 20 : 0;
+	throw ParsingException("Syntax Error: Invalid JSON at position " + to_string(position) + ", " + message +
+		" near [" + m_text.substr(from, 40) + "]");
+}
+
+Variable JsonDocument::toVariable(const shared_ptr<const JsonDocument>& self, size_t index) const
+{
+	const Entry& entry = m_tape[index];
+	switch (entry.kind)
+	{
+		case OBJECT:
+		case ARRAY:
+			return Variable(Tokens::JSON, make_shared<ScriptJson>(self, index));
+
+		case STRING:
+			return Variable(getString(index));
+
+		//the number was validated, strtod() stops right after it
+		case NUMBER:		return Variable(strtod(m_text.c_str() + entry.start, nullptr));
+		case TRUE_VALUE:	return Variable(1.0);
+		case FALSE_VALUE:	return Variable(0.0);
+		default:			return Variable::emptyInstance;
+	}
+}
+
+string JsonDocument::getString(size_t index) const
+{
+	const Entry& entry = m_tape[index];
+	if (!entry.escaped)
+	{
+		return m_text.substr(entry.start, entry.end - entry.start);
+	}
+
+	string result;
+	result.reserve(entry.end - entry.start);
+	for (size_t i = entry.start; i < entry.end; i++)
+	{
+		char ch = m_text[i];
+		if (ch != '\\')
+		{
+			result += ch;
+			continue;
+		}
+
+		ch = m_text[++i];
+		switch (ch)
+		{
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'n': result += '\n'; break;
+			case 'r': result += '\r'; break;
+			case 't': result += '\t'; break;
+			case 'u':
+			{
+				auto readCode = [&](size_t from)
+				{
+					uint32_t code = 0;
+					for (size_t j = 0; j < 4; j++)
+					{
+						code = (code << 4) | hexValue(m_text[from + j]);
+					}
+					return code;
+				};
+
+				uint32_t code = readCode(i + 1);
+				i += 4;
+
+				//characters beyond the first plane are written as a pair of surrogates
+				if (code >= 0xD800 && code <= 0xDBFF && i + 6 < entry.end && m_text[i + 1] == '\\' && m_text[i + 2] == 'u')
+				{
+					uint32_t low = readCode(i + 3);
+					if (low >= 0xDC00 && low <= 0xDFFF)
+					{
+						code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						i += 6;
+					}
+				}
+				appendUtf8(code, result);
+				break;
+			}
+			default: result += ch; break;
+		}
+	}
+	return result;
+}
+
+void JsonDocument::write(size_t index, string& out) const
+{
+	const Entry& entry = m_tape[index];
+	switch (entry.kind)
+	{
+		case OBJECT:
+		case ARRAY:
+		{
+			bool isObject = entry.kind == OBJECT;
+			out += isObject ? '{' : '[';
+
+			size_t child = index + 1;
+			for (size_t i = 0; i < entry.count; i++)
+			{
+				if (i > 0)
+				{
+					out += ',';
+				}
+				if (isObject)
+				{
+					write(child, out);
+					out += ':';
+					child++;
+				}
+				write(child, out);
+				child = m_tape[child].next;
+			}
+
+			out += isObject ? '}' : ']';
+			break;
+		}
+
+		//the text of a string is already escaped
+		case STRING:
+			out += Tokens::QUOTE;
+			out.append(m_text, entry.start, entry.end - entry.start);
+			out += Tokens::QUOTE;
+			break;
+
+		default:
+			out.append(m_text, entry.start, entry.end - entry.start);
+			break;
+	}
+}
+
+//JSON OBJECTS AND ARRAYS
+size_t ScriptJson::findKey(const string& key) const
+{
+	const string& text = m_document->text();
+	const size_t* children = m_document->children(m_index);
+	for (size_t i = 0; i < size(); i++)
+	{
+		size_t child = children[i];
+		const JsonDocument::Entry& entry = m_document->at(child);
+		bool found = entry.escaped ? m_document->getString(child) == key :
+			entry.end - entry.start == key.size() && text.compare(entry.start, key.size(), key) == 0;
+		if (found)
+		{
+			return child + 1;
+		}
+	}
+	return string::npos;
+}
+
+Variable ScriptJson::valueAt(size_t position) const
+{
+	size_t child = m_document->children(m_index)[position];
+	return m_document->toVariable(m_document, isObject() ? child + 1 : child);
+}
+
+Variable ScriptJson::keyAt(size_t position) const
+{
+	return Variable(m_document->getString(m_document->children(m_index)[position]));
+}
+
+bool ScriptJson::contains(const Variable& item) const
+{
+	if (isObject())
+	{
+		return findKey(item.toString()) != string::npos;
+	}
+
+	for (size_t i = 0; i < size(); i++)
+	{
+		Variable value = valueAt(i);
+		if (value.m_type == item.m_type && value.toString() == item.toString())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+string ScriptJson::toString() const
+{
+	string result;
+	write(result);
+	return result;
+}
+
+Variable ScriptJson::getElement(const Variable& index) const
+{
+	if (isObject())
+	{
+		size_t value = findKey(index.toString());
+		return value != string::npos ? m_document->toVariable(m_document, value) : Variable::emptyInstance;
+	}
+
+	ScriptHelper::checkNonNegativeInteger(index);
+	if (index.m_numericValue >= size())
+	{
+		throw ParsingException("Semantic Error: Index [" + index.toString() + "] is out of bounds, the array has " + to_string(size()) + " elements");
+	}
+	return valueAt((size_t)index.m_numericValue);
+}
+
+void ScriptJson::setElement(const Variable& index, const Variable&)
+{
+	throw ParsingException("Semantic Error: Values of jsonParse() are read only, [" + index.toString() + "] can't be set");
+}
+
+unique_ptr<ScriptIterator> ScriptJson::createIterator(const shared_ptr<ScriptObject>& self) const
+{
+	return unique_ptr<ScriptIterator>(new JsonIterator(self));
+}
+
+//PARSE AND STRINGIFY
+Variable Json::parse(const string& text)
+{
+	shared_ptr<const JsonDocument> document = make_shared<JsonDocument>(text);
+	return document->toVariable(document, 0);
+}
+
+string Json::stringify(const Variable& value)
+{
+	string out;
+	write(value, out, 0);
+	return out;
+}
+
+void Json::write(const Variable& value, string& out, size_t depth)
+{
+	//a collection that contains itself would never end
+	if (depth > JsonDocument::MAX_DEPTH)
+	{
+		throw ParsingException("Semantic Error: The value is nested too deep to be written as JSON");
+	}
+
+	switch (value.m_type)
+	{
+		case Tokens::VOID:
+			out += "null";
+			break;
+
+		case Tokens::NUMERIC:
+			writeNumber(value.m_numericValue, out);
+			break;
+
+		case Tokens::STRING:
+			writeString(value.m_stringValue, out);
+			break;
+
+		case Tokens::MAP:
+		{
+			ScriptMap* map = value.getMap();
+			out += '{';
+			for (size_t i = map->nextPosition(0); i != string::npos; i = map->nextPosition(i + 1))
+			{
+				if (out.back() != '{')
+				{
+					out += ',';
+				}
+				writeString(map->keyAt(i).toString(), out);
+				out += ':';
+				write(map->valueAt(i), out, depth + 1);
+			}
+			out += '}';
+			break;
+		}
+
+		case Tokens::ARRAY:
+		{
+			ScriptArray* arr = value.getArray();
+			out += '[';
+			for (size_t i = 0; i < arr->size(); i++)
+			{
+				if (i > 0)
+				{
+					out += ',';
+				}
+				write(arr->at(i), out, depth + 1);
+			}
+			out += ']';
+			break;
+		}
+
+		case Tokens::RANGE:
+		{
+			ScriptRange* range = static_cast<ScriptRange*>(value.m_object.get());
+			out += '[';
+			for (size_t i = 0; i < range->size(); i++)
+			{
+				if (i > 0)
+				{
+					out += ',';
+				}
+				writeNumber(range->at(i), out);
+			}
+			out += ']';
+			break;
+		}
+
+		case Tokens::JSON:
+			static_cast<ScriptJson*>(value.m_object.get())->write(out);
+			break;
+
+		default:
+			throw ParsingException("Semantic Error: A value of type " + Tokens::typeToString(value.m_type) + " can't be written as JSON");
+	}
+}
+
+void Json::writeString(const string& value, string& out)
+{
+	static const char* HEX = "0123456789abcdef";
+
+	out += Tokens::QUOTE;
+	for (char ch : value)
+	{
+		switch (ch)
+		{
+			case '"':	out += "\\\""; break;
+			case '\\':	out += "\\\\"; break;
+			case '\b':	out += "\\b"; break;
+			case '\f':	out += "\\f"; break;
+			case '\n':	out += "\\n"; break;
+			case '\r':	out += "\\r"; break;
+			case '\t':	out += "\\t"; break;
+			default:
+				if ((unsigned char)ch < 0x20)
+				{
+					out += "\\u00";
+					out += HEX[ch >> 4];
+					out += HEX[ch & 0xF];
+				}
+				else
+				{
+					out += ch;
+				}
+		}
+	}
+	out += Tokens::QUOTE;
+}
+
+void Json::writeNumber(double value, string& out)
+{
+	//JSON has no infinity and no NaN
+	if (!isfinite(value))
+	{
+		out += "null";
+		return;
+	}
+	if (ScriptHelper::isInt(value) && fabs(value) < 1e15)
+	{
+		out += to_string((long long)value);
+		return;
+	}
+
+	//the shortest text that gives back the same number
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.15g", value);
+	if (strtod(buffer, nullptr) != value)
+	{
+		snprintf(buffer, sizeof(buffer), "%.17g", value);
+	}
+	out += buffer;
+}
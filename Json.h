@@ -0,0 +1,124 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include "Collections.h"
+
+/*
+*  Parsed JSON text of jsonParse(). Parsing only validates the text and
+*  records a tape: one entry per value with its place in the text, and
+*  for objects and arrays the entry that follows them, so a whole subtree
+*  can be skipped in one step. Nothing is converted up front, strings are
+*  unescaped and numbers converted only when they are accessed.
+*  The members of an object are stored as key entry, value entry, ...
+*  After parsing, the tape entries of the children of every object and
+*  array are listed one after another, so an index or a key is found
+*  without walking the siblings before it.
+*/
+class JsonDocument
+{
+public:
+	enum Kind : uint8_t
+	{
+		OBJECT,
+		ARRAY,
+		STRING,
+		NUMBER,
+		TRUE_VALUE,
+		FALSE_VALUE,
+		NULL_VALUE
+	};
+
+	struct Entry
+	{
+		Kind   kind;
+		bool   escaped; //the string has escape sequences, it can't be used as it is
+		size_t start;	//text of a string (without quotes) or number, the opening bracket otherwise
+		size_t end;
+		size_t next;	//entry after this value and everything inside of it
+		size_t count;	//members of an object or items of an array
+		size_t children; //position of the first child in the list of children
+	};
+
+	static const size_t MAX_DEPTH = 1024;
+
+	JsonDocument(string text);
+
+	const string& text() const		 { return m_text; }
+	const Entry& at(size_t index) const { return m_tape[index]; }
+
+	//tape entries of the children of an object or array, for an object those of the keys
+	const size_t* children(size_t index) const { return m_children.data() + m_tape[index].children; }
+
+	//scalars are converted, objects and arrays become a ScriptJson that shares the document
+	Variable toVariable(const shared_ptr<const JsonDocument>& self, size_t index) const;
+
+	string getString(size_t index) const;
+
+	//writes the value as compact JSON
+	void write(size_t index, string& out) const;
+
+private:
+	void parseValue(size_t& position, size_t depth);
+	void listChildren();
+	void parseString(size_t& position);
+	void parseNumber(size_t& position);
+	void parseLiteral(size_t& position, const char* literal, Kind kind);
+	void skipWhitespace(size_t& position) const;
+	void expect(size_t& position, char expected);
+	void fail(size_t position, const string& message) const;
+
+	string		   m_text;
+	vector<Entry>  m_tape;
+	vector<size_t> m_children;
+};
+
+/*
+*  Object or array of a JSON document (a value of the JSON type).
+*  It is read only, keys and indices are looked up in the children that
+*  the document lists for its entry, so a new ScriptJson for the same
+*  value costs nothing.
+*/
+class ScriptJson : public ScriptObject
+{
+public:
+	ScriptJson(const shared_ptr<const JsonDocument>& document, size_t index) : m_document(document), m_index(index) {}
+
+	bool isObject() const { return m_document->at(m_index).kind == JsonDocument::OBJECT; }
+	size_t size() const	  { return m_document->at(m_index).count; }
+
+	bool contains(const Variable& item) const;
+
+	Variable valueAt(size_t position) const;
+	Variable keyAt(size_t position) const;
+
+	void write(string& out) const { m_document->write(m_index, out); }
+
+	virtual string toString() const;
+
+	virtual Variable getElement(const Variable& index) const;
+	virtual void setElement(const Variable& index, const Variable& value);
+
+	//an object iterates over its keys, an array over its items
+	virtual unique_ptr<ScriptIterator> createIterator(const shared_ptr<ScriptObject>& self) const;
+
+private:
+	size_t findKey(const string& key) const;
+
+	shared_ptr<const JsonDocument> m_document;
+	size_t						   m_index;
+};
+
+class Json
+{
+public:
+	static Variable parse(const string& text);
+
+	//compact JSON of a value, maps with numeric keys get them as strings
+	static string stringify(const Variable& value);
+
+private:
+	static void write(const Variable& value, string& out, size_t depth);
+	static void writeString(const string& value, string& out);
+	static void writeNumber(double value, string& out);
+};
@@ -0,0 +1,94 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "NativeFunction.h"
+
+size_t NativeBinding::checkArguments(const ParsingScript& script, size_t expected, const string& function)
+{
+	const string& data = script.getData();
+	size_t start = script.getPointer();
+
+	//called without an argument list
+	if (start >= data.size() || data[start] == Tokens::END_STATEMENT)
+	{
+		ScriptHelper::checkArgsNumber(expected, 0, function);
+		return start - 1;
+	}
+
+	//the arguments are only counted here, no copy of the script is needed for that
+	size_t commas = 0;
+	int depth = 0;
+	bool inQuotes = false;
+	bool empty = true;
+	size_t end = start;
+
+	for (; end < data.size(); end++)
+	{
+		char ch = data[end];
+		if (ch == Tokens::QUOTE && data[end - 1] != '\\')
+		{
+			inQuotes = !inQuotes;
+			empty = false;
+			continue;
+		}
+		if (inQuotes)
+		{
+			continue;
+		}
+
+		if (ch == Tokens::START_ARG || ch == Tokens::START_ARRAY)
+		{
+			depth++;
+		}
+		else if (ch == Tokens::END_ARG && depth == 0)
+		{
+			break;
+		}
+		else if (ch == Tokens::END_ARG || ch == Tokens::END_ARRAY)
+		{
+			depth--;
+		}
+		else if (ch == Tokens::NEXT_ARG && depth == 0)
+		{
+			commas++;
+		}
+
+		if (ch != Tokens::SPACE)
+		{
+			empty = false;
+		}
+	}
+
+	if (end >= data.size())
+	{
+		throw ParsingException("Syntax Error: Missing [" + Tokens::END_ARG_STR + "] in the call of [" + function + "]", script);
+	}
+
+	ScriptHelper::checkArgsNumber(expected, empty ? 0 : commas + 1, function);
+	return end;
+}
+
+void NativeBinding::finishArguments(ParsingScript& script, size_t end)
+{
+	if (script.getPointer() <= end)
+	{
+		script.setPointer(end + 1);
+	}
+	ScriptHelper::increasePointerIf(script, Tokens::SPACE);
+}
+
+void NativeBinding::checkNumeric(const Variable& value, size_t index, const string& function)
+{
+	if (value.m_type != Tokens::NUMERIC)
+	{
+		throw ParsingException("Syntax Error: Argument " + to_string(index + 1) + " of [" + function + "] has to be a number but got [" + value.toString() + "]");
+	}
+}
+
+void NativeBinding::checkInteger(const Variable& value, double min, double end, size_t index, const string& function)
+{
+	ScriptHelper::checkInteger(value);
+	if (value.m_numericValue < min || value.m_numericValue >= end)
+	{
+		throw ParsingException("Syntax Error: Argument " + to_string(index + 1) + " of [" + function + "] is out of the range of its type: [" + value.toString() + "]");
+	}
+}
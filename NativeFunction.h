@@ -0,0 +1,165 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ParserFunction.h"
+
+/*
+*  Conversion between script values and the parameter and return types
+*  of bound C++ functions. Supported are arithmetic types, string and
+*  Variable itself, anything else fails to compile when it gets bound.
+*/
+template<class T, class Enable = void>
+struct NativeValue
+{
+	static_assert(sizeof(T) == 0, "Unsupported type in a bound native function, use arithmetic types, string or Variable");
+};
+
+template<class T>
+struct NativeValue<T, typename enable_if<is_arithmetic<T>::value>::type>
+{
+	static T from(const Variable& value, size_t index, const string& function);
+	static Variable to(T value) { return Variable((double)value); }
+};
+
+template<>
+struct NativeValue<string>
+{
+	static string from(const Variable& value, size_t, const string&)
+	{
+		return value.m_type == Tokens::STRING ? value.m_stringValue : value.toString();
+	}
+	static Variable to(const string& value) { return Variable(value); }
+};
+
+template<>
+struct NativeValue<Variable>
+{
+	static Variable from(const Variable& value, size_t, const string&) { Variable result = value; result.m_action.clear(); return result; }
+	static Variable to(const Variable& value) { Variable result = value; result.m_action.clear(); return result; }
+};
+
+/*
+*  Non template helpers of NativeFunction.
+*/
+class NativeBinding
+{
+public:
+	//checks the number of arguments before any of them gets evaluated, returns the position of the closing ')'
+	static size_t checkArguments(const ParsingScript& script, size_t expected, const string& function);
+
+	//moves behind the argument list once all arguments were read
+	static void finishArguments(ParsingScript& script, size_t end);
+
+	static void checkNumeric(const Variable& value, size_t index, const string& function);
+
+	//an integer in [min, end)
+	static void checkInteger(const Variable& value, double min, double end, size_t index, const string& function);
+
+	//evaluates the next argument directly from the script
+	template<class T>
+	static T readArgument(ParsingScript& script, size_t index, const string& function)
+	{
+		return NativeValue<T>::from(ScriptHelper::getItem(script), index, function);
+	}
+};
+
+template<class T>
+T NativeValue<T, typename enable_if<is_arithmetic<T>::value>::type>::from(const Variable& value, size_t index, const string& function)
+{
+	NativeBinding::checkNumeric(value, index, function);
+
+	//converting a fraction or a value out of range to an integer type is undefined, bool takes any number
+	if (is_integral<T>::value && !is_same<T, bool>::value)
+	{
+		//the bounds are 0 or powers of 2, so they are exact
+		NativeBinding::checkInteger(value, (double)numeric_limits<T>::min(), ldexp(1.0, numeric_limits<T>::digits), index, function);
+	}
+	return (T)value.m_numericValue;
+}
+
+//true if any of the types is a non const lvalue reference
+template<class... T>
+struct HasOutParameter : false_type {};
+
+template<class T, class... Rest>
+struct HasOutParameter<T, Rest...> : integral_constant<bool,
+	(is_lvalue_reference<T>::value && !is_const<typename remove_reference<T>::type>::value) || HasOutParameter<Rest...>::value> {};
+
+/*
+*  Builtin that calls a C++ function or lambda with the signature R(Args...).
+*  Each argument is evaluated straight into its typed slot, there is no
+*  temporary vector of Variables and the argument count is part of the type.
+*/
+template<class F, class R, class... Args>
+class NativeFunction : public ParserFunction
+{
+public:
+	static_assert(!HasOutParameter<Args...>::value,
+		"Non const reference parameters can't be bound, the changes would never reach the script");
+
+	NativeFunction(F function) : m_function(function) {}
+
+	virtual Variable evaluate(ParsingScript& script)
+	{
+		return invoke(script, make_index_sequence<sizeof...(Args)>());
+	}
+
+private:
+	typedef tuple<typename decay<Args>::type...> Arguments;
+
+	template<size_t... I>
+	Variable invoke(ParsingScript& script, index_sequence<I...>)
+	{
+		size_t end = NativeBinding::checkArguments(script, sizeof...(Args), m_name);
+
+		//braced initialization evaluates the arguments from left to right
+		Arguments arguments{ NativeBinding::readArgument<typename decay<Args>::type>(script, I, m_name)... };
+		NativeBinding::finishArguments(script, end);
+
+		return call(arguments, is_void<R>(), index_sequence<I...>());
+	}
+
+	template<size_t... I>
+	Variable call(Arguments& arguments, false_type, index_sequence<I...>)
+	{
+		return NativeValue<typename decay<R>::type>::to(m_function(get<I>(arguments)...));
+	}
+
+	template<size_t... I>
+	Variable call(Arguments& arguments, true_type, index_sequence<I...>)
+	{
+		m_function(get<I>(arguments)...);
+		return Variable::emptyInstance;
+	}
+
+	F m_function;
+};
+
+//deduces the NativeFunction for a function pointer or a lambda
+template<class F>
+struct NativeSignature : NativeSignature<decltype(&F::operator())> {};
+
+template<class R, class... Args>
+struct NativeSignature<R(*)(Args...)>
+{
+	template<class F> using Function = NativeFunction<F, R, Args...>;
+};
+
+template<class C, class R, class... Args>
+struct NativeSignature<R(C::*)(Args...)>
+{
+	template<class F> using Function = NativeFunction<F, R, Args...>;
+};
+
+template<class C, class R, class... Args>
+struct NativeSignature<R(C::*)(Args...) const>
+{
+	template<class F> using Function = NativeFunction<F, R, Args...>;
+};
@@ -9,6 +9,8 @@
 
 Variable Parser::loadAndCalculate(ParsingScript& script, const string& endCondition) 
 {
+	RuntimeStats::local().expressions++;
+
 	vector<Variable> vectorToMerge = split(script, endCondition);
 
 	if (vectorToMerge.empty()) 
@@ -41,6 +43,7 @@ vector<Variable> Parser::split(ParsingScript& script, const string& endCondition
 
     string parsingItem;
     int negated = 0;
+    int arrayDepth = 0;
     bool inQuotes = false;    
 
     do
@@ -55,14 +58,17 @@ vector<Variable> Parser::split(ParsingScript& script, const string& endCondition
         }
 
         char ch = script.currentCharAndIncreasePointer();
+        RuntimeStats::local().characters++;
         checkQuotes(script, ch, inQuotes);
+        checkArrayIndex(ch, inQuotes, arrayDepth);
 
         string action = Tokens::EMPTY;
         
-        if (inQuotes || isStillCollecting(script, parsingItem, endCondition, action))
+        // Everything between [] belongs to the index of the current item, e.g. map[key + 1]
+        if (inQuotes || arrayDepth > 0 || isStillCollecting(script, parsingItem, endCondition, action))
         { 
             parsingItem += ch;            
-			if (script.hasNext() && (inQuotes || !ScriptHelper::contains(endCondition, script.currentChar()))) {
+			if (script.hasNext() && (inQuotes || arrayDepth > 0 || !ScriptHelper::contains(endCondition, script.currentChar()))) {
                 continue;
             }
         }
@@ -79,6 +85,7 @@ vector<Variable> Parser::split(ParsingScript& script, const string& endCondition
         // We are done getting the next token. The getValue() call below may
         // recursively call loadAndCalculate(). This will happen if extracted
         // item is a function or if the next item is starting with a START_ARG '('.
+        RuntimeStats::local().tokens++;
         ParserFunction func(script, parsingItem, ch, action);
         Variable current = func.getValue(script);
 
@@ -120,7 +127,7 @@ vector<Variable> Parser::split(ParsingScript& script, const string& endCondition
         vectorToMerge.emplace_back(current);
         parsingItem.clear();
 
-    } while (script.hasNext() && (inQuotes || !ScriptHelper::contains(endCondition, script.currentChar())));
+    } while (script.hasNext() && (inQuotes || arrayDepth > 0 || !ScriptHelper::contains(endCondition, script.currentChar())));
 
     // This happens when called recursively inside of the math expression:
     ScriptHelper::increasePointerIf(script, Tokens::END_ARG);
@@ -150,7 +157,7 @@ bool Parser::isStillCollecting(const ParsingScript& script, const string& item,
 
     // Otherwise, if it's an action (+, -, *, etc.) or a space
     // we're done collecting current token.
-    ParsingScript tempScript(script.getData(), script.getPointer() - 1);
+    ParsingScript tempScript(script, script.getPointer() - 1);
     action = ScriptHelper::getValidAction(tempScript);
 
     if (action != Tokens::EMPTY || (item.size() > 0 && ch == Tokens::SPACE)) 
@@ -175,6 +182,24 @@ void Parser::checkQuotes(const ParsingScript& script,
     }
 }
 
+void Parser::checkArrayIndex(char ch, bool inQuotes, int& arrayDepth)
+{
+    if (inQuotes) 
+    {
+        return;
+    }
+
+    switch (ch)
+    {
+        case Tokens::START_ARRAY:
+            arrayDepth++;
+            return;
+        case Tokens::END_ARRAY:
+            arrayDepth--;
+            return;
+    }
+}
+
 void Parser::checkConsistency(const ParsingScript& script, const string& item, const vector<Variable>& listToMerge)
 {
     if (listToMerge.empty()) 
@@ -210,7 +235,7 @@ string Parser::updateAction(ParsingScript& script, const string& endCondition)
         return Tokens::NULL_ACTION;
     }
     
-    ParsingScript tempScript(script.getData(), script.getPointer());
+    ParsingScript tempScript(script, script.getPointer());
     string action = ScriptHelper::getValidAction(tempScript);    
     
     size_t advance = action.empty() ? 0 : action.size();
@@ -231,6 +256,7 @@ Variable Parser::merge(Variable& current, size_t& index,
         }
 
         current.merge(next);
+        RuntimeStats::local().nodes++;
         if (mergeOneOnly) 
         {
             break;
@@ -14,6 +14,9 @@ public:
 	static Variable loadAndCalculate(ParsingScript& script, const std::string& endCondition);
 
 private:
+	//folds constant expressions with the same merge
+	friend class ScriptOptimizer;
+
 	static std::vector<Variable> split(ParsingScript& script, const std::string& endCondition);
 
 	static void checkConsistency(const ParsingScript& script, const string& item, const vector<Variable>& listToMerge);
@@ -22,6 +25,8 @@ private:
 
 	static void checkQuotes(const ParsingScript& script, char ch, bool& inQuotes);
 
+	static void checkArrayIndex(char ch, bool inQuotes, int& arrayDepth);
+
 	static Variable merge(Variable& current, size_t& index, vector<Variable>& listToMerge, bool mergeOnlyOne = false);
 
 	static string updateAction(ParsingScript& script, const string& endCondition);
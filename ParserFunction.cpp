@@ -4,12 +4,15 @@
 
 #include "ParserFunction.h"
 #include "Functions.h"
+#include "HostVariable.h"
+#include "Tracer.h"
 
 unordered_map<string, ParserFunction*> ParserFunction::m_functions;
-unordered_map<string, ParserFunction*> ParserFunction::m_globals;
+thread_local Environment ParserFunction::m_globals;
 unordered_map<string, ActionFunction*> ParserFunction::m_actions;
+bool ParserFunction::m_hostVariables = false;
 
-StringOrNumericFunction* ParserFunction::m_strOrNumericFunction = new StringOrNumericFunction();
+thread_local StringOrNumericFunction* ParserFunction::m_strOrNumericFunction = new StringOrNumericFunction();
 IdentityFunction* ParserFunction::m_idFunction = new IdentityFunction();
 
 ParserFunction::ParserFunction(ParsingScript& script, const string& item, char ch, string& action) : m_newInstance(false) 
@@ -27,6 +30,9 @@ ParserFunction::ParserFunction(ParsingScript& script, const string& item, char c
 	m_implementation = getFunction(item);
 	if (m_implementation != 0) { return; }
 
+	m_implementation = getArrayFunction(item, script);
+	if (m_implementation != 0) { return; }
+
 	if (m_implementation == m_strOrNumericFunction && item.empty()) 
 	{
 		string problem = !action.empty() ? action : string(1, ch);
@@ -49,6 +55,13 @@ ParserFunction::~ParserFunction()
 
 Variable ParserFunction::getValue(ParsingScript& script) 
 {
+	const char* category = m_implementation->m_traceCategory;
+	if (category != nullptr && Tracer::isEnabled()) 
+	{
+		TraceScope trace(m_implementation->getName(), category, script.getPointer());
+		return m_implementation->evaluate(script);
+	}
+
 	Variable result = m_implementation->evaluate(script);
 	return result;
 }
@@ -56,24 +69,69 @@ Variable ParserFunction::getValue(ParsingScript& script)
 ParserFunction* ParserFunction::getFunction(const string& name, bool& isGlobal) 
 {
 	isGlobal = true;
+	RuntimeStats::local().lookups++;
 
 	//check if a global variable exists
-	auto it = m_globals.find(name);
-	if (it != m_globals.end()) 
+	ParserFunction* variable = m_globals.find(name);
+	if (variable != nullptr) 
 	{
-		return it->second;
+		return variable;
 	}
 
 	//check if a registered global function with the given name exists
-	it = m_functions.find(name);
+	auto it = m_functions.find(name);
 	if (it != m_functions.end()) 
 	{
 		return it->second;
 	}
 	
+	RuntimeStats::local().lookupMisses++;
 	return 0;
 }
 
+ParserFunction* ParserFunction::getArrayFunction(const string& item, ParsingScript& script) 
+{
+	if (!ScriptHelper::isArrayElement(item)) { return 0; }
+
+	//the element is copied into a temporary variable that gets deleted together with this function
+	GetVarFunction* element = new GetVarFunction(getArrayElement(item, script));
+	element->setNewInstance();
+	return element;
+}
+
+Variable ParserFunction::getArrayElement(const string& item, ParsingScript& script) 
+{
+	string name;
+	vector<Variable> indices = ScriptHelper::getArrayIndices(item, name);
+
+	ParserFunction* function = getFunction(name);
+	ScriptHelper::checkNotNull(name, function);
+
+	Variable value = function->getValue(script);
+	for (size_t i = 0; i < indices.size(); i++) 
+	{
+		value = value.getElement(indices[i]);
+	}
+	return value;
+}
+
+void ParserFunction::setArrayElement(const string& item, const Variable& value, ParsingScript& script) 
+{
+	string name;
+	vector<Variable> indices = ScriptHelper::getArrayIndices(item, name);
+
+	ParserFunction* function = getFunction(name);
+	ScriptHelper::checkNotNull(name, function);
+
+	//collections are shared, so changing the innermost one changes the variable as well
+	Variable container = function->getValue(script);
+	for (size_t i = 0; i + 1 < indices.size(); i++) 
+	{
+		container = container.getElement(indices[i]);
+	}
+	m_globals.writable(container).setElement(indices.back(), value);
+}
+
 ActionFunction* ParserFunction::getRegisteredAction(const string& name, string& action) 
 {
 	ActionFunction* actionFunction = getAction(action);
@@ -105,6 +163,14 @@ void ParserFunction::addAction(const string& name, ActionFunction* action)
 
 void ParserFunction::addGlobalFunction(const string& name, ParserFunction* function, bool isNative) 
 {
+	if (dynamic_cast<HostVariable*>(function) != nullptr) 
+	{
+		m_hostVariables = true;
+	}
+	else if (function->m_traceCategory == nullptr) 
+	{
+		function->m_traceCategory = "builtin";
+	}
 	add(m_functions, function, name, isNative);
 }
 
@@ -116,7 +182,69 @@ void ParserFunction::addGlobalOrLocalVariable(const string& name, ParserFunction
 
 void ParserFunction::addGlobalVariable(const string& name, ParserFunction* function) 
 {
-	add(m_globals, function, name, false);
+	//assigning to a host variable writes through to the host instead of creating a script variable
+	GetVarFunction* variable = m_hostVariables ? dynamic_cast<GetVarFunction*>(function) : nullptr;
+	if (variable != nullptr && assignHostVariable(name, variable->getValue())) 
+	{
+		delete function;
+		return;
+	}
+
+	add(m_globals.variables(), function, name, false);
+}
+
+bool ParserFunction::assignHostVariable(const string& name, const Variable& value) 
+{
+	if (!m_hostVariables) 
+	{
+		return false;
+	}
+
+	auto it = m_functions.find(name);
+	HostVariable* hostVariable = it != m_functions.end() ? dynamic_cast<HostVariable*>(it->second) : nullptr;
+
+	if (hostVariable == nullptr) 
+	{
+		return false;
+	}
+	hostVariable->setHostValue(value);
+	return true;
+}
+
+void ParserFunction::assignVariable(const string& name, const Variable& value) 
+{
+	//a variable of a fork is only changed once it was added to the own variables
+	auto it = m_globals.variables().find(name);
+	GetVarFunction* variable = it != m_globals.variables().end() ? dynamic_cast<GetVarFunction*>(it->second) : nullptr;
+
+	if (variable == nullptr) 
+	{
+		if (!assignHostVariable(name, value)) 
+		{
+			addGlobalVariable(name, new GetVarFunction(value));
+		}
+		return;
+	}
+	variable->setValue(value);
+}
+
+unordered_map<string, Variable> ParserFunction::getGlobalValues() 
+{
+	return m_globals.getValues();
+}
+
+void ParserFunction::setGlobalValues(const unordered_map<string, Variable>& values) 
+{
+	clearGlobals();
+	for (auto it = values.begin(); it != values.end(); ++it) 
+	{
+		addGlobalVariable(it->first, new GetVarFunction(it->second));
+	}
+}
+
+void ParserFunction::clearGlobals() 
+{
+	m_globals.clear();
 }
 
 template<class T, class S>
@@ -134,6 +262,7 @@ void ParserFunction::add(T& container, S& value, const string& key, bool isNativ
 		if (isNative) { throw ParsingException("Global name [" + key + "] already exists!"); }
 
 		//delete and replace with the new one
+		RuntimeStats::local().replacements++;
 		delete tryInsert.first->second;
 		tryInsert.first->second = value;
 	}
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Environment.h"
 #include "Tokens.h"
 #include "ScriptHelper.h"
 #include "Variable.h"
@@ -30,6 +31,10 @@ public:
 	bool isGlobal() const { return m_isGlobal; }
 	void setGlobal(bool isGlobal) { m_isGlobal = isGlobal; }
 
+	//builtins and control statements show up in the trace, nullptr for everything else
+	const char* getTraceCategory() const { return m_traceCategory; }
+	void setTraceCategory(const char* category) { m_traceCategory = category; }
+
 	void setNewInstance() { m_newInstance = true; }
 	bool isNewInstance() { return m_newInstance; }
 
@@ -38,6 +43,10 @@ public:
 	static ParserFunction* getFunction(const string& name) { bool isGlobal = false; return getFunction(name, isGlobal); }
 	static ParserFunction* getFunction(const string& name, bool& isGlobal);
 
+	static ParserFunction* getArrayFunction(const string& item, ParsingScript& script);
+	static Variable getArrayElement(const string& item, ParsingScript& script);
+	static void setArrayElement(const string& item, const Variable& value, ParsingScript& script);
+
 	static ActionFunction* getRegisteredAction(const string& name, string& action);
 	static ActionFunction* getAction(const string& action);
 
@@ -49,6 +58,26 @@ public:
 
 	static void addGlobalVariable(const string& name, ParserFunction* variable);
 
+	//writes to a variable bound by the host, returns false if there is no such variable
+	static bool assignHostVariable(const string& name, const Variable& value);
+
+	//assigns a value to an existing variable in place, creates the variable only if needed
+	static void assignVariable(const string& name, const Variable& value);
+
+	//global variables are per thread, pfor workers start with a copy of the values of the calling thread
+	static unordered_map<string, Variable> getGlobalValues();
+	static void setGlobalValues(const unordered_map<string, Variable>& values);
+	static void clearGlobals();
+
+	//exchanges the variables of the running thread, used to switch between script tasks and forks
+	static void swapGlobals(Environment& globals) { m_globals.swap(globals); }
+
+	//a copy-on-write copy of the variables of the running thread
+	static Environment forkGlobals() { return m_globals.fork(); }
+
+	//the map or array that changing value has to change, a copy if value is shared with a fork
+	static Variable writable(const Variable& value) { return m_globals.writable(value); }
+
 	template<class T, class S>
 	static void add(T& container, S& value, const string& key, bool isNative = true);
 
@@ -61,16 +90,18 @@ protected:
 	string m_name;
 	bool m_isGlobal = true;
 	bool m_isNative = true;
+	const char* m_traceCategory = nullptr;
 
 private:
 	ParserFunction* m_implementation;
 	bool m_newInstance;
 
 	static unordered_map<string, ParserFunction*> m_functions;
-	static unordered_map<string, ParserFunction*> m_globals;
+	static thread_local Environment m_globals;
 	static unordered_map<string, ActionFunction*> m_actions;
+	static bool m_hostVariables; //bindVariable() was called, until then assignments don't look for a HostVariable
 
-	static StringOrNumericFunction* m_strOrNumericFunction;
+	static thread_local StringOrNumericFunction* m_strOrNumericFunction;
 	static IdentityFunction*		m_idFunction;
 };
 
@@ -6,6 +6,8 @@
 #include "ScriptHelper.h"
 #include "Variable.h"
 
+const unordered_map<size_t, size_t> ParsingScript::m_noLines;
+
 template<class K, class V>
 vector<K> ParsingScript::getKeys(const unordered_map<K, V>& map) 
 {
@@ -30,7 +32,7 @@ string ParsingScript::getRawLine(size_t& lineNumber) const
 		return "";
 	}
 
-	vector<string> lines = ScriptHelper::tokenize(m_rawScript);
+	vector<string> lines = ScriptHelper::tokenize(getRawScript());
 
 	if (lineNumber < lines.size()) 
 	{
@@ -42,7 +44,7 @@ string ParsingScript::getRawLine(size_t& lineNumber) const
 
 size_t ParsingScript::getRawLineNumber() const 
 {
-	unordered_map<size_t, size_t>& char2Line = getChar2Line();
+	const unordered_map<size_t, size_t>& char2Line = getChar2Line();
 
 	if (char2Line.empty()) 
 	{
@@ -57,14 +59,14 @@ size_t ParsingScript::getRawLineNumber() const
 
 	if (position <= lineStart[lower]) 
 	{
-		return char2Line[lineStart[lower]];
+		return char2Line.at(lineStart[lower]);
 	}
 	
 	size_t upper = lineStart.size() - 1;
 
 	if (position >= lineStart[upper]) 
 	{
-		return char2Line[lineStart[upper]];
+		return char2Line.at(lineStart[upper]);
 	}
 
 	while (lower <= upper) 
@@ -90,18 +92,21 @@ size_t ParsingScript::getRawLineNumber() const
 		}
 	}
 
-	return char2Line[lineStart[index]];
+	return char2Line.at(lineStart[index]);
 }
 
 Variable ParsingScript::execute(const string& to) 
 {
-	if (m_data.empty()) 
+	if (m_size == 0) 
 	{
 		return Variable::emptyInstance;
 	}
-	if (m_data[m_data.size() - 1] != Tokens::END_STATEMENT) 
+	if (m_chars[m_size - 1] != Tokens::END_STATEMENT) 
 	{
-		m_data += Tokens::END_STATEMENT;
+		//the text may be shared with other copies of the script
+		m_data = make_shared<string>(*m_data + Tokens::END_STATEMENT);
+		m_chars = m_data->c_str();
+		m_size = m_data->size();
 	}
 	Variable result = Parser::loadAndCalculate(*this, to);
 	return result;
@@ -124,4 +129,26 @@ Variable ParsingScript::executeAll(const string& to)
 	}
 
 	return result;
-}
\ No newline at end of file
+}
+void LineIndex::load(const ParsingScript& script)
+{
+	m_lineEnds = ParsingScript::getKeys(script.getChar2Line());
+	m_lines.clear();
+
+	for (size_t end : m_lineEnds)
+	{
+		m_lines.push_back(script.getChar2Line().at(end));
+	}
+}
+
+size_t LineIndex::getLine(size_t offset) const
+{
+	if (m_lineEnds.empty())
+	{
+		return string::npos;
+	}
+
+	//the first line that ends at or after the offset
+	size_t index = lower_bound(m_lineEnds.begin(), m_lineEnds.end(), offset) - m_lineEnds.begin();
+	return m_lines[min(index, m_lineEnds.size() - 1)];
+}
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "RuntimeStats.h"
 #include "Tokens.h"
 #include "Variable.h"
 
@@ -9,59 +10,70 @@
 class ParsingScript
 {
 public:
-	ParsingScript(const string& data, size_t from = 0) : m_data(data), m_currentPosition(from) {}
-
-	ParsingScript(const ParsingScript& other) :
-		m_data(other.m_data),
-		m_currentPosition(other.m_currentPosition),
-		m_filename(other.m_filename),
-		m_rawScript(other.m_rawScript),
-		m_scriptOffset(other.m_scriptOffset),
-		m_char2Line(other.getChar2Line())
+	ParsingScript(const string& data, size_t from = 0) : 
+		m_data(make_shared<string>(data)), 
+		m_chars(m_data->c_str()), 
+		m_size(m_data->size()), 
+		m_currentPosition(from) 
 	{
+	}
 
+	//shares the text, the raw script and the char2Line table of the other script, e.g. for a task or a look ahead
+	ParsingScript(const ParsingScript& other, size_t from) : ParsingScript(other)
+	{
+		m_currentPosition = from;
 	}
 
-	inline size_t size() const			 { return m_data.size(); }
-	inline bool hasNext() const			 { return m_currentPosition < m_data.size(); }
+	ParsingScript(const ParsingScript& other) = default;
+	ParsingScript& operator=(const ParsingScript& other) = default;
+
+	inline size_t size() const			 { return m_size; }
+	inline bool hasNext() const			 { return m_currentPosition < m_size; }
 	inline size_t getPointer() const	 { return m_currentPosition; }
-	inline const string& getData() const { return m_data; }
+	inline const string& getData() const { return *m_data; }
 
-	inline size_t find(char ch, size_t fromDelta = 0) const { return m_data.find(ch, fromDelta); }
+	inline size_t find(char ch, size_t fromDelta = 0) const { return m_data->find(ch, fromDelta); }
 
 	inline size_t find_first_of(const string& str, size_t fromDelta = 0) const
 	{
-		return m_data.find_first_of(str, fromDelta);
+		return m_data->find_first_of(str, fromDelta);
 	}
 
 	inline string substr(size_t from, size_t len = string::npos) const
 	{
-		return m_data.substr(from, len);
+		string result = m_data->substr(from, len);
+		RuntimeStats::local().stringBytes += result.size();
+		return result;
 	}
 
-	inline char operator()(size_t i) const	{ return m_data[i]; }
+	inline char operator()(size_t i) const	{ return m_chars[i]; }
 
-	inline char currentChar() const			{ return m_data[m_currentPosition]; }
-	inline char currentCharAndIncreasePointer()		{ return m_data[m_currentPosition++]; }
+	inline char currentChar() const			{ return m_chars[m_currentPosition]; }
+	inline char currentCharAndIncreasePointer()		{ return m_chars[m_currentPosition++]; }
 
-	inline char tryCurrentChar() const		{ return m_currentPosition < m_data.size() ? m_data[m_currentPosition] : Tokens::NULL_CHAR; }
-	inline char tryNextChar() const			{ return m_currentPosition + 1 < m_data.size() ? m_data[m_currentPosition + 1] : Tokens::NULL_CHAR; }
-	inline char tryPreviousChar() const		{ return m_currentPosition >= 1 ? m_data[m_currentPosition - 1] : Tokens::NULL_CHAR; }
-	inline char tryPrePreviousChar() const	{ return m_currentPosition >= 2 ? m_data[m_currentPosition - 2] : Tokens::NULL_CHAR; }
+	inline char tryCurrentChar() const		{ return m_currentPosition < m_size ? m_chars[m_currentPosition] : Tokens::NULL_CHAR; }
+	inline char tryNextChar() const			{ return m_currentPosition + 1 < m_size ? m_chars[m_currentPosition + 1] : Tokens::NULL_CHAR; }
+	inline char tryPreviousChar() const		{ return m_currentPosition >= 1 ? m_chars[m_currentPosition - 1] : Tokens::NULL_CHAR; }
+	inline char tryPrePreviousChar() const	{ return m_currentPosition >= 2 ? m_chars[m_currentPosition - 2] : Tokens::NULL_CHAR; }
 
-	inline string remainingScript(size_t maxChars = Tokens::MAX_CHARS_TO_SHOW) const { return m_currentPosition < m_data.size() ? m_data.substr(m_currentPosition, maxChars) : ""; }
+	inline string remainingScript(size_t maxChars = Tokens::MAX_CHARS_TO_SHOW) const
+	{
+		string result = m_currentPosition < m_size ? m_data->substr(m_currentPosition, maxChars) : "";
+		RuntimeStats::local().stringBytes += result.size();
+		return result;
+	}
 
-	inline void setChar2Line(const unordered_map<size_t, size_t>& char2Line) { m_char2Line = char2Line; }
+	inline void setChar2Line(const unordered_map<size_t, size_t>& char2Line) { m_char2Line = make_shared<const unordered_map<size_t, size_t>>(char2Line); }
 
-	inline unordered_map<size_t, size_t>& getChar2Line() const { return m_char2Line; }
+	inline const unordered_map<size_t, size_t>& getChar2Line() const { return m_char2Line ? *m_char2Line : m_noLines; }
 
 	inline void setOffset(size_t offset) { m_scriptOffset = offset; }
 
 	inline void setFilename(const string& filename) { m_filename = filename; }
 	inline const string& getFilename() const		{ return m_filename; }
 
-	inline void setRawScript(const string& script) { m_rawScript = script; }
-	inline const string& getRawScript() { return m_rawScript; }
+	inline void setRawScript(const string& script) { m_rawScript = make_shared<const string>(script); }
+	inline const string& getRawScript() const { return m_rawScript ? *m_rawScript : Tokens::EMPTY; }
 
 	inline void setPointer(size_t ptr)  { m_currentPosition = ptr; }
 	inline void increasePointer(size_t to = 1)  { m_currentPosition += to; }
@@ -78,13 +90,35 @@ public:
 	static vector<K> getKeys(const unordered_map<K, V>& map);
 
 private:
-	string m_data; //contains the complete script as string
+	shared_ptr<string> m_data; //contains the complete script as string, shared by the copies of the script
+	const char*		   m_chars;	//m_data->c_str(), read for every character
+	size_t			   m_size;
 	size_t m_currentPosition; //pointer to the script
 
 	string m_filename; //filename that contains the script
-	string m_rawScript; // original raw script
+	shared_ptr<const string> m_rawScript; // original raw script
 	size_t m_scriptOffset = 0; // used in functiond defined in bigger scripts
-	mutable unordered_map<size_t, size_t> m_char2Line;
-	mutable unordered_map<size_t, size_t>* m_char2LinePtr = nullptr;
+	shared_ptr<const unordered_map<size_t, size_t>> m_char2Line;
+
+	static const unordered_map<size_t, size_t> m_noLines;
+};
+
+/*
+*  Sorted copy of the char2Line table of a script for looking up the
+*  source lines of many offsets, e.g. by the profiler.
+*/
+class LineIndex
+{
+public:
+	void load(const ParsingScript& script);
+
+	bool empty() const { return m_lineEnds.empty(); }
+
+	//same result as ParsingScript::getRawLineNumber(), string::npos if there is no line table
+	size_t getLine(size_t offset) const;
+
+private:
+	vector<size_t> m_lineEnds; //last character of every line
+	vector<size_t> m_lines;
 };
 
@@ -0,0 +1,319 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include "Profiler.h"
+#include "ScriptHelper.h"
+#include "ThreadPool.h"
+
+const size_t Profiler::MAX_SAMPLE_DEPTH;
+
+atomic<bool> Profiler::m_enabled(false);
+atomic<bool> Profiler::m_sampling(false);
+atomic<bool> Profiler::m_active(false);
+bool Profiler::m_started = false;
+
+string Profiler::m_rawScript;
+LineIndex Profiler::m_lineIndex;
+
+mutex Profiler::m_mutex;
+vector<unique_ptr<Profiler::LineTable>> Profiler::m_tables;
+vector<unique_ptr<Profiler::SampleStack>> Profiler::m_stacks;
+
+thread Profiler::m_watchdog;
+condition_variable Profiler::m_stopped;
+bool Profiler::m_stop = false;
+map<vector<size_t>, size_t> Profiler::m_samples;
+
+thread_local bool Profiler::m_paused = false;
+thread_local Profiler::LineTable* Profiler::m_table = nullptr;
+thread_local Profiler::SampleStack* Profiler::m_stack = nullptr;
+thread_local vector<ProfileFrame> Profiler::m_frames;
+
+bool Profiler::start(const ParsingScript& script)
+{
+	if (!m_active)
+	{
+		return false;
+	}
+
+	//the first script on any thread is the one that gets profiled
+	lock_guard<mutex> lock(m_mutex);
+	if (m_started)
+	{
+		return script.getRawScript() == m_rawScript;
+	}
+
+	m_started = true;
+	m_rawScript = script.getRawScript();
+
+	m_lineIndex.load(script);
+
+	return true;
+}
+
+Profiler::LineTable& Profiler::getTable()
+{
+	if (m_table == nullptr)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_tables.emplace_back(new LineTable());
+		m_table = m_tables.back().get();
+	}
+
+	return *m_table;
+}
+
+Profiler::SampleStack& Profiler::getStack()
+{
+	if (m_stack == nullptr)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stacks.emplace_back(new SampleStack());
+		m_stack = m_stacks.back().get();
+		m_stack->worker = ThreadPool::isWorker();
+		m_stack->depth.store(0, memory_order_relaxed);
+	}
+
+	return *m_stack;
+}
+
+void Profiler::push(size_t offset)
+{
+	if (m_sampling)
+	{
+		SampleStack& stack = getStack();
+		size_t depth = stack.depth.load(memory_order_relaxed);
+		if (depth < MAX_SAMPLE_DEPTH)
+		{
+			stack.offsets[depth].store(offset, memory_order_relaxed);
+		}
+		stack.depth.store(depth + 1, memory_order_release);
+	}
+
+	if (!m_enabled || m_lineIndex.empty())
+	{
+		return;
+	}
+
+	ProfileFrame frame;
+	frame.line = m_lineIndex.getLine(offset);
+	frame.start = chrono::steady_clock::now();
+	frame.children = chrono::steady_clock::duration::zero();
+
+	m_frames.push_back(frame);
+}
+
+void Profiler::pop()
+{
+	if (m_sampling)
+	{
+		SampleStack& stack = getStack();
+		size_t depth = stack.depth.load(memory_order_relaxed);
+		if (depth > 0)
+		{
+			stack.depth.store(depth - 1, memory_order_release);
+		}
+	}
+
+	if (!m_enabled || m_frames.empty())
+	{
+		return;
+	}
+
+	ProfileFrame frame = m_frames.back();
+	m_frames.pop_back();
+
+	chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - frame.start;
+
+	LineRecord& record = getTable()[frame.line];
+	record.hits++;
+	record.exclusive += elapsed - frame.children;
+
+	//a statement nested on the same line is already part of the inclusive time of its parent
+	bool nested = false;
+	for (const ProfileFrame& parent : m_frames)
+	{
+		nested = nested || parent.line == frame.line;
+	}
+	if (!nested)
+	{
+		record.inclusive += elapsed;
+	}
+
+	if (!m_frames.empty())
+	{
+		m_frames.back().children += elapsed;
+	}
+}
+
+void Profiler::swapState(ProfileState& state)
+{
+	m_frames.swap(state.frames);
+
+	if (!m_sampling)
+	{
+		return;
+	}
+
+	SampleStack& stack = getStack();
+	size_t depth = stack.depth.load(memory_order_relaxed);
+	vector<size_t> offsets(min(depth, MAX_SAMPLE_DEPTH));
+
+	for (size_t i = 0; i < offsets.size(); i++)
+	{
+		offsets[i] = stack.offsets[i].load(memory_order_relaxed);
+	}
+	for (size_t i = 0; i < state.samples.size(); i++)
+	{
+		stack.offsets[i].store(state.samples[i], memory_order_relaxed);
+	}
+
+	stack.depth.store(state.sampleDepth, memory_order_release);
+	state.samples.swap(offsets);
+	state.sampleDepth = depth;
+}
+
+void Profiler::report(ostream& out)
+{
+	LineTable total;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (const unique_ptr<LineTable>& table : m_tables)
+		{
+			for (const auto& entry : *table)
+			{
+				LineRecord& record = total[entry.first];
+				record.hits += entry.second.hits;
+				record.inclusive += entry.second.inclusive;
+				record.exclusive += entry.second.exclusive;
+			}
+		}
+	}
+
+	vector<pair<size_t, LineRecord>> lines(total.begin(), total.end());
+	sort(lines.begin(), lines.end(), [](const pair<size_t, LineRecord>& a, const pair<size_t, LineRecord>& b)
+	{
+		return a.second.exclusive != b.second.exclusive ? a.second.exclusive > b.second.exclusive : a.first < b.first;
+	});
+
+	vector<string> source = ScriptHelper::tokenize(m_rawScript);
+
+	out << endl << "-- Profile --" << endl;
+	out << setw(6) << "Line" << setw(12) << "Hits" << setw(12) << "Incl ms" << setw(12) << "Excl ms" << "  Source" << endl;
+	out << fixed << setprecision(3);
+
+	for (const auto& entry : lines)
+	{
+		string text = entry.first < source.size() ? ScriptHelper::trim(source[entry.first]) : Tokens::EMPTY;
+
+		out << setw(6) << entry.first + 1
+			<< setw(12) << entry.second.hits
+			<< setw(12) << chrono::duration<double, milli>(entry.second.inclusive).count()
+			<< setw(12) << chrono::duration<double, milli>(entry.second.exclusive).count()
+			<< "  " << text << endl;
+	}
+
+	out.unsetf(ios::fixed);
+}
+
+void Profiler::startSampling(size_t intervalMs)
+{
+	if (m_sampling)
+	{
+		return;
+	}
+
+	m_sampling = true;
+	m_active = true;
+	m_stop = false;
+
+	m_watchdog = thread([intervalMs]()
+	{
+		unique_lock<mutex> lock(m_mutex);
+		while (!m_stopped.wait_for(lock, chrono::milliseconds(max(intervalMs, (size_t)1)), []() { return m_stop; }))
+		{
+			sample();
+		}
+	});
+}
+
+void Profiler::sample()
+{
+	for (const unique_ptr<SampleStack>& stack : m_stacks)
+	{
+		size_t depth = stack->depth.load(memory_order_acquire);
+		if (depth == 0)
+		{
+			continue;
+		}
+
+		//the thread keeps running, so this is a stack it had at about this time
+		vector<size_t> key(1, stack->worker ? 1 : 0);
+		for (size_t i = 0; i < min(depth, MAX_SAMPLE_DEPTH); i++)
+		{
+			key.push_back(stack->offsets[i].load(memory_order_relaxed));
+		}
+
+		m_samples[key]++;
+	}
+}
+
+void Profiler::stopSampling(ostream& out)
+{
+	if (!m_sampling)
+	{
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_stopped.notify_all();
+	m_watchdog.join();
+
+	m_sampling = false;
+	m_active = m_enabled.load();
+
+	vector<string> source = ScriptHelper::tokenize(m_rawScript);
+	map<string, size_t> stacks;
+
+	for (const auto& entry : m_samples)
+	{
+		const vector<size_t>& key = entry.first;
+		string stack = key[0] ? "worker" : "main";
+		size_t previous = string::npos;
+
+		for (size_t i = 1; i < key.size(); i++)
+		{
+			//statements nested on the same line are a single frame
+			size_t line = m_lineIndex.getLine(key[i]);
+			if (line == previous || line == string::npos)
+			{
+				continue;
+			}
+			previous = line;
+
+			string text = line < source.size() ? ScriptHelper::trim(source[line]) : Tokens::EMPTY;
+			while (!text.empty() && text.back() == Tokens::END_STATEMENT)
+			{
+				text.pop_back();
+			}
+			replace(text.begin(), text.end(), char(Tokens::END_STATEMENT), ',');
+
+			stack += ";" + to_string(line + 1) + ": " + text;
+		}
+
+		stacks[stack] += entry.second;
+	}
+
+	for (const auto& entry : stacks)
+	{
+		out << entry.first << " " << entry.second << endl;
+	}
+
+	m_samples.clear();
+}
@@ -0,0 +1,134 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ParsingScript.h"
+
+//a statement that is being executed
+struct ProfileFrame
+{
+	size_t line;
+	chrono::steady_clock::time_point start;
+	chrono::steady_clock::duration children;
+};
+
+//statements in progress of a script task while it is suspended
+struct ProfileState
+{
+	vector<ProfileFrame> frames;
+	vector<size_t>		 samples;
+	size_t				 sampleDepth = 0;
+};
+
+/*
+*  Line profiler of --profile. Every statement that runs gets its time
+*  counted for its source line, which is found through the char2Line table
+*  of the script. Inclusive time contains the statements nested in a block,
+*  exclusive time only what the line did itself.
+*  The sampling mode of --sample only keeps the offsets of the statements
+*  in progress (a loop, the if inside of it, the current statement, ...)
+*  in a fixed array per thread. A watchdog thread looks at these arrays
+*  periodically and counts the stacks it sees, they are written as
+*  collapsed stacks for flamegraph tools once sampling stops.
+*  Only the first script that gets evaluated is profiled. Every thread
+*  records into its own table, they are merged for the report.
+*/
+class Profiler
+{
+public:
+	static const size_t MAX_SAMPLE_DEPTH = 128;
+
+	static void setEnabled(bool enabled) { m_enabled = enabled; m_active = m_enabled || m_sampling; }
+	static bool isEnabled() { return m_enabled; }
+
+	//called before the statements of a script run, returns false if the script isn't profiled
+	static bool start(const ParsingScript& script);
+
+	//statements of another script are not recorded on this thread
+	static void pause(bool paused) { m_paused = paused; }
+	static bool isPaused() { return m_paused; }
+
+	static inline void enter(size_t offset)
+	{
+		if (m_active.load(memory_order_relaxed) && !m_paused)
+		{
+			push(offset);
+		}
+	}
+
+	static inline void leave()
+	{
+		if (m_active.load(memory_order_relaxed) && !m_paused)
+		{
+			pop();
+		}
+	}
+
+	//every script task has its own statements in progress
+	static void swapState(ProfileState& state);
+
+	//prints the lines sorted by their exclusive time
+	static void report(ostream& out);
+
+	//starts the watchdog thread that takes a sample every intervalMs
+	static void startSampling(size_t intervalMs);
+
+	//stops the watchdog and writes the samples as "frame;frame;frame count" lines
+	static void stopSampling(ostream& out);
+
+private:
+	struct LineRecord
+	{
+		size_t hits = 0;
+		chrono::steady_clock::duration inclusive = chrono::steady_clock::duration::zero();
+		chrono::steady_clock::duration exclusive = chrono::steady_clock::duration::zero();
+	};
+
+	//written by its own thread only, the watchdog reads it while it changes
+	struct SampleStack
+	{
+		bool		   worker = false;
+		atomic<size_t> depth;
+		atomic<size_t> offsets[MAX_SAMPLE_DEPTH];
+	};
+
+	typedef unordered_map<size_t, LineRecord> LineTable;
+
+	static void push(size_t offset);
+	static void pop();
+	static LineTable& getTable();
+	static SampleStack& getStack();
+
+	static void sample();
+
+	//switched by the main thread while the workers of pfor or --serve read them
+	static atomic<bool> m_enabled;
+	static atomic<bool> m_sampling;
+	static atomic<bool> m_active; //either of the two
+	static bool m_started; //guarded by m_mutex
+
+	static string m_rawScript;
+	static LineIndex m_lineIndex;
+
+	static mutex m_mutex;
+	static vector<unique_ptr<LineTable>> m_tables;
+	static vector<unique_ptr<SampleStack>> m_stacks;
+
+	static thread m_watchdog;
+	static condition_variable m_stopped;
+	static bool m_stop;
+	static map<vector<size_t>, size_t> m_samples; //first entry tells if it was a worker thread
+
+	static thread_local bool m_paused;
+	static thread_local LineTable* m_table;
+	static thread_local SampleStack* m_stack;
+	static thread_local vector<ProfileFrame> m_frames;
+};
@@ -0,0 +1,146 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cstdlib>
+#include <cstring>
+
+#include "Collections.h"
+#include "RecordReader.h"
+
+bool RecordReader::next(const char*& line, size_t& length)
+{
+	size_t scanned = 0; //characters after m_start that are known to have no line end
+	while (true)
+	{
+		const char* begin = m_buffer.data() + m_start;
+		const char* newLine = (const char*)memchr(begin + scanned, '\n', m_end - m_start - scanned);
+		if (newLine != nullptr)
+		{
+			line = begin;
+			length = newLine - begin;
+			m_start += length + 1;
+			break;
+		}
+
+		scanned = m_end - m_start;
+		if (!fill())
+		{
+			if (m_start == m_end)
+			{
+				return false;
+			}
+			line = m_buffer.data() + m_start;
+			length = m_end - m_start;
+			m_start = m_end;
+			break;
+		}
+	}
+
+	if (length > 0 && line[length - 1] == '\r')
+	{
+		length--;
+	}
+	m_count++;
+	return true;
+}
+
+//moves the partial line to the front and reads the next block behind it
+bool RecordReader::fill()
+{
+	if (m_eof)
+	{
+		return false;
+	}
+
+	if (m_start > 0)
+	{
+		memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+		m_end -= m_start;
+		m_start = 0;
+	}
+	if (m_buffer.size() - m_end < BLOCK_SIZE / 2)
+	{
+		m_buffer.resize(m_buffer.size() * 2);
+	}
+
+	size_t read = fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+	if (read == 0)
+	{
+		m_eof = true;
+		return false;
+	}
+
+	m_end += read;
+	return true;
+}
+
+Variable RecordReader::split(const char* line, size_t length, char separator)
+{
+	shared_ptr<ScriptArray> fields = make_shared<ScriptArray>();
+	if (length == 0)
+	{
+		return Variable(Tokens::ARRAY, fields);
+	}
+
+	const char* end = line + length;
+	const char* current = line;
+
+	while (current <= end)
+	{
+		const char* fieldEnd;
+		if (separator == 0)
+		{
+			while (current < end && isspace((unsigned char)*current))
+			{
+				current++;
+			}
+			if (current == end)
+			{
+				break;
+			}
+			fieldEnd = current;
+			while (fieldEnd < end && !isspace((unsigned char)*fieldEnd))
+			{
+				fieldEnd++;
+			}
+		}
+		else
+		{
+			fieldEnd = (const char*)memchr(current, separator, end - current);
+			if (fieldEnd == nullptr)
+			{
+				fieldEnd = end;
+			}
+		}
+
+		fields->push(toField(current, fieldEnd - current));
+		current = fieldEnd + 1;
+	}
+
+	return Variable(Tokens::ARRAY, fields);
+}
+
+Variable RecordReader::toField(const char* data, size_t length)
+{
+	static const size_t MAX_NUMBER_LENGTH = 64;
+
+	//a field is a number only if all of it is, like "42" or "-1.5". After the sign there has to be
+	//a digit or a point, strtod() would also take "inf", "nan" or "infinity", which are names in records.
+	size_t digit = length > 0 && (data[0] == '-' || data[0] == '+') ? 1 : 0;
+	if (length == 0 || length >= MAX_NUMBER_LENGTH || digit >= length || !(isdigit((unsigned char)data[digit]) || data[digit] == '.'))
+	{
+		return Variable(string(data, length));
+	}
+
+	//the field isn't terminated, strtod() needs a copy
+	char number[MAX_NUMBER_LENGTH];
+	memcpy(number, data, length);
+	number[length] = '\0';
+
+	char* numberEnd = nullptr;
+	double value = strtod(number, &numberEnd);
+	if (numberEnd != number + length)
+	{
+		return Variable(string(data, length));
+	}
+	return Variable(value);
+}
@@ -0,0 +1,44 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "Variable.h"
+
+/*
+*  Reads the records of --each-line, one line at a time, from a file
+*  like stdin. The input is read in large blocks and next() only returns
+*  a pointer into the block, a line is never copied on its own. Lines
+*  that don't fit into the block make it grow. Both "\n" and "\r\n"
+*  end a line, the last line doesn't need an end.
+*/
+class RecordReader
+{
+public:
+	static const size_t BLOCK_SIZE = 1024 * 1024;
+
+	RecordReader(FILE* file) : m_file(file), m_buffer(BLOCK_SIZE) {}
+
+	//the line stays valid until the next call, returns false at the end of the input
+	bool next(const char*& line, size_t& length);
+
+	size_t getCount() const { return m_count; }
+
+	//splits a line into its fields, numbers become NUMERIC. A separator of 0 splits at whitespace like awk.
+	static Variable split(const char* line, size_t length, char separator);
+
+	//value of a field, NUMERIC if all of it is a number like "42" or "-1.5", STRING otherwise
+	static Variable toField(const char* data, size_t length);
+
+private:
+	bool fill();
+
+	FILE*		 m_file;
+	vector<char> m_buffer;
+	size_t		 m_start = 0; //first character that wasn't returned yet
+	size_t		 m_end = 0;	  //end of the data that was read
+	bool		 m_eof = false;
+	size_t		 m_count = 0;
+};
@@ -0,0 +1,87 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+#include "RuntimeStats.h"
+
+mutex RuntimeStats::m_mutex;
+vector<RuntimeCounters*> RuntimeStats::m_threads;
+RuntimeCounters RuntimeStats::m_retired = {};
+
+thread_local RuntimeCounters RuntimeStats::m_counters = {};
+
+//hands the counters of a thread over to m_retired when the thread exits
+struct RuntimeStatsRegistration
+{
+	RuntimeStatsRegistration()	{ lock_guard<mutex> lock(RuntimeStats::m_mutex); RuntimeStats::m_threads.push_back(&RuntimeStats::m_counters); }
+	~RuntimeStatsRegistration() { RuntimeStats::unregisterThread(); }
+};
+
+RuntimeCounters& RuntimeCounters::operator+=(const RuntimeCounters& other)
+{
+	statements += other.statements;
+	expressions += other.expressions;
+	tokens += other.tokens;
+	characters += other.characters;
+	nodes += other.nodes;
+	lookups += other.lookups;
+	lookupMisses += other.lookupMisses;
+	allocations += other.allocations;
+	allocatedBytes += other.allocatedBytes;
+	replacements += other.replacements;
+	stringBytes += other.stringBytes;
+	printedBytes += other.printedBytes;
+	return *this;
+}
+
+void RuntimeStats::registerThread()
+{
+	//constructed on the first call of every thread
+	static thread_local RuntimeStatsRegistration registration;
+}
+
+void RuntimeStats::unregisterThread()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_retired += m_counters;
+	m_threads.erase(remove(m_threads.begin(), m_threads.end(), &m_counters), m_threads.end());
+}
+
+RuntimeCounters RuntimeStats::total()
+{
+	//the other threads are expected to be idle, their counters are read without synchronization
+	lock_guard<mutex> lock(m_mutex);
+
+	RuntimeCounters total = m_retired;
+	for (RuntimeCounters* counters : m_threads)
+	{
+		total += *counters;
+	}
+	return total;
+}
+
+void RuntimeStats::report(ostream& out)
+{
+	RuntimeCounters counters = total();
+
+	auto line = [&out](const string& name, size_t value)
+	{
+		out << left << setw(26) << name << right << setw(16) << value << endl;
+	};
+
+	out << endl << "-- Statistics --" << endl;
+	line("Statements executed", counters.statements);
+	line("Expressions evaluated", counters.expressions);
+	line("Tokens parsed", counters.tokens);
+	line("Characters scanned", counters.characters);
+	line("Nodes evaluated", counters.nodes);
+	line("Variable lookups", counters.lookups);
+	line("Variable lookup misses", counters.lookupMisses);
+	line("Heap allocations", counters.allocations);
+	line("Heap bytes allocated", counters.allocatedBytes);
+	line("GetVarFunction replaced", counters.replacements);
+	line("String bytes copied", counters.stringBytes);
+	line("Bytes printed", counters.printedBytes);
+}
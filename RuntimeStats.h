@@ -0,0 +1,61 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+//counters of one thread, plain integers so that counting is a single increment
+struct RuntimeCounters
+{
+	size_t statements;
+	size_t expressions;	 //calls of Parser::loadAndCalculate()
+	size_t tokens;		 //items split from the script text by Parser::split()
+	size_t characters;	 //characters scanned by Parser::split()
+	size_t nodes;		 //operations merged by the parser and nodes of compiled expressions
+	size_t lookups;		 //variables and functions looked up by name
+	size_t lookupMisses;
+	size_t allocations;	 //calls of operator new, counted by the programs linked with AllocationCounter.cpp
+	size_t allocatedBytes;
+	size_t replacements; //variables that were replaced by a new GetVarFunction
+	size_t stringBytes;	 //bytes copied from the script text and from string variables
+	size_t printedBytes;
+
+	RuntimeCounters& operator+=(const RuntimeCounters& other);
+};
+
+/*
+*  Statistics of --stats. The counters are always compiled in and every
+*  thread counts into its own RuntimeCounters without any locking.
+*  A thread has to be registered once so that its counters are part of
+*  the total, the ones of finished threads are kept in m_retired.
+*  Apart from the bytes printed the counters are abstract work units that
+*  don't depend on the load of the machine, the same script gives the
+*  same counts in every run as long as it doesn't use threads.
+*/
+class RuntimeStats
+{
+public:
+	static RuntimeCounters& local() { return m_counters; }
+
+	//makes the counters of the calling thread part of the total, can be called any number of times
+	static void registerThread();
+
+	static RuntimeCounters total();
+
+	static void report(ostream& out);
+
+private:
+	friend struct RuntimeStatsRegistration;
+
+	static void unregisterThread();
+
+	static mutex m_mutex;
+	static vector<RuntimeCounters*> m_threads;
+	static RuntimeCounters m_retired;
+
+	static thread_local RuntimeCounters m_counters;
+};
@@ -0,0 +1,457 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <exception>
+#include <thread>
+
+#include "Scheduler.h"
+#include "Interpreter.h"
+#include "ParserFunction.h"
+#include "Profiler.h"
+#include "ScriptHelper.h"
+#include "Tracer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) && !defined(_WIN32)
+#include <sanitizer/asan_interface.h>
+#include <sanitizer/common_interface_defs.h>
+#define XES_SANITIZE_FIBERS
+#endif
+
+/*
+*  A task created by spawn(). It owns the fiber the block runs on and,
+*  while it is suspended, its global variables. It is deleted once it is
+*  done, after its result is handed to the handle.
+*/
+class ScriptTask
+{
+public:
+	enum State
+	{
+		READY,
+		SLEEPING,
+		WAITING,
+		DONE
+	};
+
+	ScriptTask(size_t id, const ParsingScript& script, size_t blockStart);
+	~ScriptTask() { release(); }
+
+	//from the event loop into the task and back
+	void switchTo();
+	void switchBack();
+
+	//frees the stack of a finished task
+	void release();
+
+	size_t	 m_id;
+	State	 m_state = READY;
+	Variable m_result;
+
+	weak_ptr<ScriptTaskHandle> m_handle; //gets the result, unless nobody holds the task anymore
+	ParsingScript			   m_script; //shares the text of the script it was spawned from
+	size_t		  m_blockStart;
+
+	unordered_map<string, Variable>		   m_captured; //variables of the creator at the time of spawn()
+	Environment							   m_globals;  //variables of the task while it's suspended
+	ProfileState						   m_profile;  //statements of the task in progress while it's suspended
+	size_t								   m_traceId = 0;
+
+	vector<ScriptTask*> m_waiters; //tasks blocked in await() on this one
+	exception_ptr m_error; //an error can't leave the fiber, the event loop throws it again
+
+private:
+	static void run();
+
+#ifdef _WIN32
+	static void CALLBACK entry(void*) { run(); }
+
+	void* m_fiber = nullptr;
+	static thread_local void* m_loopFiber;
+#else
+	static void entry() { run(); }
+
+	//AddressSanitizer checks the frames against the stack it thinks the code runs on, it is told about every switch
+	void startSwitch(const void* bottom, size_t size);
+	void finishSwitch();
+
+	ucontext_t m_context;
+	char*	   m_stack = nullptr; //starts with the guard page
+	size_t	   m_guardSize = 0;
+	void*	   m_fakeStack = nullptr; //of AddressSanitizer while the task is suspended
+	static thread_local ucontext_t m_loopContext;
+	static thread_local const void* m_loopStack;
+	static thread_local size_t		m_loopStackSize;
+	static thread_local void*		m_loopFakeStack;
+#endif
+};
+
+#ifdef _WIN32
+thread_local void* ScriptTask::m_loopFiber = nullptr;
+#else
+thread_local ucontext_t ScriptTask::m_loopContext;
+thread_local const void* ScriptTask::m_loopStack = nullptr;
+thread_local size_t ScriptTask::m_loopStackSize = 0;
+thread_local void* ScriptTask::m_loopFakeStack = nullptr;
+#endif
+
+thread_local deque<ScriptTask*> Scheduler::m_ready;
+thread_local multimap<chrono::steady_clock::time_point, ScriptTask*> Scheduler::m_sleeping;
+thread_local unordered_map<size_t, ScriptTask*> Scheduler::m_tasks;
+thread_local ScriptTask* Scheduler::m_current = nullptr;
+thread_local size_t Scheduler::m_nextId = 0;
+
+ScriptTask::ScriptTask(size_t id, const ParsingScript& script, size_t blockStart) :
+	m_id(id), m_script(script), m_blockStart(blockStart), m_captured(ParserFunction::getGlobalValues())
+{
+#ifdef _WIN32
+	//the reserved stack of a fiber ends with a guard page already
+	m_fiber = CreateFiberEx(Scheduler::STACK_COMMIT, Scheduler::STACK_SIZE, 0, entry, nullptr);
+	if (m_fiber == nullptr)
+	{
+		throw ParsingException("Runtime Error: Could not create a fiber for task " + to_string(id));
+	}
+#else
+	//the stack grows down, a task that runs out of it hits the guard page instead of the memory below
+	m_guardSize = (size_t)sysconf(_SC_PAGESIZE);
+	void* stack = mmap(nullptr, m_guardSize + Scheduler::STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (stack == MAP_FAILED)
+	{
+		throw ParsingException("Runtime Error: Could not create a stack for task " + to_string(id));
+	}
+	m_stack = (char*)stack;
+	mprotect(m_stack, m_guardSize, PROT_NONE);
+
+	getcontext(&m_context);
+	m_context.uc_stack.ss_sp = m_stack + m_guardSize;
+	m_context.uc_stack.ss_size = Scheduler::STACK_SIZE;
+	m_context.uc_link = nullptr;
+	makecontext(&m_context, entry, 0);
+#endif
+}
+
+void ScriptTask::switchTo()
+{
+#ifdef _WIN32
+	if (m_loopFiber == nullptr)
+	{
+		m_loopFiber = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+	}
+	SwitchToFiber(m_fiber);
+#else
+#ifdef XES_SANITIZE_FIBERS
+	__sanitizer_start_switch_fiber(&m_loopFakeStack, m_stack + m_guardSize, Scheduler::STACK_SIZE);
+#endif
+	swapcontext(&m_loopContext, &m_context);
+#ifdef XES_SANITIZE_FIBERS
+	__sanitizer_finish_switch_fiber(m_loopFakeStack, nullptr, nullptr);
+#endif
+#endif
+}
+
+void ScriptTask::switchBack()
+{
+#ifdef _WIN32
+	SwitchToFiber(m_loopFiber);
+#else
+	startSwitch(m_loopStack, m_loopStackSize);
+	swapcontext(&m_context, &m_loopContext);
+	finishSwitch();
+#endif
+}
+
+#ifndef _WIN32
+void ScriptTask::startSwitch(const void* bottom, size_t size)
+{
+#ifdef XES_SANITIZE_FIBERS
+	//the fake stack of a finished task is released
+	__sanitizer_start_switch_fiber(m_state == DONE ? nullptr : &m_fakeStack, bottom, size);
+#else
+	(void)bottom;
+	(void)size;
+#endif
+}
+
+void ScriptTask::finishSwitch()
+{
+#ifdef XES_SANITIZE_FIBERS
+	__sanitizer_finish_switch_fiber(m_fakeStack, &m_loopStack, &m_loopStackSize);
+#endif
+}
+#endif
+
+void ScriptTask::release()
+{
+#ifdef _WIN32
+	if (m_fiber != nullptr)
+	{
+		DeleteFiber(m_fiber);
+		m_fiber = nullptr;
+	}
+#else
+	if (m_stack != nullptr)
+	{
+#ifdef XES_SANITIZE_FIBERS
+		//the next stack may get the same addresses, they must not look like the frames of this one
+		__asan_unpoison_memory_region(m_stack + m_guardSize, Scheduler::STACK_SIZE);
+#endif
+		munmap(m_stack, m_guardSize + Scheduler::STACK_SIZE);
+		m_stack = nullptr;
+	}
+#endif
+}
+
+void ScriptTask::run()
+{
+	ScriptTask* task = Scheduler::m_current;
+#ifndef _WIN32
+	task->finishSwitch();
+#endif
+
+	try
+	{
+		ParserFunction::setGlobalValues(task->m_captured);
+		task->m_captured.clear();
+
+		task->m_script.setPointer(task->m_blockStart);
+		Variable result = Interpreter::evaluateBlock(task->m_script);
+
+		if (result.m_type != Tokens::BREAK_STATEMENT && result.m_type != Tokens::CONTINUE_STATEMENT)
+		{
+			task->m_result = result;
+		}
+	}
+	catch (...)
+	{
+		task->m_error = current_exception();
+	}
+
+	ParserFunction::clearGlobals();
+	task->m_state = DONE;
+
+	//a finished task is never resumed again
+	task->switchBack();
+}
+
+Variable Scheduler::spawn(const ParsingScript& script, size_t blockStart)
+{
+	size_t id = ++m_nextId;
+	ScriptTask* task = new ScriptTask(id, script, blockStart);
+	shared_ptr<ScriptTaskHandle> handle = make_shared<ScriptTaskHandle>(id);
+	task->m_handle = handle;
+
+	m_tasks[id] = task;
+	m_ready.push_back(task);
+
+	return Variable(Tokens::TASK, handle);
+}
+
+void Scheduler::yield()
+{
+	if (!inTask())
+	{
+		wakeSleepers();
+		runReady();
+		return;
+	}
+
+	m_ready.push_back(m_current);
+	suspend();
+}
+
+void Scheduler::sleep(size_t ms)
+{
+	chrono::steady_clock::time_point wakeUp = chrono::steady_clock::now() + chrono::milliseconds(ms);
+
+	if (!inTask())
+	{
+		runUntil([] { return false; }, &wakeUp);
+		return;
+	}
+
+	m_current->m_state = ScriptTask::SLEEPING;
+	m_sleeping.insert({ wakeUp, m_current });
+	suspend();
+}
+
+Variable Scheduler::await(const Variable& task)
+{
+	if (task.m_type != Tokens::TASK)
+	{
+		throw ParsingException("Syntax Error: await() expects a task created by spawn() but got [" + task.toString() + "]");
+	}
+
+	//the handle outlives the task, the task is deleted when it's done
+	shared_ptr<ScriptTaskHandle> handle = static_pointer_cast<ScriptTaskHandle>(task.m_object);
+	if (handle->isDone())
+	{
+		return handle->getResult();
+	}
+
+	auto it = m_tasks.find(handle->id());
+	if (it == m_tasks.end())
+	{
+		throw ParsingException("Runtime Error: " + task.toString() + " was created on another thread");
+	}
+
+	ScriptTask* target = it->second;
+	if (!inTask())
+	{
+		runUntil([&handle] { return handle->isDone(); });
+		return handle->getResult();
+	}
+
+	if (target == m_current)
+	{
+		throw ParsingException("Runtime Error: " + task.toString() + " can't await itself");
+	}
+
+	m_current->m_state = ScriptTask::WAITING;
+	target->m_waiters.push_back(m_current);
+	suspend();
+
+	return handle->getResult();
+}
+
+void Scheduler::runAll()
+{
+	runUntil([] { return m_tasks.empty(); });
+}
+
+void Scheduler::resume(ScriptTask* task)
+{
+	//the task gets its own variables while it runs, the ones of the main script are kept aside
+	m_current = task;
+	ParserFunction::swapGlobals(task->m_globals);
+	Profiler::swapState(task->m_profile);
+	Tracer::swapThread(task->m_traceId);
+
+	task->switchTo();
+
+	Tracer::swapThread(task->m_traceId);
+	Profiler::swapState(task->m_profile);
+	ParserFunction::swapGlobals(task->m_globals);
+	m_current = nullptr;
+
+	if (task->m_state != ScriptTask::DONE)
+	{
+		return;
+	}
+
+	exception_ptr error = task->m_error;
+	finish(task);
+
+	if (error)
+	{
+		rethrow_exception(error);
+	}
+}
+
+void Scheduler::reset()
+{
+	for (auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
+	{
+		delete it->second;
+	}
+	m_tasks.clear();
+	m_ready.clear();
+	m_sleeping.clear();
+}
+
+void Scheduler::suspend()
+{
+	m_current->switchBack();
+}
+
+void Scheduler::finish(ScriptTask* task)
+{
+	shared_ptr<ScriptTaskHandle> handle = task->m_handle.lock();
+	if (handle)
+	{
+		handle->setResult(task->m_result);
+	}
+
+	for (size_t i = 0; i < task->m_waiters.size(); i++)
+	{
+		task->m_waiters[i]->m_state = ScriptTask::READY;
+		m_ready.push_back(task->m_waiters[i]);
+	}
+
+	m_tasks.erase(task->m_id);
+	delete task;
+}
+
+bool Scheduler::runReady()
+{
+	if (m_ready.empty())
+	{
+		return false;
+	}
+
+	//tasks that yield in this pass are queued again and run in the next one
+	size_t count = m_ready.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		ScriptTask* task = m_ready.front();
+		m_ready.pop_front();
+
+		task->m_state = ScriptTask::READY;
+		resume(task);
+	}
+
+	return true;
+}
+
+void Scheduler::wakeSleepers()
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	while (!m_sleeping.empty() && m_sleeping.begin()->first <= now)
+	{
+		m_ready.push_back(m_sleeping.begin()->second);
+		m_sleeping.erase(m_sleeping.begin());
+	}
+}
+
+template<class Condition>
+void Scheduler::runUntil(Condition done, const chrono::steady_clock::time_point* deadline)
+{
+	while (!done())
+	{
+		if (deadline != nullptr && chrono::steady_clock::now() >= *deadline)
+		{
+			return;
+		}
+
+		wakeSleepers();
+		if (runReady())
+		{
+			continue;
+		}
+
+		//nothing is ready, wait for the next task to wake up
+		ScriptHelper::flushOutput();
+		if (m_sleeping.empty())
+		{
+			if (deadline != nullptr)
+			{
+				this_thread::sleep_until(*deadline);
+				return;
+			}
+			throw ParsingException("Runtime Error: All remaining tasks are waiting for each other");
+		}
+
+		chrono::steady_clock::time_point wakeUp = m_sleeping.begin()->first;
+		if (deadline != nullptr && *deadline < wakeUp)
+		{
+			wakeUp = *deadline;
+		}
+		this_thread::sleep_until(wakeUp);
+	}
+}
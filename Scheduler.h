@@ -0,0 +1,91 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+
+#include "Collections.h"
+#include "ParsingScript.h"
+
+class ScriptTask;
+
+/*
+*  Value returned by spawn(), identifies the task for await(). The task
+*  itself is deleted once it is done, its result stays here.
+*/
+class ScriptTaskHandle : public ScriptObject
+{
+public:
+	ScriptTaskHandle(size_t id) : m_id(id) {}
+
+	size_t id() const { return m_id; }
+
+	bool isDone() const { return m_done; }
+	const Variable& getResult() const { return m_result; }
+	void setResult(const Variable& result) { m_result = result; m_done = true; }
+
+	virtual string toString() const { return "task " + to_string(m_id); }
+
+private:
+	size_t	 m_id;
+	bool	 m_done = false;
+	Variable m_result;
+};
+
+/*
+*  Cooperative event loop of the script tasks created by spawn().
+*  Every task runs the interpreter on its own fiber stack, so it can be
+*  suspended anywhere by yield(), sleep() or await() and resumed later.
+*  A task starts with a copy of the variables of its creator, collections
+*  are shared. The loop only runs while the main script waits for it
+*  (yield, sleep, await) and once the main script is done.
+*  Each thread has its own loop, the tasks never move between threads.
+*/
+class Scheduler
+{
+public:
+	//like the stack of the main thread, the pages are only committed once the task uses them
+	static const size_t STACK_SIZE = 8 * 1024 * 1024;
+	static const size_t STACK_COMMIT = 64 * 1024; //committed up front on Windows
+
+	//creates a task that runs the block starting at blockStart
+	static Variable spawn(const ParsingScript& script, size_t blockStart);
+
+	static void yield();
+	static void sleep(size_t ms);
+	static Variable await(const Variable& task);
+
+	//runs the loop until all tasks are done
+	static void runAll();
+
+	static bool inTask() { return m_current != nullptr; }
+
+	//tasks of the current thread that are not done yet
+	static size_t getTaskCount() { return m_tasks.size(); }
+
+	//deletes the tasks of the current thread that were left behind by an error, finished ones are deleted right away
+	static void reset();
+
+private:
+	friend class ScriptTask;
+
+	static void resume(ScriptTask* task);
+	static void suspend();
+	static void finish(ScriptTask* task); //wakes the waiters and deletes the task
+
+	//one pass over the tasks that are ready, returns false if there were none
+	static bool runReady();
+	static void wakeSleepers();
+
+	//runs the loop until done() returns true or until the deadline has passed
+	template<class Condition>
+	static void runUntil(Condition done, const chrono::steady_clock::time_point* deadline = nullptr);
+
+	static thread_local deque<ScriptTask*> m_ready;
+	static thread_local multimap<chrono::steady_clock::time_point, ScriptTask*> m_sleeping;
+	static thread_local unordered_map<size_t, ScriptTask*> m_tasks; //tasks that are not done yet
+	static thread_local ScriptTask* m_current;
+	static thread_local size_t m_nextId;
+};
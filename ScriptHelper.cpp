@@ -1,9 +1,19 @@
 //NOTE: project was based on https://github.com/vassilych/cscscpp
 
+#include <climits>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <mutex>
 
 #include "ScriptHelper.h"
+#include "Tracer.h"
+
+bool ScriptHelper::m_bufferedOutput = false;
+thread_local ostream* ScriptHelper::m_output = nullptr;
+thread_local bool ParsingException::m_recoverable = false;
 
 string ScriptHelper::findStartingToken(const string& data, const vector<string>& items) 
 {
@@ -86,8 +96,28 @@ bool ScriptHelper::isInt(double val)
 
 void ScriptHelper::print(const string& argument, bool printNewLine)
 {
+    RuntimeStats::local().printedBytes += argument.size() + (printNewLine ? 1 : 0);
+
+    static mutex printMutex;
+    lock_guard<mutex> lock(printMutex);
+
+    //the workers of a pfor loop share the output of the thread that runs the loop
+    if (m_output != nullptr) 
+    {
+        *m_output << argument;
+        if (printNewLine) 
+        {
+            *m_output << '\n';
+        }
+        return;
+    }
+
     cout << argument;
-    if (printNewLine) cout << endl;
+    if (printNewLine) 
+    {
+        if (m_bufferedOutput) cout << '\n';
+        else cout << endl;
+    }
 }
 
 void ScriptHelper::checkInteger(const Variable& variable) 
@@ -116,7 +146,7 @@ vector<Variable> ScriptHelper::getArguments(ParsingScript& script, char start, c
         return args;
     }
 
-    ParsingScript tempScript(script.getData(), script.getPointer());
+    ParsingScript tempScript(script, script.getPointer());
     string body = ScriptHelper::getBodyBetween(tempScript, start, end);
 
     while (script.getPointer() < tempScript.getPointer()) 
@@ -313,6 +343,61 @@ Variable ScriptHelper::getItem(ParsingScript& script)
     return value;
 }
 
+bool ScriptHelper::isArrayElement(const string& item)
+{
+    if (item.size() < 3 || item[0] == Tokens::QUOTE || item[item.size() - 1] != Tokens::END_ARRAY) 
+    {
+        return false;
+    }
+
+    size_t start = item.find(Tokens::START_ARRAY);
+    return start != string::npos && start > 0;
+}
+
+vector<Variable> ScriptHelper::getArrayIndices(const string& item, string& name)
+{
+    vector<Variable> indices;
+
+    size_t start = item.find(Tokens::START_ARRAY);
+    name = item.substr(0, start);
+
+    // Every [...] part is evaluated on its own, e.g. map[key][i + 1]
+    while (start < item.size() && item[start] == Tokens::START_ARRAY) 
+    {
+        int depth = 0;
+        bool inQuotes = false;
+        size_t end = start;
+
+        for (; end < item.size(); end++) 
+        {
+            char ch = item[end];
+            if (ch == Tokens::QUOTE && item[end - 1] != '\\') 
+            {
+                inQuotes = !inQuotes;
+            }
+            else if (!inQuotes && ch == Tokens::START_ARRAY) 
+            {
+                depth++;
+            }
+            else if (!inQuotes && ch == Tokens::END_ARRAY && --depth == 0) 
+            {
+                break;
+            }
+        }
+
+        if (end >= item.size() || end == start + 1) 
+        {
+            throw ParsingException("Syntax Error: Invalid index in [" + item + "]");
+        }
+
+        ParsingScript indexScript(item.substr(start + 1, end - start - 1));
+        indices.push_back(indexScript.execute());
+        start = end + 1;
+    }
+
+    return indices;
+}
+
 string ScriptHelper::getToken(ParsingScript& script, const string& to)
 {
     char curr = script.tryCurrentChar();
@@ -401,6 +486,7 @@ void ScriptHelper::checkNotEnd(const ParsingScript& script, const string& name)
 
 string ScriptHelper::convertToScript(const string& rawData, unordered_map<size_t, size_t>& char2Line) 
 {
+    TraceScope trace("convertToScript", "phase");
     string result;
 
     bool inQuotes = false;
@@ -538,6 +624,7 @@ string ScriptHelper::convertToScript(const string& rawData, unordered_map<size_t
     {
         ScriptHelper::checkSpecialChars(toCheck);
     }
+
     return result;
 }
 
@@ -685,11 +772,14 @@ string ScriptHelper::readScriptFile(const string& path)
 	{
 		throw std::invalid_argument{ "Could not read file from path: '" + path + "'" };
 	}
+	TraceScope trace("readScriptFile", "phase");
+
 	fileStream.ignore(numeric_limits<streamsize>::max());
 	streamsize size = fileStream.gcount();
 	fileStream.clear();
 	fileStream.seekg(0, fileStream.beg);
 	string fileContent(size, ' ');
 	fileStream.read(&fileContent[0], size);
+
 	return fileContent;
 }
\ No newline at end of file
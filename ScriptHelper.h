@@ -26,18 +26,28 @@ class ParsingException : public exception
 public:
 	ParsingException(const string& error) : exception(), m_error(error) 
 	{ 
+		if (m_recoverable) { return; }
 		cout << this->m_error;
 		exit(-1); 
 	}
 
 	ParsingException(const string& error, const ParsingScript& script) : exception(), m_error(error)
 	{
+		if (m_recoverable) { m_error += " at line " + to_string(script.getRawLineNumber()); return; }
 		cout << this->m_error << " at line " << script.getRawLineNumber();
 		exit(-1);
 	}
 
+	virtual const char* what() const noexcept { return m_error.c_str(); }
+
+	//errors end the process unless they are recoverable on the calling thread, then they are thrown to the caller, e.g. the workers of --serve
+	static void setRecoverable(bool recoverable) { m_recoverable = recoverable; }
+	static bool isRecoverable() { return m_recoverable; }
+
 private:
 	string m_error;
+
+	static thread_local bool m_recoverable;
 };
 
 class ScriptHelper
@@ -59,6 +69,15 @@ public:
 
 	static void print(const string& argument, bool printNewLine = false);
 
+	//print() leaves flushing to the stream, so that many short lines are written at once
+	static void setBufferedOutput(bool buffered) { m_bufferedOutput = buffered; }
+
+	//print() of the calling thread writes to out instead of cout, nullptr for cout again
+	static void setOutput(ostream* out) { m_output = out; }
+	static ostream* getOutput() { return m_output; }
+	//what a script printed so far is passed on before the thread goes to sleep
+	static void flushOutput() { if (m_output != nullptr) m_output->flush(); }
+
 	static string readScriptFile(const string& path);
 
 	static void checkInteger(const Variable& variable);
@@ -79,6 +98,9 @@ public:
 	static vector<string> tokenize(const string& data, const string& delimeters = Tokens::NEW_LINE, size_t from = 0, size_t to = string::npos, bool removeEmpty = false);
 
 	static Variable getItem(ParsingScript& script);
+
+	static bool isArrayElement(const string& item);
+	static vector<Variable> getArrayIndices(const string& item, string& name);
 	static string getToken(ParsingScript& script, const string& to = Tokens::END_PARSING_STR);
 
 	static void checkArgsNumber(size_t expected, size_t supplied, const string& name);
@@ -101,5 +123,9 @@ public:
 	static wstring s2w(const string& str);
 	//other direction
 	static string  w2s(const wstring& wstr);
+
+private:
+	static bool m_bufferedOutput;
+	static thread_local ostream* m_output;
 };
 
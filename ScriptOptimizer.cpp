@@ -0,0 +1,659 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Parser.h"
+#include "ScriptOptimizer.h"
+#include "Tracer.h"
+
+bool ScriptOptimizer::m_enabled = true;
+
+void ScriptOptimizer::optimize(string& data, unordered_map<size_t, size_t>& char2Line)
+{
+	if (!m_enabled || data.empty())
+	{
+		return;
+	}
+
+	TraceScope trace("optimize", "phase");
+
+	// Anything the tokenizer doesn't understand leaves the script as it is
+	ScriptOptimizer optimizer(data);
+	if (optimizer.tokenize())
+	{
+		size_t index = 0;
+		Variable value;
+		optimizer.foldList(index, Tokens::NULL_CHAR, value);
+
+		if (!optimizer.m_failed)
+		{
+			optimizer.pruneBranches();
+
+			string result;
+			unordered_map<size_t, size_t> lines;
+			if (optimizer.apply(char2Line, result, lines))
+			{
+				data.swap(result);
+				char2Line.swap(lines);
+			}
+		}
+	}
+}
+
+bool ScriptOptimizer::tokenize()
+{
+	vector<size_t> open;
+	size_t i = 0;
+
+	while (i < m_data.size())
+	{
+		char ch = m_data[i];
+		Token token;
+		token.start = i;
+
+		if (ch == Tokens::QUOTE)
+		{
+			// Same end of a string as in Parser::checkQuotes
+			size_t end = i + 1;
+			while (end < m_data.size() && (m_data[end] != Tokens::QUOTE || m_data[end - 1] == '\\'))
+			{
+				end++;
+			}
+			if (end == m_data.size())
+			{
+				return false;
+			}
+			token.type = STRING;
+			token.text = m_data.substr(i + 1, end - i - 1);
+			token.end = end + 1;
+		}
+		else if (Tokens::TOKEN_SEPARATORS.find(ch) == string::npos)
+		{
+			// An item ends where the parser ends it, 1e5 or 0x10 are names here and never get folded
+			size_t end = i;
+			while (end < m_data.size() && m_data[end] != Tokens::QUOTE && Tokens::TOKEN_SEPARATORS.find(m_data[end]) == string::npos)
+			{
+				end++;
+			}
+			token.text = m_data.substr(i, end - i);
+			token.type = token.text.find_first_not_of("0123456789.") == string::npos && token.text.find_first_of("0123456789") != string::npos
+				? NUMBER : NAME;
+			token.end = end;
+		}
+		else if (ch == Tokens::START_ARG || ch == Tokens::START_ARRAY || ch == Tokens::START_GROUP)
+		{
+			token.type = ch == Tokens::START_GROUP ? SEPARATOR : OPEN;
+			token.text = string(1, ch);
+			token.end = i + 1;
+			open.push_back(m_tokens.size());
+		}
+		else if (ch == Tokens::END_ARG || ch == Tokens::END_ARRAY || ch == Tokens::END_GROUP)
+		{
+			char opening = ch == Tokens::END_ARG ? Tokens::START_ARG : ch == Tokens::END_ARRAY ? Tokens::START_ARRAY : Tokens::START_GROUP;
+			if (open.empty() || m_tokens[open.back()].text[0] != opening)
+			{
+				return false;
+			}
+			token.type = ch == Tokens::END_GROUP ? SEPARATOR : CLOSE;
+			token.text = string(1, ch);
+			token.end = i + 1;
+			token.match = open.back();
+			m_tokens[open.back()].match = m_tokens.size();
+			open.pop_back();
+		}
+		else if (ch == Tokens::NEXT_ARG || ch == Tokens::END_STATEMENT)
+		{
+			token.type = SEPARATOR;
+			token.text = string(1, ch);
+			token.end = i + 1;
+		}
+		else
+		{
+			// The longest action, assignments separate expressions like a comma does
+			string action;
+			for (const string& candidate : Tokens::ACTIONS)
+			{
+				if (candidate.size() > action.size() && m_data.compare(i, candidate.size(), candidate) == 0)
+				{
+					action = candidate;
+				}
+			}
+			if (action.empty() && ch == Tokens::NOT[0])
+			{
+				action = Tokens::NOT;
+			}
+
+			// Like the space kept after return, whatever else there is stops the folding of its expression
+			if (action.empty())
+			{
+				token.type = OTHER;
+				action = string(1, ch);
+			}
+			else if (action == Tokens::ASSIGNMENT || find(Tokens::OPERATOR_ACTIONS.begin(), Tokens::OPERATOR_ACTIONS.end(), action) != Tokens::OPERATOR_ACTIONS.end())
+			{
+				token.type = SEPARATOR;
+			}
+			else
+			{
+				token.type = OPERATOR;
+			}
+			token.text = action;
+			token.end = i + action.size();
+		}
+
+		i = token.end;
+		m_tokens.push_back(token);
+	}
+
+	return open.empty();
+}
+
+bool ScriptOptimizer::foldList(size_t& index, char closer, Variable& value)
+{
+	vector<Element> expression;
+	bool valid = true;		//the expression is operand (operator operand)*
+	bool negated = false;	//a ! before the next operand
+	bool separated = false;
+	bool constant = false;
+
+	auto finishExpression = [&]()
+	{
+		if (valid && !expression.empty() && !expression.back().isOperator)
+		{
+			constant = foldExpression(expression, value);
+		}
+		expression.clear();
+		valid = true;
+		negated = false;
+	};
+
+	for (; index < m_tokens.size() && !m_failed; index++)
+	{
+		const Token& token = m_tokens[index];
+		bool operandExpected = expression.empty() || expression.back().isOperator;
+
+		if (token.type == CLOSE)
+		{
+			if (token.text[0] != closer)
+			{
+				m_failed = true;
+				return false;
+			}
+			break;
+		}
+
+		if (token.type == SEPARATOR)
+		{
+			finishExpression();
+			separated = true;
+			continue;
+		}
+
+		Element element;
+		element.start = token.start;
+		element.end = token.end;
+
+		switch (token.type)
+		{
+		case OPEN:
+		{
+			size_t open = index++;
+			Variable inner;
+			bool innerConstant = foldList(index, token.text[0] == Tokens::START_ARG ? Tokens::END_ARG : Tokens::END_ARRAY, inner);
+			if (m_failed)
+			{
+				return false;
+			}
+
+			if (!operandExpected)
+			{
+				// Arguments of a call or an index, they become a part of the operand before them
+				expression.back().end = m_tokens[index].end;
+				expression.back().isConstant = false;
+				expression.back().isGroup = false;
+				if (innerConstant && token.text[0] == Tokens::START_ARG && inner.getType() == Tokens::NUMERIC)
+				{
+					m_conditions[open] = inner.m_numericValue;
+				}
+				continue;
+			}
+
+			element.end = m_tokens[index].end;
+			element.isGroup = token.text[0] == Tokens::START_ARG;
+			element.isConstant = element.isGroup && innerConstant && !negated;
+			element.value = inner;
+			break;
+		}
+		case NUMBER:
+		case STRING:
+			element.isConstant = !negated;
+			element.value = token.type == STRING ? Variable(token.text) : Variable(::strtod(token.text.c_str(), nullptr));
+			break;
+		case NAME:
+			break;
+		case OPERATOR:
+			if (operandExpected && token.text == "-" && index + 1 < m_tokens.size()
+				&& m_tokens[index + 1].type == NUMBER && m_tokens[index + 1].start == token.end)
+			{
+				// A negative number, the parser collects the - into the item
+				const Token& number = m_tokens[++index];
+				element.end = number.end;
+				element.isConstant = !negated;
+				element.value = Variable(::strtod(("-" + number.text).c_str(), nullptr));
+				break;
+			}
+			if (operandExpected && token.text == Tokens::NOT)
+			{
+				negated = true;
+				continue;
+			}
+			valid = valid && !operandExpected;
+			element.isOperator = true;
+			element.action = token.text;
+			expression.push_back(element);
+			continue;
+		default:
+			valid = false;
+			continue;
+		}
+
+		valid = valid && operandExpected;
+		negated = false;
+		expression.push_back(element);
+	}
+
+	if (closer != Tokens::NULL_CHAR && index == m_tokens.size())
+	{
+		m_failed = true;
+		return false;
+	}
+
+	finishExpression();
+	return constant && !separated;
+}
+
+bool ScriptOptimizer::foldExpression(vector<Element>& expression, Variable& value)
+{
+	size_t count = (expression.size() + 1) / 2;
+	auto operand = [&](size_t i) -> Element& { return expression[2 * i]; };
+	auto priority = [&](size_t i) { return Variable::getPriority(expression[2 * i + 1].action); };
+
+	if (count == 1 && !operand(0).isGroup)
+	{
+		value = operand(0).value;
+		return operand(0).isConstant;
+	}
+
+	bool constant = false;
+	size_t first = 0;
+
+	while (first < count)
+	{
+		if (!operand(first).isConstant)
+		{
+			first++;
+			continue;
+		}
+
+		// The longest run of constants from here that is computed on its own at runtime too,
+		// i.e. its actions bind tighter than those around it: in x+2*3-1 that is 2*3
+		size_t last = first;
+		int lowest = INT_MAX;
+		for (size_t i = first + 1; i < count && operand(i).isConstant && isFoldable(expression[2 * i - 1].action); i++)
+		{
+			lowest = min(lowest, priority(i - 1));
+			if ((first == 0 || lowest > priority(first - 1)) && (i + 1 == count || lowest >= priority(i)))
+			{
+				last = i;
+			}
+		}
+
+		Variable result;
+		if (last > first && evaluateRun(expression, first, last, result) && replace(operand(first).start, operand(last).end, result, first > 0))
+		{
+			if (count == last + 1 && first == 0)
+			{
+				value = result;
+				constant = true;
+			}
+			first = last + 1;
+			continue;
+		}
+
+		// Otherwise the parentheses of a constant are still not needed
+		if (operand(first).isGroup && replace(operand(first).start, operand(first).end, operand(first).value, first > 0) && count == 1)
+		{
+			value = operand(first).value;
+			constant = true;
+		}
+		first++;
+	}
+
+	return constant;
+}
+
+bool ScriptOptimizer::evaluateRun(const vector<Element>& expression, size_t first, size_t last, Variable& result) const
+{
+	bool hasString = false;
+	for (size_t i = first; i <= last; i++)
+	{
+		hasString = hasString || expression[2 * i].value.getType() == Tokens::STRING;
+	}
+
+	for (size_t i = first; i < last; i++)
+	{
+		const string& action = expression[2 * i + 1].action;
+
+		// Strings only support + and the comparisons, anything else would stop the script
+		if (hasString && action != "+" && !isComparison(action))
+		{
+			return false;
+		}
+
+		// % works on ints, the divisor must be a literal that can't crash it
+		if (action == "%")
+		{
+			if (i + 1 < last && expression[2 * i + 3].action == "^")
+			{
+				return false;
+			}
+			double divisor = expression[2 * i + 2].value.m_numericValue;
+			if (!(fabs(divisor) < 2147483648.0) || (int)divisor == 0 || (int)divisor == -1)
+			{
+				return false;
+			}
+		}
+	}
+
+	vector<Variable> run;
+	for (size_t i = first; i <= last; i++)
+	{
+		run.push_back(expression[2 * i].value);
+		run.back().m_action = i < last ? expression[2 * i + 1].action : Tokens::NULL_ACTION;
+	}
+
+	result = run[0];
+	size_t index = 1;
+	Parser::merge(result, index, run);
+	return true;
+}
+
+bool ScriptOptimizer::replace(size_t start, size_t end, const Variable& value, bool afterOperator)
+{
+	string literal;
+	if (!toLiteral(value, literal))
+	{
+		return false;
+	}
+
+	// x--3 would be a decrement
+	if (afterOperator && literal[0] == '-')
+	{
+		literal = Tokens::START_ARG + literal + Tokens::END_ARG;
+	}
+
+	if (m_data.compare(start, end - start, literal) != 0)
+	{
+		addEdit(start, end, literal);
+	}
+	return true;
+}
+
+bool ScriptOptimizer::toLiteral(const Variable& value, string& literal)
+{
+	if (value.getType() == Tokens::STRING)
+	{
+		if (value.m_stringValue.find_first_of("\"\\") != string::npos)
+		{
+			return false;
+		}
+		literal = Tokens::QUOTE + value.m_stringValue + Tokens::QUOTE;
+		return true;
+	}
+
+	double number = value.m_numericValue;
+	if (value.getType() != Tokens::NUMERIC || !isfinite(number) || (number == 0 && signbit(number)))
+	{
+		return false;
+	}
+
+	// The shortest text that gives the same double, 1e+20 would be split at the +
+	char buffer[32];
+	for (int precision = 1; precision <= 17; precision++)
+	{
+		snprintf(buffer, sizeof(buffer), "%.*g", precision, number);
+		if (strchr(buffer, 'e') == nullptr && ::strtod(buffer, nullptr) == number)
+		{
+			literal = buffer;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ScriptOptimizer::isFoldable(const string& action)
+{
+	return action == "^" || action == "%" || action == "*" || action == "/" || action == "+" || action == "-" || isComparison(action);
+}
+
+bool ScriptOptimizer::isComparison(const string& action)
+{
+	return action == "<" || action == ">" || action == "<=" || action == ">=" || action == "==" || action == "!=";
+}
+
+void ScriptOptimizer::pruneBranches()
+{
+	for (size_t i = 0; i + 1 < m_tokens.size(); i++)
+	{
+		const Token& token = m_tokens[i];
+		if (token.type != NAME || m_tokens[i + 1].type != OPEN || m_tokens[i + 1].text[0] != Tokens::START_ARG || !isStatementStart(i))
+		{
+			continue;
+		}
+
+		if (token.text == Tokens::IF)
+		{
+			pruneChain(i);
+		}
+		else if (token.text == Tokens::WHILE)
+		{
+			size_t end;
+			if (getBlockEnd(m_tokens[i + 1].match + 1, end) && getCondition(i + 1) == 0)
+			{
+				addEdit(token.start, m_tokens[end].end, Tokens::EMPTY);
+			}
+		}
+	}
+}
+
+void ScriptOptimizer::pruneChain(size_t index)
+{
+	// if(...){...} eif(...){...} ... else{...}
+	struct Clause
+	{
+		size_t keyword;
+		size_t condition; //the ( of the condition, npos for else
+		size_t end;
+	};
+	vector<Clause> clauses;
+
+	size_t keyword = index;
+	while (true)
+	{
+		Clause clause = { keyword, string::npos, 0 };
+		size_t block = keyword + 1;
+		if (m_tokens[keyword].text != Tokens::ELSE)
+		{
+			clause.condition = keyword + 1;
+			block = m_tokens[keyword + 1].match + 1;
+		}
+		if (!getBlockEnd(block, clause.end))
+		{
+			return;
+		}
+		clauses.push_back(clause);
+
+		size_t next = clause.end + 1;
+		if (clause.condition == string::npos || next + 1 >= m_tokens.size() || m_tokens[next].type != NAME)
+		{
+			break;
+		}
+		if (m_tokens[next].text == Tokens::ELSE_IF && m_tokens[next + 1].type == OPEN && m_tokens[next + 1].text[0] == Tokens::START_ARG)
+		{
+			keyword = next;
+		}
+		else if (m_tokens[next].text == Tokens::ELSE && m_tokens[next + 1].text[0] == Tokens::START_GROUP)
+		{
+			keyword = next;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// Clauses that can't run are removed, the first one that always runs becomes the last one
+	bool first = true;
+	bool decided = false;
+	for (const Clause& clause : clauses)
+	{
+		const Token& keywordToken = m_tokens[clause.keyword];
+		int condition = clause.condition == string::npos ? 1 : getCondition(clause.condition);
+
+		if (decided || condition == 0)
+		{
+			addEdit(keywordToken.start, m_tokens[clause.end].end, Tokens::EMPTY);
+			continue;
+		}
+
+		if (condition == 1)
+		{
+			size_t headerEnd = clause.condition == string::npos ? keywordToken.end : m_tokens[m_tokens[clause.condition].match].end;
+			string header = first ? Tokens::IF + Tokens::START_ARG + "1" + Tokens::END_ARG : Tokens::ELSE;
+			if (m_data.compare(keywordToken.start, headerEnd - keywordToken.start, header) != 0)
+			{
+				addEdit(keywordToken.start, headerEnd, header);
+			}
+			decided = true;
+		}
+		else if (first && keywordToken.text != Tokens::IF)
+		{
+			addEdit(keywordToken.start, keywordToken.end, Tokens::IF);
+		}
+		first = false;
+	}
+}
+
+bool ScriptOptimizer::getBlockEnd(size_t open, size_t& end) const
+{
+	if (open >= m_tokens.size() || m_tokens[open].text[0] != Tokens::START_GROUP || m_tokens[open].match == string::npos)
+	{
+		return false;
+	}
+	end = m_tokens[open].match;
+	return true;
+}
+
+int ScriptOptimizer::getCondition(size_t open) const
+{
+	auto it = m_conditions.find(open);
+	if (it == m_conditions.end())
+	{
+		return -1;
+	}
+	return it->second != 0 ? 1 : 0;
+}
+
+bool ScriptOptimizer::isStatementStart(size_t index) const
+{
+	if (index == 0)
+	{
+		return true;
+	}
+	const string& previous = m_tokens[index - 1].text;
+	return m_tokens[index - 1].type == SEPARATOR
+		&& (previous[0] == Tokens::END_STATEMENT || previous[0] == Tokens::START_GROUP || previous[0] == Tokens::END_GROUP);
+}
+
+void ScriptOptimizer::addEdit(size_t start, size_t end, const string& text)
+{
+	m_edits.push_back({ start, end, text });
+}
+
+bool ScriptOptimizer::apply(const unordered_map<size_t, size_t>& original, string& data, unordered_map<size_t, size_t>& char2Line)
+{
+	if (m_edits.empty())
+	{
+		return false;
+	}
+
+	// An edit inside of another one is replaced along with it, e.g. a folded condition of a removed branch
+	sort(m_edits.begin(), m_edits.end(), [](const Edit& left, const Edit& right)
+	{
+		return left.start != right.start ? left.start < right.start : left.end > right.end;
+	});
+
+	vector<Edit> applied;
+	vector<long long> shifts; //how much later offsets move after every applied edit
+	long long shift = 0;
+	size_t position = 0;
+
+	for (const Edit& edit : m_edits)
+	{
+		if (edit.start < position)
+		{
+			if (edit.end > position)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		data.append(m_data, position, edit.start - position);
+		data += edit.text;
+		position = edit.end;
+
+		shift += (long long)edit.text.size() - (long long)(edit.end - edit.start);
+		applied.push_back(edit);
+		shifts.push_back(shift);
+	}
+	data.append(m_data, position, string::npos);
+
+	// A line that ends in a replacement ends with it, the lines of removed text end before it
+	for (const auto& entry : original)
+	{
+		size_t index = upper_bound(applied.begin(), applied.end(), entry.first, [](size_t offset, const Edit& edit)
+		{
+			return offset < edit.start;
+		}) - applied.begin();
+
+		long long offset = (long long)entry.first;
+		if (index > 0 && entry.first < applied[index - 1].end)
+		{
+			const Edit& edit = applied[index - 1];
+			long long before = index > 1 ? shifts[index - 2] : 0;
+			offset = (long long)edit.start + before + (long long)edit.text.size() - 1;
+		}
+		else if (index > 0)
+		{
+			offset += shifts[index - 1];
+		}
+
+		if (offset < 0)
+		{
+			continue;
+		}
+
+		auto it = char2Line.find((size_t)offset);
+		if (it == char2Line.end() || it->second > entry.second)
+		{
+			char2Line[(size_t)offset] = entry.second;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,94 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Variable.h"
+
+/*
+*  Optimization pass over a script converted by ScriptHelper::convertToScript,
+*  done once before the script runs. Constant parts of expressions are
+*  computed with the same merge as at runtime and replaced by their result,
+*  e.g. print(20+10*5) becomes print(70) and x*(2-5) becomes x*(-3).
+*  Branches of if, eif, else and while with a constant condition are removed
+*  or made unconditional, so they are neither evaluated nor skipped later.
+*  Whatever could fold differently than it runs is left alone: && and ||
+*  (they skip the rest of the expression), % that could divide by zero,
+*  string actions other than + and the comparisons, and results that can't
+*  be written back as a literal.
+*/
+class ScriptOptimizer
+{
+public:
+	static void setEnabled(bool enabled) { m_enabled = enabled; }
+	static bool isEnabled() { return m_enabled; }
+
+	//changes the converted script in place, the offsets of char2Line are moved along
+	static void optimize(string& data, unordered_map<size_t, size_t>& char2Line);
+
+private:
+	enum TokenType { NUMBER, STRING, NAME, OPERATOR, SEPARATOR, OPEN, CLOSE, OTHER };
+
+	struct Token
+	{
+		TokenType type;
+		size_t	  start;
+		size_t	  end;
+		string	  text;					//the value of a string, without the quotes
+		size_t	  match = string::npos;	//the other bracket of ( ) [ ] { }
+	};
+
+	//an operand or an operator of an expression
+	struct Element
+	{
+		bool	 isOperator = false;
+		size_t	 start = 0;
+		size_t	 end = 0;
+		bool	 isConstant = false;
+		bool	 isGroup = false; //between parentheses
+		Variable value;
+		string	 action;
+	};
+
+	//replaces the characters from start to end
+	struct Edit
+	{
+		size_t start;
+		size_t end;
+		string text;
+	};
+
+	ScriptOptimizer(const string& data) : m_data(data) {}
+
+	bool tokenize();
+
+	//folds the expressions up to the closing bracket, true if they are a single constant
+	bool foldList(size_t& index, char closer, Variable& value);
+	bool foldExpression(vector<Element>& expression, Variable& value);
+	bool evaluateRun(const vector<Element>& expression, size_t first, size_t last, Variable& result) const;
+	bool replace(size_t start, size_t end, const Variable& value, bool afterOperator);
+
+	void pruneBranches();
+	void pruneChain(size_t index);
+	bool getBlockEnd(size_t open, size_t& end) const;
+	int  getCondition(size_t open) const;
+	bool isStatementStart(size_t index) const;
+
+	void addEdit(size_t start, size_t end, const string& text);
+	bool apply(const unordered_map<size_t, size_t>& original, string& data, unordered_map<size_t, size_t>& char2Line);
+
+	static bool toLiteral(const Variable& value, string& literal);
+	static bool isFoldable(const string& action);
+	static bool isComparison(const string& action);
+
+	static bool m_enabled;
+
+	const string&				  m_data;
+	vector<Token>				  m_tokens;
+	vector<Edit>				  m_edits;
+	unordered_map<size_t, double> m_conditions; //constant value of the arguments of a call, by the token of its (
+	bool						  m_failed = false;
+};
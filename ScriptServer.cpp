@@ -0,0 +1,624 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "ScriptServer.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Json.h"
+#include "ParserFunction.h"
+
+const size_t ScriptServer::OUTPUT_FRAME;
+const size_t ScriptServer::MAX_PENDING_OUTPUT;
+const int    ScriptServer::OUTPUT_DELAY_MS;
+const size_t ScriptServer::MAX_REQUEST_LINE;
+
+int ScriptServer::m_wakeFd = -1;
+atomic<bool> ScriptServer::m_stopRequested(false);
+
+ScriptServer::ScriptServer(const string& socketPath, size_t workerCount) :
+	m_socketPath(socketPath), m_workerCount(workerCount > 0 ? workerCount : 1), m_pool(m_workerCount)
+{
+}
+
+ScriptServer::~ScriptServer()
+{
+	shutdown();
+}
+
+#ifdef __linux__
+
+void ScriptServer::run()
+{
+	listen();
+
+	for (size_t i = 0; i < m_workerCount; i++)
+	{
+		m_workers.emplace_back(&ScriptServer::work, this);
+	}
+
+	const int MAX_EVENTS = 64;
+	epoll_event events[MAX_EVENTS];
+
+	while (!m_stopRequested)
+	{
+		int count = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw ParsingException("Could not wait for the clients of [" + m_socketPath + "]: " + strerror(errno));
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			int fd = events[i].data.fd;
+			if (fd == m_listenFd)
+			{
+				accept();
+				continue;
+			}
+			if (fd == m_wakeFd)
+			{
+				uint64_t value;
+				while (read(m_wakeFd, &value, sizeof(value)) > 0) {}
+				servePending();
+				continue;
+			}
+
+			auto it = m_connections.find(fd);
+			if (it == m_connections.end())
+			{
+				continue;
+			}
+
+			shared_ptr<Connection> connection = it->second;
+			if (events[i].events & EPOLLERR)
+			{
+				close(connection);
+				continue;
+			}
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))
+			{
+				if (!receive(connection))
+				{
+					continue;
+				}
+			}
+			if (events[i].events & EPOLLOUT)
+			{
+				flush(connection);
+			}
+			dispatch(connection);
+			update(connection);
+		}
+	}
+
+	shutdown();
+}
+
+//true if a daemon accepts on the socket
+static bool isServing(const sockaddr_un& address)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	//nobody accepts on a socket that was left behind, connect() is refused right away
+	bool serving = connect(fd, (const sockaddr*)&address, sizeof(address)) == 0 || errno == EAGAIN;
+	::close(fd);
+	return serving;
+}
+
+void ScriptServer::listen()
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.size() >= sizeof(address.sun_path))
+	{
+		throw ParsingException("The socket path [" + m_socketPath + "] is too long");
+	}
+	strncpy(address.sun_path, m_socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	//a socket that was left behind by a previous daemon is replaced, any other file is kept
+	struct stat status;
+	if (stat(m_socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+	{
+		if (isServing(address))
+		{
+			throw ParsingException("Another daemon is serving on [" + m_socketPath + "]");
+		}
+		unlink(m_socketPath.c_str());
+	}
+
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (m_listenFd < 0)
+	{
+		throw ParsingException("Could not listen on [" + m_socketPath + "]: " + strerror(errno));
+	}
+	if (bind(m_listenFd, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		//the path belongs to someone else, shutdown() must not remove it
+		string error = strerror(errno);
+		::close(m_listenFd);
+		m_listenFd = -1;
+		throw ParsingException("Could not listen on [" + m_socketPath + "]: " + error);
+	}
+	m_bound = true;
+
+	if (::listen(m_listenFd, SOMAXCONN) != 0)
+	{
+		throw ParsingException("Could not listen on [" + m_socketPath + "]: " + strerror(errno));
+	}
+
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_epollFd < 0 || m_wakeFd < 0)
+	{
+		throw ParsingException(string("Could not create the event loop of the daemon: ") + strerror(errno));
+	}
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = m_listenFd;
+	epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event);
+	event.data.fd = m_wakeFd;
+	epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+
+	//without SA_RESTART, so epoll_wait() returns and the loop sees the request to stop
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onSignal;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+}
+
+void ScriptServer::shutdown()
+{
+	{
+		lock_guard<mutex> lock(m_jobMutex);
+		m_stop = true;
+		m_jobs.clear();
+	}
+	m_jobReady.notify_all();
+
+	//a worker that waits for a slow client gets released by closing the connection
+	while (!m_connections.empty())
+	{
+		close(m_connections.begin()->second);
+	}
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+
+	if (m_listenFd >= 0)
+	{
+		::close(m_listenFd);
+		m_listenFd = -1;
+	}
+	if (m_bound)
+	{
+		unlink(m_socketPath.c_str());
+		m_bound = false;
+	}
+	//the wake up descriptor is shared by the signal handler, it belongs to the daemon that created its event loop
+	if (m_epollFd >= 0)
+	{
+		::close(m_epollFd);
+		m_epollFd = -1;
+
+		if (m_wakeFd >= 0)
+		{
+			::close(m_wakeFd);
+			m_wakeFd = -1;
+		}
+	}
+}
+
+void ScriptServer::onSignal(int)
+{
+	m_stopRequested = true;
+	uint64_t one = 1;
+	if (m_wakeFd >= 0 && write(m_wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+void ScriptServer::accept()
+{
+	int fd;
+	while ((fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		shared_ptr<Connection> connection = make_shared<Connection>();
+		connection->fd = fd;
+		connection->events = EPOLLIN | EPOLLRDHUP;
+
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = connection->events;
+		event.data.fd = fd;
+		epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+
+		m_connections[fd] = connection;
+	}
+}
+
+bool ScriptServer::receive(const shared_ptr<Connection>& connection)
+{
+	char buffer[OUTPUT_FRAME];
+	while (true)
+	{
+		ssize_t count = recv(connection->fd, buffer, sizeof(buffer), 0);
+		if (count > 0)
+		{
+			connection->input.append(buffer, count);
+
+			//only the new bytes are searched, a line that never ends would otherwise be searched again and again
+			const char* newLine = (const char*)memrchr(buffer, '\n', count);
+			connection->lineLength = newLine != nullptr ? buffer + count - newLine - 1 : connection->lineLength + count;
+			if (connection->lineLength > MAX_REQUEST_LINE)
+			{
+				close(connection);
+				return false;
+			}
+			continue;
+		}
+		if (count == 0)
+		{
+			connection->eof = true;
+		}
+		else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			//the client is gone, nothing can be answered anymore
+			connection->eof = true;
+			lock_guard<mutex> lock(connection->outputMutex);
+			connection->output.clear();
+		}
+		return true;
+	}
+}
+
+void ScriptServer::flush(const shared_ptr<Connection>& connection)
+{
+	lock_guard<mutex> lock(connection->outputMutex);
+
+	size_t sent = 0;
+	while (sent < connection->output.size())
+	{
+		ssize_t count = ::send(connection->fd, connection->output.data() + sent, connection->output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (count > 0)
+		{
+			sent += count;
+			continue;
+		}
+		if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			//the client is gone, whatever is left is dropped
+			sent = connection->output.size();
+			connection->eof = true;
+		}
+		if (count < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		break;
+	}
+
+	connection->output.erase(0, sent);
+	connection->drained.notify_all();
+}
+
+void ScriptServer::dispatch(const shared_ptr<Connection>& connection)
+{
+	while (!connection->busy)
+	{
+		size_t end = connection->input.find('\n');
+		if (end == string::npos)
+		{
+			//the last request may come without a new line before the client closes its side
+			if (!connection->eof || connection->input.empty())
+			{
+				return;
+			}
+			end = connection->input.size();
+		}
+
+		string request = connection->input.substr(0, end);
+		connection->input.erase(0, end + 1 <= connection->input.size() ? end + 1 : end);
+		if (ScriptHelper::trim(request).empty())
+		{
+			continue;
+		}
+
+		connection->busy = true;
+		{
+			lock_guard<mutex> lock(m_jobMutex);
+			m_jobs.push_back({ connection, move(request) });
+		}
+		m_jobReady.notify_one();
+	}
+}
+
+void ScriptServer::update(const shared_ptr<Connection>& connection)
+{
+	bool pending;
+	{
+		lock_guard<mutex> lock(connection->outputMutex);
+		pending = !connection->output.empty();
+	}
+
+	if (connection->eof && !connection->busy && !pending)
+	{
+		close(connection);
+		return;
+	}
+
+	//after the end of the input only the answers are left to be written
+	uint32_t events = (connection->eof ? 0 : (uint32_t)(EPOLLIN | EPOLLRDHUP)) | (pending ? (uint32_t)EPOLLOUT : 0);
+	if (events != connection->events)
+	{
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = events;
+		event.data.fd = connection->fd;
+		epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+		connection->events = events;
+	}
+}
+
+void ScriptServer::close(shared_ptr<Connection> connection)
+{
+	epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+	::close(connection->fd);
+	m_connections.erase(connection->fd);
+
+	//a worker that still runs a request of the connection discards its output
+	lock_guard<mutex> lock(connection->outputMutex);
+	connection->closed = true;
+	connection->output.clear();
+	connection->drained.notify_all();
+}
+
+void ScriptServer::servePending()
+{
+	vector<shared_ptr<Connection>> pending;
+	{
+		lock_guard<mutex> lock(m_pendingMutex);
+		pending.swap(m_pending);
+	}
+
+	for (const shared_ptr<Connection>& connection : pending)
+	{
+		bool finished;
+		{
+			lock_guard<mutex> lock(connection->outputMutex);
+			if (connection->closed)
+			{
+				continue;
+			}
+			finished = connection->finished;
+			connection->finished = false;
+		}
+
+		flush(connection);
+		if (finished)
+		{
+			connection->busy = false;
+		}
+		dispatch(connection);
+		update(connection);
+	}
+}
+
+void ScriptServer::send(const shared_ptr<Connection>& connection, const string& frame, bool last)
+{
+	{
+		unique_lock<mutex> lock(connection->outputMutex);
+		connection->drained.wait(lock, [&] { return connection->closed || connection->output.size() < MAX_PENDING_OUTPUT; });
+
+		if (!connection->closed)
+		{
+			connection->output += frame;
+		}
+		connection->finished = connection->finished || last;
+	}
+
+	{
+		lock_guard<mutex> lock(m_pendingMutex);
+		m_pending.push_back(connection);
+	}
+	uint64_t one = 1;
+	if (write(m_wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+shared_ptr<const PreparedScript> ScriptServer::getScript(const string& path)
+{
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+	{
+		throw ParsingException("Could not read the script [" + path + "]");
+	}
+	long long modified = (long long)status.st_mtim.tv_sec * 1000000000LL + status.st_mtim.tv_nsec;
+
+	{
+		lock_guard<mutex> lock(m_scriptMutex);
+		auto it = m_scripts.find(path);
+		if (it != m_scripts.end() && it->second.modified == modified && it->second.size == (long long)status.st_size)
+		{
+			return it->second.script;
+		}
+	}
+
+	//converted outside of the lock, two workers might both convert a changed script
+	shared_ptr<const PreparedScript> script = make_shared<PreparedScript>(Interpreter::prepare(ScriptHelper::readScriptFile(path)));
+
+	lock_guard<mutex> lock(m_scriptMutex);
+	m_scripts[path] = { modified, (long long)status.st_size, script };
+	return script;
+}
+
+#else
+
+void ScriptServer::run()
+{
+	throw ParsingException("--serve needs epoll and is only supported on Linux");
+}
+
+void ScriptServer::shutdown()
+{
+}
+
+void ScriptServer::send(const shared_ptr<Connection>& connection, const string& frame, bool last)
+{
+}
+
+shared_ptr<const PreparedScript> ScriptServer::getScript(const string& path)
+{
+	return nullptr;
+}
+
+#endif
+
+void ScriptServer::work()
+{
+	//an error only ends the request that caused it
+	ParsingException::setRecoverable(true);
+
+	while (true)
+	{
+		Job job;
+		{
+			unique_lock<mutex> lock(m_jobMutex);
+			m_jobReady.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+			if (m_stop)
+			{
+				return;
+			}
+			job = move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		execute(job.connection, job.request);
+	}
+}
+
+void ScriptServer::execute(const shared_ptr<Connection>& connection, const string& request)
+{
+	OutputBuffer buffer(*this, connection);
+	ostream out(&buffer);
+	ScriptHelper::setOutput(&out);
+
+	string error;
+	try
+	{
+		Variable parsed = Json::parse(request);
+		ScriptJson* fields = parsed.m_type == Tokens::JSON ? static_cast<ScriptJson*>(parsed.m_object.get()) : nullptr;
+		if (fields == nullptr || !fields->isObject())
+		{
+			throw ParsingException("A request is a JSON object like {\"script\": \"path\", \"vars\": {...}}");
+		}
+
+		Variable path = fields->getElement(Variable(string("script")));
+		if (path.m_type != Tokens::STRING)
+		{
+			throw ParsingException("The request has no \"script\" to run");
+		}
+		shared_ptr<const PreparedScript> script = getScript(path.m_stringValue);
+
+		Variable vars = fields->getElement(Variable(string("vars")));
+		ScriptJson* values = vars.m_type == Tokens::JSON ? static_cast<ScriptJson*>(vars.m_object.get()) : nullptr;
+		if (vars.m_type != Tokens::VOID && (values == nullptr || !values->isObject()))
+		{
+			throw ParsingException("The \"vars\" of a request must be a JSON object");
+		}
+
+		InterpreterPool::Lease lease(m_pool);
+		for (size_t i = 0; values != nullptr && i < values->size(); i++)
+		{
+			ParserFunction::assignVariable(values->keyAt(i).toString(), values->valueAt(i));
+		}
+		Interpreter::evaluate(*script);
+	}
+	catch (const exception& e)
+	{
+		error = e.what();
+	}
+
+	ScriptHelper::setOutput(nullptr);
+	buffer.sendFrame();
+
+	if (error.empty())
+	{
+		send(connection, "done\n", true);
+	}
+	else
+	{
+		send(connection, "error " + to_string(error.size()) + "\n" + error, true);
+	}
+}
+
+//OUTPUT BUFFER
+ScriptServer::OutputBuffer::OutputBuffer(ScriptServer& server, const shared_ptr<Connection>& connection) :
+	m_server(server), m_connection(connection), m_lastFrame(chrono::steady_clock::now())
+{
+	setp(m_buffer, m_buffer + sizeof(m_buffer));
+}
+
+void ScriptServer::OutputBuffer::sendFrame()
+{
+	size_t size = pptr() - pbase();
+	m_lastFrame = chrono::steady_clock::now();
+	if (size == 0)
+	{
+		return;
+	}
+
+	m_server.send(m_connection, "output " + to_string(size) + "\n" + string(pbase(), size));
+	setp(m_buffer, m_buffer + sizeof(m_buffer));
+}
+
+ScriptServer::OutputBuffer::int_type ScriptServer::OutputBuffer::overflow(int_type ch)
+{
+	sendFrame();
+	if (!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+streamsize ScriptServer::OutputBuffer::xsputn(const char* data, streamsize count)
+{
+	streamsize written = streambuf::xsputn(data, count);
+
+	//a script that prints now and then is not kept waiting for a full frame
+	if (chrono::steady_clock::now() - m_lastFrame >= chrono::milliseconds(OUTPUT_DELAY_MS))
+	{
+		sendFrame();
+	}
+	return written;
+}
+
+int ScriptServer::OutputBuffer::sync()
+{
+	sendFrame();
+	return 0;
+}
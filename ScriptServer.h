@@ -0,0 +1,141 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <unordered_map>
+
+#include "Interpreter.h"
+#include "InterpreterPool.h"
+
+/*
+*  Daemon of --serve. Clients connect to a Unix socket and send one
+*  request per line, a JSON object like
+*      {"script": "jobs/report.xes", "vars": {"day": 3, "region": "north"}}
+*  The script runs in an environment of an InterpreterPool with the vars
+*  assigned as globals. What it prints is sent back while it runs in
+*  "output <length>\n<bytes>" frames, the request ends with "done\n" or
+*  with "error <length>\n<message>".
+*  Scripts are converted once and cached by their path until the file
+*  changes. One thread waits for all sockets with epoll, the requests run
+*  on the worker threads, the requests of one connection one after another.
+*/
+class ScriptServer
+{
+public:
+	static const size_t OUTPUT_FRAME = 16 * 1024;
+	static const size_t MAX_PENDING_OUTPUT = 1024 * 1024; //a worker waits for a slow client beyond this
+	static const int	OUTPUT_DELAY_MS = 50;			   //printed text is sent at least this often
+	static const size_t MAX_REQUEST_LINE = 16 * 1024 * 1024; //a client that sends a longer line is dropped
+
+	ScriptServer(const string& socketPath, size_t workerCount);
+	~ScriptServer();
+
+	//serves until SIGINT or SIGTERM
+	void run();
+
+private:
+	struct Connection
+	{
+		int fd;
+
+		//used by the epoll thread only
+		string	 input;
+		size_t	 lineLength = 0; //bytes of the input since the last new line
+		bool	 busy = false; //a request of the connection is queued or running
+		bool	 eof = false;  //the client won't send more, the connection is closed once everything is answered
+		uint32_t events = 0;
+
+		//shared with the worker that runs the request
+		mutex			   outputMutex;
+		condition_variable drained;
+		string			   output;
+		bool			   finished = false; //the worker sent the end of the request
+		bool			   closed = false;
+	};
+
+	struct Job
+	{
+		shared_ptr<Connection> connection;
+		string				   request;
+	};
+
+	struct CachedScript
+	{
+		long long						 modified;
+		long long						 size;
+		shared_ptr<const PreparedScript> script;
+	};
+
+	//collects what a script prints and sends it as output frames
+	class OutputBuffer : public streambuf
+	{
+	public:
+		OutputBuffer(ScriptServer& server, const shared_ptr<Connection>& connection);
+
+		void sendFrame();
+
+	protected:
+		virtual int_type overflow(int_type ch);
+		virtual streamsize xsputn(const char* data, streamsize count);
+		virtual int sync();
+
+	private:
+		ScriptServer&						  m_server;
+		shared_ptr<Connection>				  m_connection;
+		chrono::steady_clock::time_point	  m_lastFrame;
+		char								  m_buffer[OUTPUT_FRAME];
+	};
+
+	void listen();
+	void shutdown();
+
+	void accept();
+	bool receive(const shared_ptr<Connection>& connection); //false if the connection got dropped
+	void flush(const shared_ptr<Connection>& connection);
+	void dispatch(const shared_ptr<Connection>& connection);
+	void update(const shared_ptr<Connection>& connection);
+	void close(shared_ptr<Connection> connection); //by value, the map entry it may come from gets erased
+	void servePending();
+
+	void work();
+	void execute(const shared_ptr<Connection>& connection, const string& request);
+	shared_ptr<const PreparedScript> getScript(const string& path);
+
+	//called by the workers, wakes the epoll thread up to send the frame
+	void send(const shared_ptr<Connection>& connection, const string& frame, bool last = false);
+
+	static void onSignal(int signal);
+
+	string		   m_socketPath;
+	size_t		   m_workerCount;
+	InterpreterPool m_pool;
+
+	int	 m_listenFd = -1;
+	bool m_bound = false; //the socket file was created by this daemon and is removed again
+	int	 m_epollFd = -1;
+
+	unordered_map<int, shared_ptr<Connection>> m_connections;
+
+	mutex						   m_pendingMutex;
+	vector<shared_ptr<Connection>> m_pending; //connections with new frames of the workers
+
+	mutex			   m_jobMutex;
+	condition_variable m_jobReady;
+	deque<Job>		   m_jobs;
+	bool			   m_stop = false;
+	vector<thread>	   m_workers;
+
+	mutex								 m_scriptMutex;
+	unordered_map<string, CachedScript> m_scripts;
+
+	static int			m_wakeFd;
+	static atomic<bool> m_stopRequested;
+};
@@ -0,0 +1,309 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <cstring>
+
+#include "Collections.h"
+#include "Json.h"
+#include "ParserFunction.h"
+#include "Snapshot.h"
+
+const char Snapshot::MAGIC[4] = { 'X', 'E', 'S', 'S' };
+
+string Snapshot::save()
+{
+	unordered_map<string, Variable> globals = ParserFunction::getGlobalValues();
+
+	//sorted, the same globals always give the same snapshot
+	vector<string> names;
+	names.reserve(globals.size());
+	for (auto it = globals.begin(); it != globals.end(); ++it)
+	{
+		names.push_back(it->first);
+	}
+	sort(names.begin(), names.end());
+
+	Writer writer;
+	writer.m_data.append(MAGIC, sizeof(MAGIC));
+	writer.writeSize(VERSION);
+	writer.writeSize(names.size());
+
+	for (const string& name : names)
+	{
+		writer.writeString(name);
+		writer.writeValue(globals[name], name, 0);
+	}
+	return writer.m_data;
+}
+
+void Snapshot::restore(const string& data)
+{
+	if (data.size() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+	{
+		throw ParsingException("Runtime Error: The data is not a snapshot of XecutionScript");
+	}
+
+	Reader reader(data);
+	for (size_t i = 0; i < sizeof(MAGIC); i++)
+	{
+		reader.readByte();
+	}
+
+	size_t version = reader.readSize();
+	if (version != VERSION)
+	{
+		throw ParsingException("Runtime Error: Snapshot version " + to_string(version) + " is not supported, expecting " + to_string(VERSION));
+	}
+
+	unordered_map<string, Variable> globals;
+	size_t count = reader.readSize();
+	for (size_t i = 0; i < count; i++)
+	{
+		string name = reader.readString();
+		globals[name] = reader.readValue(0);
+	}
+	if (!reader.atEnd())
+	{
+		throw ParsingException("Runtime Error: The snapshot has unexpected data after its variables");
+	}
+
+	ParserFunction::setGlobalValues(globals);
+}
+
+//WRITER
+void Snapshot::Writer::writeValue(const Variable& value, const string& name, size_t depth)
+{
+	if (depth > MAX_DEPTH)
+	{
+		throw ParsingException("Runtime Error: Variable [" + name + "] is nested too deep to be saved in a snapshot");
+	}
+
+	if (value.m_object)
+	{
+		auto it = m_objects.find(value.m_object.get());
+		if (it != m_objects.end())
+		{
+			m_data += (char)REFERENCE_TAG;
+			writeSize(it->second);
+			return;
+		}
+	}
+
+	switch (value.m_type)
+	{
+		case Tokens::VOID:
+			m_data += (char)VOID_TAG;
+			return;
+
+		case Tokens::NUMERIC:
+			m_data += (char)NUMBER_TAG;
+			writeNumber(value.m_numericValue);
+			return;
+
+		case Tokens::STRING:
+			m_data += (char)STRING_TAG;
+			writeString(value.m_stringValue);
+			return;
+
+		default:
+			break;
+	}
+
+	//collections get their number before their contents, a reference to itself is found then
+	size_t number = m_objects.size();
+
+	switch (value.m_type)
+	{
+		case Tokens::MAP:
+		{
+			m_objects[value.m_object.get()] = number;
+			ScriptMap* map = value.getMap();
+			m_data += (char)MAP_TAG;
+			writeSize(map->size());
+			for (size_t i = map->nextPosition(0); i != string::npos; i = map->nextPosition(i + 1))
+			{
+				writeValue(map->keyAt(i), name, depth + 1);
+				writeValue(map->valueAt(i), name, depth + 1);
+			}
+			break;
+		}
+
+		case Tokens::ARRAY:
+		{
+			m_objects[value.m_object.get()] = number;
+			ScriptArray* arr = value.getArray();
+			m_data += (char)ARRAY_TAG;
+			writeSize(arr->size());
+			for (size_t i = 0; i < arr->size(); i++)
+			{
+				writeValue(arr->at(i), name, depth + 1);
+			}
+			break;
+		}
+
+		case Tokens::RANGE:
+		{
+			m_objects[value.m_object.get()] = number;
+			ScriptRange* range = static_cast<ScriptRange*>(value.m_object.get());
+			m_data += (char)RANGE_TAG;
+			writeNumber(range->start());
+			writeNumber(range->end());
+			writeNumber(range->step());
+			break;
+		}
+
+		//the text of a JSON value is parsed again, it is read only and can't contain itself
+		case Tokens::JSON:
+			m_objects[value.m_object.get()] = number;
+			m_data += (char)JSON_TAG;
+			writeString(Json::stringify(value));
+			break;
+
+		default:
+			throw ParsingException("Runtime Error: Variable [" + name + "] holds a " + Tokens::typeToString(value.m_type) + ", which can't be saved in a snapshot");
+	}
+}
+
+void Snapshot::Writer::writeSize(size_t size)
+{
+	do
+	{
+		uint8_t byte = size & 0x7F;
+		size >>= 7;
+		m_data += (char)(size != 0 ? byte | 0x80 : byte);
+	}
+	while (size != 0);
+}
+
+void Snapshot::Writer::writeNumber(double number)
+{
+	char bytes[sizeof(double)];
+	memcpy(bytes, &number, sizeof(double));
+	m_data.append(bytes, sizeof(double));
+}
+
+void Snapshot::Writer::writeString(const string& text)
+{
+	writeSize(text.size());
+	m_data += text;
+}
+
+//READER
+Variable Snapshot::Reader::readValue(size_t depth)
+{
+	if (depth > MAX_DEPTH)
+	{
+		throw ParsingException("Runtime Error: The snapshot is corrupt, the values are nested too deep");
+	}
+
+	uint8_t tag = readByte();
+	switch (tag)
+	{
+		case VOID_TAG:		return Variable::emptyInstance;
+		case NUMBER_TAG:	return Variable(readNumber());
+		case STRING_TAG:	return Variable(readString());
+
+		case MAP_TAG:
+		{
+			shared_ptr<ScriptMap> map = make_shared<ScriptMap>();
+			Variable result(Tokens::MAP, map);
+			m_objects.push_back(result);
+
+			size_t count = readSize();
+			for (size_t i = 0; i < count; i++)
+			{
+				Variable key = readValue(depth + 1);
+				map->set(key, readValue(depth + 1));
+			}
+			return result;
+		}
+
+		case ARRAY_TAG:
+		{
+			shared_ptr<ScriptArray> arr = make_shared<ScriptArray>();
+			Variable result(Tokens::ARRAY, arr);
+			m_objects.push_back(result);
+
+			size_t count = readSize();
+			arr->items().reserve(min(count, m_data.size() - m_position));
+			for (size_t i = 0; i < count; i++)
+			{
+				arr->push(readValue(depth + 1));
+			}
+			return result;
+		}
+
+		case RANGE_TAG:
+		{
+			double start = readNumber();
+			double end = readNumber();
+			double step = readNumber();
+			m_objects.push_back(Variable(Tokens::RANGE, make_shared<ScriptRange>(start, end, step)));
+			return m_objects.back();
+		}
+
+		case JSON_TAG:
+			m_objects.push_back(Json::parse(readString()));
+			return m_objects.back();
+
+		case REFERENCE_TAG:
+		{
+			size_t number = readSize();
+			if (number >= m_objects.size())
+			{
+				throw ParsingException("Runtime Error: The snapshot is corrupt, it refers to an unknown collection");
+			}
+			return m_objects[number];
+		}
+
+		default:
+			throw ParsingException("Runtime Error: The snapshot is corrupt, unknown value tag " + to_string(tag));
+	}
+}
+
+size_t Snapshot::Reader::readSize()
+{
+	size_t size = 0;
+	for (size_t shift = 0; shift < 64; shift += 7)
+	{
+		uint8_t byte = readByte();
+		size |= (size_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return size;
+		}
+	}
+	throw ParsingException("Runtime Error: The snapshot is corrupt, a size is too long");
+}
+
+double Snapshot::Reader::readNumber()
+{
+	check(sizeof(double));
+	double number;
+	memcpy(&number, m_data.data() + m_position, sizeof(double));
+	m_position += sizeof(double);
+	return number;
+}
+
+string Snapshot::Reader::readString()
+{
+	size_t size = readSize();
+	check(size);
+	string text = m_data.substr(m_position, size);
+	m_position += size;
+	return text;
+}
+
+uint8_t Snapshot::Reader::readByte()
+{
+	check(1);
+	return (uint8_t)m_data[m_position++];
+}
+
+void Snapshot::Reader::check(size_t bytes) const
+{
+	if (bytes > m_data.size() - m_position)
+	{
+		throw ParsingException("Runtime Error: The snapshot is corrupt, it ends too early");
+	}
+}
@@ -0,0 +1,81 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <unordered_map>
+
+#include "Variable.h"
+
+/*
+*  Binary snapshot of the global variables of a thread, e.g. the tables
+*  a preamble computed, so that later runs can start from them right away.
+*  Builtins and host bindings aren't part of it, initialize() and the
+*  host register them in every interpreter anyway.
+*  Lengths and counts are written as LEB128 varints and numbers as their
+*  8 bytes, a collection that is referenced from several places (or from
+*  itself) is written once and referred to by its number afterwards, so
+*  it is still shared after a restore. Tasks, channels, files and CSV rows
+*  belong to the running process and can't be saved.
+*/
+class Snapshot
+{
+public:
+	static const uint32_t VERSION = 1;
+
+	//collections nested deeper are not written, and a snapshot with such values is corrupt
+	static const size_t MAX_DEPTH = 1024;
+
+	//the snapshot of the globals of the calling thread
+	static string save();
+
+	//replaces the globals of the calling thread with those of the snapshot
+	static void restore(const string& data);
+
+private:
+	enum Tag : uint8_t
+	{
+		VOID_TAG,
+		NUMBER_TAG,
+		STRING_TAG,
+		MAP_TAG,
+		ARRAY_TAG,
+		RANGE_TAG,
+		JSON_TAG,
+		REFERENCE_TAG //a collection that was written before
+	};
+
+	class Writer
+	{
+	public:
+		void writeValue(const Variable& value, const string& name, size_t depth);
+		void writeSize(size_t size);
+		void writeNumber(double number);
+		void writeString(const string& text);
+
+		string m_data;
+		unordered_map<const void*, size_t> m_objects;
+	};
+
+	class Reader
+	{
+	public:
+		Reader(const string& data) : m_data(data) {}
+
+		Variable readValue(size_t depth);
+		size_t readSize();
+		double readNumber();
+		string readString();
+		uint8_t readByte();
+
+		bool atEnd() const { return m_position == m_data.size(); }
+
+	private:
+		void check(size_t bytes) const;
+
+		const string& m_data;
+		size_t m_position = 0;
+		vector<Variable> m_objects;
+	};
+
+	static const char MAGIC[4];
+};
@@ -0,0 +1,119 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "RuntimeStats.h"
+#include "ScriptHelper.h"
+#include "ThreadPool.h"
+
+size_t ThreadPool::m_defaultSize = 0;
+thread_local bool ThreadPool::m_isWorker = false;
+
+ThreadPool::ThreadPool(size_t threadCount) : m_nextTask(0)
+{
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wakeUp.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+ThreadPool& ThreadPool::getDefault()
+{
+	//never deleted, the workers might still be blocked when the process exits
+	static ThreadPool* pool = new ThreadPool(m_defaultSize > 0 ? m_defaultSize : thread::hardware_concurrency());
+	return *pool;
+}
+
+void ThreadPool::run(size_t taskCount, const function<void(size_t)>& task)
+{
+	if (taskCount == 0)
+	{
+		return;
+	}
+
+	lock_guard<mutex> runLock(m_runMutex);
+	unique_lock<mutex> lock(m_mutex);
+
+	m_task = &task;
+	m_taskCount = taskCount;
+	m_nextTask = 0;
+	m_running = m_threads.size();
+	m_error = nullptr;
+	m_recoverable = ParsingException::isRecoverable();
+	m_generation++;
+
+	m_wakeUp.notify_all();
+	m_done.wait(lock, [this] { return m_running == 0; });
+
+	m_task = nullptr;
+	if (m_error)
+	{
+		rethrow_exception(m_error);
+	}
+}
+
+void ThreadPool::work()
+{
+	m_isWorker = true;
+	RuntimeStats::registerThread();
+	size_t generation = 0;
+
+	while (true)
+	{
+		const function<void(size_t)>* task;
+		size_t taskCount;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_wakeUp.wait(lock, [&] { return m_stop || m_generation != generation; });
+
+			if (m_stop)
+			{
+				return;
+			}
+			generation = m_generation;
+			task = m_task;
+			taskCount = m_taskCount;
+			ParsingException::setRecoverable(m_recoverable);
+		}
+
+		size_t index;
+		while ((index = m_nextTask++) < taskCount)
+		{
+			try
+			{
+				(*task)(index);
+			}
+			catch (...)
+			{
+				lock_guard<mutex> lock(m_mutex);
+				if (!m_error)
+				{
+					m_error = current_exception();
+				}
+			}
+		}
+
+		lock_guard<mutex> lock(m_mutex);
+		if (--m_running == 0)
+		{
+			m_done.notify_all();
+		}
+	}
+}
@@ -0,0 +1,58 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Tokens.h"
+
+/*
+*  Fixed set of worker threads used by pfor.
+*  run() hands out the task indices 0..taskCount-1 to the workers
+*  and blocks the calling thread until all of them are done.
+*  Only one run() is active at a time, other callers wait for it.
+*/
+class ThreadPool
+{
+public:
+	ThreadPool(size_t threadCount);
+	~ThreadPool();
+
+	size_t size() const { return m_threads.size(); }
+
+	void run(size_t taskCount, const function<void(size_t)>& task);
+
+	//pool shared by all pfor loops, created on first use
+	static ThreadPool& getDefault();
+	static void setDefaultSize(size_t threadCount) { m_defaultSize = threadCount; }
+
+	//true on the threads of any pool
+	static bool isWorker() { return m_isWorker; }
+
+private:
+	void work();
+
+	vector<thread> m_threads;
+
+	mutex m_runMutex; //run() is called by several threads at once, e.g. by the workers of --serve
+	mutex m_mutex;
+	condition_variable m_wakeUp;
+	condition_variable m_done;
+
+	const function<void(size_t)>* m_task = nullptr;
+	size_t m_taskCount = 0;
+	atomic<size_t> m_nextTask;
+	size_t m_running = 0;	 //workers that didn't finish the current run yet
+	size_t m_generation = 0; //incremented with every run
+	exception_ptr m_error;
+	bool m_recoverable = false; //errors of the calling thread are recoverable, so are those of the workers
+	bool m_stop = false;
+
+	static size_t m_defaultSize;
+	static thread_local bool m_isWorker;
+};
@@ -31,14 +31,67 @@ const string Tokens::ELSE		= "else";
 const string Tokens::ELSE_IF	= "eif";
 const string Tokens::EXIT		= "exit";
 const string Tokens::FOR		= "for";
+const string Tokens::PARALLEL_FOR	= "pfor";
 const string Tokens::FUNCTION	= "function";
 const string Tokens::RETURN		= "return";
+const string Tokens::SIZE		= "size";
 const string Tokens::WHILE		= "while";
 const string Tokens::TYPE		= "typeof";
 
 //GENERAL BUILT IN FUNCTIONS
 const string Tokens::PRINT		= "print";
 
+//COLLECTION FUNCTIONS
+const string Tokens::CREATE_MAP	= "map";
+const string Tokens::CREATE_ARRAY	= "array";
+const string Tokens::CREATE_RANGE	= "range";
+const string Tokens::PUSH		= "push";
+const string Tokens::CONTAINS	= "contains";
+const string Tokens::REMOVE		= "remove";
+
+//TASK FUNCTIONS
+const string Tokens::SPAWN		= "spawn";
+const string Tokens::YIELD		= "yield";
+const string Tokens::SLEEP		= "sleep";
+const string Tokens::AWAIT		= "await";
+
+//MATH FUNCTIONS
+const string Tokens::ABS		= "abs";
+const string Tokens::SQRT		= "sqrt";
+const string Tokens::FLOOR		= "floor";
+const string Tokens::CEIL		= "ceil";
+const string Tokens::ROUND		= "round";
+
+//CHANNEL FUNCTIONS
+const string Tokens::CREATE_CHANNEL	= "channel";
+const string Tokens::SEND		= "send";
+const string Tokens::RECV		= "recv";
+const string Tokens::TRY_RECV	= "tryRecv";
+const string Tokens::CLOSE		= "close";
+
+//FILE FUNCTIONS
+const string Tokens::OPEN		= "open";
+const string Tokens::READ_LINE	= "readLine";
+const string Tokens::READ_ALL	= "readAll";
+const string Tokens::WRITE		= "write";
+const string Tokens::WRITE_LINE	= "writeLine";
+const string Tokens::CSV_READ	= "csvRead";
+const string Tokens::CSV_ROWS	= "csvRows";
+
+//JSON FUNCTIONS
+const string Tokens::JSON_PARSE		= "jsonParse";
+const string Tokens::JSON_STRINGIFY	= "jsonStringify";
+
+//REDUCTIONS OF A PFOR LOOP
+const string Tokens::REDUCE_SUM	= "sum";
+const string Tokens::REDUCE_MIN	= "min";
+const string Tokens::REDUCE_MAX	= "max";
+
+//VARIABLES OF A RECORD OF --each-line
+const string Tokens::RECORD_LINE	= "line";
+const string Tokens::RECORD_FIELDS	= "fields";
+const string Tokens::RECORD_NUMBER	= "NR";
+
 vector<string> Tokens::FUNCTION_WITH_SPACE = { };
 vector<string> Tokens::FUNCTION_WITH_SPACE_ONCE = { RETURN };
 
@@ -97,6 +150,14 @@ string Tokens::typeToString(Type type)
 	{
 		case NUMERIC:				return "NUMERIC";
 		case STRING:				return "STRING";
+		case MAP:					return "MAP";
+		case ARRAY:					return "ARRAY";
+		case RANGE:					return "RANGE";
+		case TASK:					return "TASK";
+		case CHANNEL:				return "CHANNEL";
+		case FILE:					return "FILE";
+		case ROWS:					return "ROWS";
+		case JSON:					return "JSON";
 		case BREAK_STATEMENT:		return "BREAK";
 		case CONTINUE_STATEMENT:	return "CONTINUE";
 		default:					return "VOID";
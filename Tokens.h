@@ -19,11 +19,18 @@ public:
 		VOID,
 		NUMERIC,
 		STRING,
+		MAP,
+		ARRAY,
+		RANGE,
+		TASK,
+		CHANNEL,
+		FILE,
+		ROWS,
+		JSON,
 		BREAK_STATEMENT,
 		CONTINUE_STATEMENT
 	};
 
-	static const size_t MAX_LOOPS		  = 100000;
 	static const size_t MAX_CHARS_TO_SHOW = 40;
 
 	//BASIC CHARS
@@ -31,6 +38,8 @@ public:
 	static const char END_ARG		= ')';
 	static const char START_GROUP	= '{';
 	static const char END_GROUP		= '}';
+	static const char START_ARRAY	= '[';
+	static const char END_ARRAY		= ']';
 	static const char NEXT_ARG		= ',';
 	static const char END_LINE		= '\n';
 	static const char NULL_CHAR		= '\0';
@@ -67,6 +76,7 @@ public:
 	static const string ELSE_IF;
 	static const string EXIT;
 	static const string FOR;
+	static const string PARALLEL_FOR;
 	static const string FUNCTION;
 	static const string INCLUDE;
 	static const string RETURN;
@@ -77,6 +87,57 @@ public:
 	static const string PRINT;
 	static const string TYPE;
 
+	//COLLECTION FUNCTIONS
+	static const string CREATE_MAP;
+	static const string CREATE_ARRAY;
+	static const string CREATE_RANGE;
+	static const string PUSH;
+	static const string CONTAINS;
+	static const string REMOVE;
+
+	//TASK FUNCTIONS
+	static const string SPAWN;
+	static const string YIELD;
+	static const string SLEEP;
+	static const string AWAIT;
+
+	//MATH FUNCTIONS
+	static const string ABS;
+	static const string SQRT;
+	static const string FLOOR;
+	static const string CEIL;
+	static const string ROUND;
+
+	//CHANNEL FUNCTIONS
+	static const string CREATE_CHANNEL;
+	static const string SEND;
+	static const string RECV;
+	static const string TRY_RECV;
+	static const string CLOSE;
+
+	//FILE FUNCTIONS
+	static const string OPEN;
+	static const string READ_LINE;
+	static const string READ_ALL;
+	static const string WRITE;
+	static const string WRITE_LINE;
+	static const string CSV_READ;
+	static const string CSV_ROWS;
+
+	//JSON FUNCTIONS
+	static const string JSON_PARSE;
+	static const string JSON_STRINGIFY;
+
+	//REDUCTIONS OF A PFOR LOOP
+	static const string REDUCE_SUM;
+	static const string REDUCE_MIN;
+	static const string REDUCE_MAX;
+
+	//VARIABLES OF A RECORD OF --each-line
+	static const string RECORD_LINE;
+	static const string RECORD_FIELDS;
+	static const string RECORD_NUMBER;
+
 	static const vector<string> ACTIONS;
 	static const vector<string> MATH_ACTIONS;
 	static const vector<string> OPERATOR_ACTIONS;
@@ -0,0 +1,203 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "ScriptHelper.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
+
+atomic<bool> Tracer::m_enabled(false);
+chrono::steady_clock::time_point Tracer::m_start;
+atomic<size_t> Tracer::m_nextThread(1);
+
+mutex Tracer::m_mutex;
+ofstream Tracer::m_file;
+vector<unique_ptr<Tracer::TraceBuffer>> Tracer::m_buffers;
+
+thread_local Tracer::TraceBuffer* Tracer::m_buffer = nullptr;
+thread_local size_t Tracer::m_thread = 0;
+thread_local const TraceScript* Tracer::m_script = nullptr;
+
+void Tracer::start(const string& filename)
+{
+	if (m_enabled)
+	{
+		return;
+	}
+
+	m_file.open(filename, ios::out | ios::trunc);
+	if (!m_file)
+	{
+		throw ParsingException("Could not write the trace to [" + filename + "]");
+	}
+
+	m_file << "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"XecutionScript\"}}";
+	m_start = chrono::steady_clock::now();
+	m_enabled = true;
+
+	//errors end the process with exit(), the trace is still completed then
+	static bool registered = false;
+	if (!registered)
+	{
+		registered = true;
+		atexit(stop);
+	}
+}
+
+void Tracer::stop()
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+	m_enabled = false;
+
+	//the other threads are expected to be idle by now
+	lock_guard<mutex> lock(m_mutex);
+	for (const unique_ptr<TraceBuffer>& buffer : m_buffers)
+	{
+		m_file << buffer->data;
+		buffer->data.clear();
+	}
+
+	m_file << "\n]\n";
+	m_file.close();
+}
+
+const TraceScript* Tracer::setScript(const TraceScript* script)
+{
+	const TraceScript* previous = m_script;
+	m_script = script;
+	return previous;
+}
+
+string Tracer::getStatement(size_t offset)
+{
+	static const size_t MAX_LENGTH = 80;
+
+	size_t line = m_script != nullptr ? m_script->index.getLine(offset) : string::npos;
+	if (line == string::npos || line >= m_script->source.size())
+	{
+		return "statement";
+	}
+
+	string text = ScriptHelper::trim(m_script->source[line]);
+	if (text.size() > MAX_LENGTH)
+	{
+		text = text.substr(0, MAX_LENGTH) + "...";
+	}
+	return text;
+}
+
+void Tracer::swapThread(size_t& id)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	//the thread itself needs its id before it is exchanged
+	getBuffer();
+	if (id == 0)
+	{
+		id = newThread("task");
+	}
+	swap(m_thread, id);
+}
+
+Tracer::TraceBuffer& Tracer::getBuffer()
+{
+	if (m_buffer == nullptr)
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_buffers.emplace_back(new TraceBuffer());
+			m_buffer = m_buffers.back().get();
+		}
+		m_buffer->data.reserve(BUFFER_SIZE);
+		m_thread = newThread(ThreadPool::isWorker() ? "worker" : "main");
+	}
+
+	return *m_buffer;
+}
+
+size_t Tracer::newThread(const string& name)
+{
+	size_t id = m_nextThread++;
+
+	string& out = getBuffer().data;
+	out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+	out += to_string(id);
+	out += ",\"args\":{\"name\":\"";
+	out += name;
+	out += "\"}}";
+
+	return id;
+}
+
+void Tracer::write(char phase, const string& name, const char* category, size_t offset)
+{
+	TraceBuffer& buffer = getBuffer();
+	string& out = buffer.data;
+
+	char timestamp[32];
+	snprintf(timestamp, sizeof(timestamp), "%.3f", chrono::duration<double, micro>(chrono::steady_clock::now() - m_start).count());
+
+	out += ",\n{";
+	if (phase == 'B')
+	{
+		out += "\"name\":\"";
+		appendEscaped(out, name);
+		out += "\",\"cat\":\"";
+		out += category;
+		out += "\",";
+	}
+	out += "\"ph\":\"";
+	out += phase;
+	out += "\",\"ts\":";
+	out += timestamp;
+	out += ",\"pid\":1,\"tid\":";
+	out += to_string(m_thread);
+
+	size_t line = offset != string::npos && m_script != nullptr ? m_script->index.getLine(offset) : string::npos;
+	if (line != string::npos)
+	{
+		out += ",\"args\":{\"line\":";
+		out += to_string(line + 1);
+		out += "}";
+	}
+	out += "}";
+
+	if (out.size() >= BUFFER_SIZE)
+	{
+		flush(buffer);
+	}
+}
+
+void Tracer::flush(TraceBuffer& buffer)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_file << buffer.data;
+	buffer.data.clear();
+}
+
+void Tracer::appendEscaped(string& out, const string& text)
+{
+	for (char ch : text)
+	{
+		if (ch == '"' || ch == '\\')
+		{
+			out += '\\';
+			out += ch;
+		}
+		else if ((unsigned char)ch < 0x20)
+		{
+			out += ' ';
+		}
+		else
+		{
+			out += ch;
+		}
+	}
+}
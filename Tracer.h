@@ -0,0 +1,138 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "ParsingScript.h"
+
+//the script whose lines are used for the events of a thread
+struct TraceScript
+{
+	LineIndex	   index;
+	vector<string> source;
+};
+
+/*
+*  Writes the trace of --trace in the Chrome trace event format, it can be
+*  opened in chrome://tracing or Perfetto. There are begin and end events
+*  for the phases of the interpreter, the top level statements, the control
+*  statements and the builtin functions, each with its script line.
+*  Every thread appends its events to its own buffer, which is written to
+*  the file once it is full, so the file is only locked once in a while.
+*  Script tasks show up as threads of their own.
+*/
+class Tracer
+{
+public:
+	static const size_t BUFFER_SIZE = 64 * 1024;
+
+	static void start(const string& filename);
+
+	//writes the remaining events and closes the file
+	static void stop();
+
+	static bool isEnabled() { return m_enabled; }
+
+	static inline void begin(const string& name, const char* category, size_t offset = string::npos)
+	{
+		if (m_enabled.load(memory_order_relaxed))
+		{
+			write('B', name, category, offset);
+		}
+	}
+
+	//event of a top level statement, named after its source line
+	static inline void beginStatement(size_t offset)
+	{
+		if (m_enabled.load(memory_order_relaxed))
+		{
+			write('B', getStatement(offset), "statement", offset);
+		}
+	}
+
+	static inline void end()
+	{
+		if (m_enabled.load(memory_order_relaxed))
+		{
+			write('E', Tokens::EMPTY, nullptr, string::npos);
+		}
+	}
+
+	//the script of the calling thread, returns the previous one
+	static const TraceScript* setScript(const TraceScript* script);
+	static const TraceScript* getScript() { return m_script; }
+
+	//every script task is traced as a thread of its own, the id is assigned on the first switch
+	static void swapThread(size_t& id);
+
+private:
+	struct TraceBuffer
+	{
+		string data;
+	};
+
+	static void write(char phase, const string& name, const char* category, size_t offset);
+	static string getStatement(size_t offset);
+	static void flush(TraceBuffer& buffer);
+	static TraceBuffer& getBuffer();
+	static size_t newThread(const string& name);
+	static void appendEscaped(string& out, const string& text);
+
+	static atomic<bool> m_enabled; //switched by the main thread while workers write events
+	static chrono::steady_clock::time_point m_start;
+	static atomic<size_t> m_nextThread;
+
+	static mutex m_mutex;
+	static ofstream m_file;
+	static vector<unique_ptr<TraceBuffer>> m_buffers;
+
+	static thread_local TraceBuffer* m_buffer;
+	static thread_local size_t m_thread;
+	static thread_local const TraceScript* m_script;
+};
+
+/*
+*  The begin and end event of a scope, the end is also written when an
+*  error leaves the scope, so every begin event of a thread gets closed.
+*/
+class TraceScope
+{
+public:
+	TraceScope(const string& name, const char* category, size_t offset = string::npos) :
+		m_active(Tracer::isEnabled())
+	{
+		if (m_active)
+		{
+			Tracer::begin(name, category, offset);
+		}
+	}
+
+	//a top level statement, see Tracer::beginStatement()
+	explicit TraceScope(size_t offset) :
+		m_active(Tracer::isEnabled())
+	{
+		if (m_active)
+		{
+			Tracer::beginStatement(offset);
+		}
+	}
+
+	~TraceScope()
+	{
+		if (m_active)
+		{
+			Tracer::end();
+		}
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	bool m_active;
+};
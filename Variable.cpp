@@ -1,7 +1,11 @@
 //NOTE: project was based on https://github.com/vassilych/cscscpp
 
 #include <algorithm>
+#include <cmath>
 
+#include "Channel.h"
+#include "Collections.h"
+#include "File.h"
 #include "ScriptHelper.h"
 #include "Variable.h"
 
@@ -21,9 +25,51 @@ string Variable::toString() const
 	{
 		return ScriptHelper::isInt(m_numericValue) ? to_string((long long)m_numericValue) : to_string(m_numericValue);
 	}
+	if (m_object) 
+	{
+		return m_object->toString();
+	}
 	return "";
 }
 
+ScriptMap* Variable::getMap() const
+{
+	return m_type == Tokens::MAP ? static_cast<ScriptMap*>(m_object.get()) : nullptr;
+}
+
+ScriptArray* Variable::getArray() const
+{
+	return m_type == Tokens::ARRAY ? static_cast<ScriptArray*>(m_object.get()) : nullptr;
+}
+
+ScriptChannel* Variable::getChannel() const
+{
+	return m_type == Tokens::CHANNEL ? static_cast<ScriptChannel*>(m_object.get()) : nullptr;
+}
+
+ScriptFile* Variable::getFile() const
+{
+	return m_type == Tokens::FILE ? static_cast<ScriptFile*>(m_object.get()) : nullptr;
+}
+
+Variable Variable::getElement(const Variable& index) const
+{
+	if (!m_object) 
+	{
+		throw ParsingException("Semantic Error: Value [" + toString() + "] can't be indexed!");
+	}
+	return m_object->getElement(index);
+}
+
+void Variable::setElement(const Variable& index, const Variable& value)
+{
+	if (!m_object) 
+	{
+		throw ParsingException("Semantic Error: Value [" + toString() + "] can't be indexed!");
+	}
+	m_object->setElement(index, value);
+}
+
 bool Variable::canMergeWith(const Variable& right) 
 {
 	return getPriority(m_action) >= getPriority(right.getAction());
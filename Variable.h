@@ -2,24 +2,39 @@
 
 #pragma once
 #include "Tokens.h"
+#include <memory>
 #include <vector>
 #include <string>
 
 using namespace std;
 
 class Parser;
+class ScriptObject;
+class ScriptMap;
+class ScriptArray;
+class ScriptChannel;
+class ScriptFile;
 
 class Variable
 {
 public:
 	Variable() : m_type(Tokens::VOID) {}
 
-	Variable(double value) : m_type(Tokens::NUMERIC), m_numericValue(value) {}
+	Variable(double value) : m_numericValue(value), m_type(Tokens::NUMERIC) {}
 
-	Variable(string stringvalue) : m_type(Tokens::STRING), m_stringValue(stringvalue) {}
+	Variable(string stringvalue) : m_stringValue(move(stringvalue)), m_type(Tokens::STRING) {}
 
 	Variable(Tokens::Type type) : m_type(type) {}
 
+	//collections (MAP, ARRAY, RANGE) are shared by reference between all variables holding them
+	Variable(Tokens::Type type, const shared_ptr<ScriptObject>& object) : m_object(object), m_type(type) {}
+
+	//the virtual destructor would otherwise suppress moving, e.g. when a vector of fields grows
+	Variable(const Variable&) = default;
+	Variable(Variable&&) = default;
+	Variable& operator=(const Variable&) = default;
+	Variable& operator=(Variable&&) = default;
+
 	virtual ~Variable() {}
 
 	void set(const string& str) { m_stringValue = str; m_type = Tokens::STRING; }
@@ -28,6 +43,14 @@ public:
 	const string& getAction() const { return m_action; }
 	Tokens::Type getType() const { return m_type; }
 
+	ScriptMap* getMap() const;
+	ScriptArray* getArray() const;
+	ScriptChannel* getChannel() const;
+	ScriptFile* getFile() const;
+
+	Variable getElement(const Variable& index) const;
+	void setElement(const Variable& index, const Variable& value);
+
 	string toString() const;
 
 	bool canMergeWith(const Variable& right);
@@ -46,6 +69,7 @@ public:
 	//Value related members
 	double			 m_numericValue = 0.0;  //NUMERICS have initial value of 0.0
 	string			 m_stringValue;
+	shared_ptr<ScriptObject> m_object;	//MAP, ARRAY, RANGE, TASK and CHANNEL values
 
 	//Variable information related members
 	string			 m_action;
@@ -0,0 +1,512 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <dirent.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "Interpreter.h"
+#include "Parser.h"
+#include "RuntimeStats.h"
+
+/*
+*  Benchmarks of the interpreter: microbenchmarks of its hot functions and
+*  the .xes scripts of the corpus. Every result is one JSON object per line
+*  on stdout, so the output of a run can be kept as the baseline of later
+*  ones:
+*    xes_bench > baseline.jsonl
+*    xes_bench --compare baseline.jsonl
+*  Output of the scripts is discarded, printing still gets formatted.
+*  With --count the runtime counters are reported instead of the time.
+*  They are exact, so --compare lists every counter that changed no
+*  matter how busy the machine is.
+*/
+
+struct BenchmarkResult
+{
+	string name;
+	size_t iterations = 0;
+	double nsPerOp = 0;
+	double allocsPerOp = 0;
+	double statementsPerSec = 0; //only for scripts of the corpus
+	vector<double> counts;		 //per operation, in the order of m_counters
+};
+
+//counters that are reported by --count
+static const vector<pair<string, size_t RuntimeCounters::*>> m_counters =
+{
+	{ "statements", &RuntimeCounters::statements },
+	{ "expressions", &RuntimeCounters::expressions },
+	{ "tokens", &RuntimeCounters::tokens },
+	{ "characters", &RuntimeCounters::characters },
+	{ "nodes", &RuntimeCounters::nodes },
+	{ "lookups", &RuntimeCounters::lookups },
+	{ "lookup_misses", &RuntimeCounters::lookupMisses },
+	{ "allocations", &RuntimeCounters::allocations },
+	{ "allocated_bytes", &RuntimeCounters::allocatedBytes },
+	{ "replacements", &RuntimeCounters::replacements },
+	{ "string_bytes", &RuntimeCounters::stringBytes },
+};
+
+//operations of a microbenchmark in --count mode, a script is run once
+static const size_t COUNT_ITERATIONS = 1000;
+
+//keeps the results of the microbenchmarks alive so that they aren't optimized away
+static double m_sink = 0;
+
+static size_t m_minTimeMs = 300;
+static size_t m_runs = 3; //the fastest run of a script is reported
+static bool m_count = false;
+static string m_filter;
+
+class NullBuffer : public streambuf
+{
+protected:
+	virtual int overflow(int ch) { return ch; }
+	virtual streamsize xsputn(const char*, streamsize count) { return count; }
+};
+
+//runs the operation a fixed number of times after a first one that fills the caches
+BenchmarkResult count(const string& name, const function<void()>& operation, size_t iterations)
+{
+	BenchmarkResult result;
+	result.name = name;
+	result.iterations = iterations;
+
+	operation();
+
+	RuntimeCounters before = RuntimeStats::local();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		operation();
+	}
+	RuntimeCounters after = RuntimeStats::local();
+
+	for (const auto& counter : m_counters)
+	{
+		result.counts.push_back((double)(after.*counter.second - before.*counter.second) / iterations);
+	}
+	return result;
+}
+
+//runs the operation in rounds of growing size until a round took at least m_minTimeMs
+BenchmarkResult measure(const string& name, const function<void()>& operation)
+{
+	BenchmarkResult result;
+	result.name = name;
+
+	size_t iterations = 1;
+	while (true)
+	{
+		RuntimeCounters before = RuntimeStats::local();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		for (size_t i = 0; i < iterations; i++)
+		{
+			operation();
+		}
+
+		double elapsedNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+		RuntimeCounters after = RuntimeStats::local();
+
+		if (elapsedNs >= m_minTimeMs * 1e6 || iterations >= ((size_t)1 << 32))
+		{
+			result.iterations = iterations;
+			result.nsPerOp = elapsedNs / iterations;
+			result.allocsPerOp = (double)(after.allocations - before.allocations) / iterations;
+			result.statementsPerSec = (after.statements - before.statements) / (elapsedNs / 1e9);
+			return result;
+		}
+
+		//aims at 1.5 times the minimum time for the next round
+		double target = elapsedNs > 0 ? m_minTimeMs * 1.5e6 / elapsedNs * iterations : iterations * 10.0;
+		iterations = max(iterations * 2, min((size_t)target, iterations * 100));
+	}
+}
+
+//counts are written in full, a rounded count could hide a change
+string formatCount(double count)
+{
+	ostringstream out;
+	out << fixed << setprecision(count == floor(count) ? 0 : 3) << count;
+	return out.str();
+}
+
+void print(const BenchmarkResult& result, bool isScript)
+{
+	cout << "{\"name\":\"" << result.name << "\""
+		 << ",\"iterations\":" << result.iterations;
+	if (m_count)
+	{
+		for (size_t i = 0; i < m_counters.size(); i++)
+		{
+			cout << ",\"" << m_counters[i].first << "\":" << formatCount(result.counts[i]);
+		}
+		cout << "}" << endl;
+		return;
+	}
+
+	cout
+		 << ",\"ns_per_op\":" << result.nsPerOp
+		 << ",\"ops_per_sec\":" << (result.nsPerOp > 0 ? 1e9 / result.nsPerOp : 0)
+		 << ",\"allocs_per_op\":" << result.allocsPerOp;
+	if (isScript)
+	{
+		cout << ",\"statements_per_sec\":" << result.statementsPerSec;
+	}
+	cout << "}" << endl;
+}
+
+bool selected(const string& name)
+{
+	return m_filter.empty() || name.find(m_filter) != string::npos;
+}
+
+void runMicro(vector<BenchmarkResult>& results, const string& name, const function<void()>& operation)
+{
+	if (!selected("micro/" + name))
+	{
+		return;
+	}
+	results.push_back(m_count ? count("micro/" + name, operation, COUNT_ITERATIONS) : measure("micro/" + name, operation));
+	print(results.back(), false);
+}
+
+void runMicrobenchmarks(vector<BenchmarkResult>& results)
+{
+	ParserFunction::assignVariable("x", Variable(3.0));
+	ParserFunction::assignVariable("y", Variable(4.0));
+	ParserFunction::assignVariable("counter", Variable(0.0));
+
+	ParsingScript constants("1+2*3-4/2;");
+	runMicro(results, "loadAndCalculate/constants", [&]()
+	{
+		constants.setPointer(0);
+		m_sink += Parser::loadAndCalculate(constants, Tokens::END_PARSING_STR).m_numericValue;
+	});
+
+	ParsingScript variables("x*2+y-x/y;");
+	runMicro(results, "loadAndCalculate/variables", [&]()
+	{
+		variables.setPointer(0);
+		m_sink += Parser::loadAndCalculate(variables, Tokens::END_PARSING_STR).m_numericValue;
+	});
+
+	runMicro(results, "merge/numbers", []()
+	{
+		Variable left(1.5);
+		left.m_action = "*";
+		left.merge(Variable(2.5));
+		m_sink += left.m_numericValue;
+	});
+
+	Variable suffix(string("world"));
+	runMicro(results, "merge/strings", [&]()
+	{
+		Variable left(string("hello "));
+		left.m_action = "+";
+		left.merge(suffix);
+		m_sink += left.m_stringValue.size();
+	});
+
+	string source =
+		"total = 0;\n"
+		"for (i = 0; i < 10; i++)\n"
+		"{\n"
+		"    // accumulate the squares\n"
+		"    total = total + i * i;\n"
+		"    if (total > 100)\n"
+		"    {\n"
+		"        print(\"large \", total);\n"
+		"    }\n"
+		"}\n"
+		"message = \"done with \" + total;\n";
+	runMicro(results, "convertToScript", [&]()
+	{
+		unordered_map<size_t, size_t> char2Line;
+		m_sink += ScriptHelper::convertToScript(source, char2Line).size();
+	});
+
+	runMicro(results, "getFunction/variable", []()
+	{
+		m_sink += ParserFunction::getFunction("x") != nullptr;
+	});
+
+	runMicro(results, "getFunction/builtin", []()
+	{
+		m_sink += ParserFunction::getFunction(Tokens::PRINT) != nullptr;
+	});
+
+	runMicro(results, "getFunction/miss", []()
+	{
+		m_sink += ParserFunction::getFunction("missing") != nullptr;
+	});
+
+	ParsingScript assign("counter = counter + 1;");
+	runMicro(results, "assign", [&]()
+	{
+		assign.setPointer(0);
+		m_sink += Parser::loadAndCalculate(assign, Tokens::END_PARSING_STR).m_numericValue;
+	});
+
+	ParsingScript increment("counter++;");
+	runMicro(results, "increment", [&]()
+	{
+		increment.setPointer(0);
+		m_sink += Parser::loadAndCalculate(increment, Tokens::END_PARSING_STR).m_numericValue;
+	});
+}
+
+vector<string> findScripts(const string& directory)
+{
+	vector<string> scripts;
+
+	DIR* dir = opendir(directory.c_str());
+	if (dir == nullptr)
+	{
+		throw ParsingException("Could not open the benchmark corpus [" + directory + "]");
+	}
+
+	while (dirent* entry = readdir(dir))
+	{
+		string name = entry->d_name;
+		if (name.size() > 4 && name.compare(name.size() - 4, 4, ".xes") == 0)
+		{
+			scripts.push_back(directory + "/" + name);
+		}
+	}
+	closedir(dir);
+
+	sort(scripts.begin(), scripts.end());
+	return scripts;
+}
+
+void runCorpus(vector<BenchmarkResult>& results, const string& directory)
+{
+	for (const string& path : findScripts(directory))
+	{
+		size_t start = path.find_last_of('/') + 1;
+		string name = "corpus/" + path.substr(start, path.size() - start - 4);
+		if (!selected(name))
+		{
+			continue;
+		}
+
+		string script = ScriptHelper::readScriptFile(path);
+
+		NullBuffer null;
+		streambuf* output = cout.rdbuf(&null);
+
+		BenchmarkResult result;
+		for (size_t run = 0; run < (m_count ? 0 : m_runs); run++)
+		{
+			BenchmarkResult current = measure(name, [&]()
+			{
+				Interpreter::evaluate(script);
+			});
+			if (run == 0 || current.nsPerOp < result.nsPerOp)
+			{
+				result = current;
+			}
+		}
+		if (m_count)
+		{
+			result = count(name, [&]()
+			{
+				Interpreter::evaluate(script);
+			}, 1);
+		}
+
+		cout.rdbuf(output);
+		results.push_back(result);
+		print(result, true);
+	}
+}
+
+//reads the numbers of every benchmark from an earlier output
+unordered_map<string, unordered_map<string, double>> readBaseline(const string& path)
+{
+	ifstream file(path);
+	if (!file)
+	{
+		throw ParsingException("Could not read the baseline [" + path + "]");
+	}
+
+	unordered_map<string, unordered_map<string, double>> baseline;
+	string line;
+	while (getline(file, line))
+	{
+		size_t name = line.find("\"name\":\"");
+		if (name == string::npos)
+		{
+			continue;
+		}
+		name += 8;
+		unordered_map<string, double>& values = baseline[line.substr(name, line.find('"', name) - name)];
+
+		//every other field is a "key":number pair
+		size_t key = line.find(",\"", name);
+		while (key != string::npos)
+		{
+			size_t end = line.find("\":", key + 2);
+			if (end == string::npos)
+			{
+				break;
+			}
+			values[line.substr(key + 2, end - key - 2)] = atof(line.c_str() + end + 2);
+			key = line.find(",\"", end);
+		}
+	}
+	return baseline;
+}
+
+void printChange(const string& name, double before, double after, const string& unit)
+{
+	if (m_count)
+	{
+		cerr << name << ": " << formatCount(before) << " -> " << formatCount(after);
+	}
+	else
+	{
+		cerr << name << ": " << before << " -> " << after << " " << unit;
+	}
+	if (before > 0)
+	{
+		double change = (after / before - 1) * 100;
+		cerr << " (" << (change >= 0 ? "+" : "") << change << "%)";
+	}
+	cerr << endl;
+}
+
+//returns the number of counters that changed, the time is too noisy to fail on
+size_t compare(const vector<BenchmarkResult>& results, const string& path)
+{
+	unordered_map<string, unordered_map<string, double>> baseline = readBaseline(path);
+	size_t changed = 0;
+
+	cerr << endl << "-- Compared to " << path << " --" << endl;
+	for (const BenchmarkResult& result : results)
+	{
+		auto it = baseline.find(result.name);
+		if (it == baseline.end())
+		{
+			cerr << result.name << ": no baseline" << endl;
+			continue;
+		}
+		const unordered_map<string, double>& values = it->second;
+
+		if (!m_count)
+		{
+			auto time = values.find("ns_per_op");
+			if (time == values.end())
+			{
+				cerr << result.name << ": no time in the baseline" << endl;
+				continue;
+			}
+			printChange(result.name, time->second, result.nsPerOp, "ns/op");
+			continue;
+		}
+
+		size_t before = changed;
+		for (size_t i = 0; i < m_counters.size(); i++)
+		{
+			auto value = values.find(m_counters[i].first);
+			if (value == values.end())
+			{
+				cerr << result.name << ": no counts in the baseline" << endl;
+				changed++;
+				break;
+			}
+			//compared the way they were written to the baseline
+			if (formatCount(result.counts[i]) != formatCount(value->second))
+			{
+				printChange(result.name + " " + m_counters[i].first, value->second, result.counts[i], "");
+				changed++;
+			}
+		}
+		if (changed == before)
+		{
+			cerr << result.name << ": unchanged" << endl;
+		}
+	}
+	return changed;
+}
+
+int main(int argc, char* argv[])
+{
+	string corpus = XES_BENCH_CORPUS;
+	string baseline;
+	bool micro = true;
+	bool scripts = true;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--corpus" && hasValue)
+		{
+			corpus = argv[++i];
+		}
+		else if (argument == "--compare" && hasValue)
+		{
+			baseline = argv[++i];
+		}
+		else if (argument == "--filter" && hasValue)
+		{
+			m_filter = argv[++i];
+		}
+		else if (argument == "--min-time" && hasValue)
+		{
+			m_minTimeMs = (size_t)stoul(argv[++i]);
+		}
+		else if (argument == "--runs" && hasValue)
+		{
+			m_runs = max((size_t)1, (size_t)stoul(argv[++i]));
+		}
+		else if (argument == "--count")
+		{
+			m_count = true;
+		}
+		else if (argument == "--micro")
+		{
+			scripts = false;
+		}
+		else if (argument == "--scripts")
+		{
+			micro = false;
+		}
+		else
+		{
+			cerr << "Usage: xes_bench [--micro | --scripts] [--filter text] [--count] [--min-time ms] [--runs n] [--corpus dir] [--compare baseline.jsonl]" << endl;
+			return 1;
+		}
+	}
+
+	Interpreter::initialize();
+	RuntimeStats::registerThread();
+
+	vector<BenchmarkResult> results;
+	if (micro)
+	{
+		runMicrobenchmarks(results);
+	}
+	if (scripts)
+	{
+		runCorpus(results, corpus);
+	}
+
+	size_t changed = 0;
+	if (!baseline.empty())
+	{
+		changed = compare(results, baseline);
+	}
+
+	//with --count a change of the work done fails the run
+	return changed > 0 || m_sink == -1 ? 1 : 0;
+}
@@ -1,41 +1,249 @@
 //NOTE: project was based on https://github.com/vassilych/cscscpp
 
 #pragma once
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "Interpreter.h"
 
 void processScript(const string& scriptData);
+void processRecords(const string& scriptData, char separator);
+char getSeparator(int argc, char* argv[], int& index);
+size_t getOptionValue(int argc, char* argv[], int& index);
+string getOptionArgument(int argc, char* argv[], int& index);
 
-int main(int argc, char* argv[]) 
+int main(int argc, char* argv[])
 {
 	Interpreter::initialize();
 
 	string sourceFilePath;
+	ExecutionLimits limits;
+	bool profile = false;
+	bool statistics = false;
+	string sampleFile;
+	string traceFile;
+	size_t sampleInterval = 1;
+	bool eachLine = false;
+	char separator = 0;
+	string loadSnapshotFile;
+	string saveSnapshotFile;
+	string serveSocket;
+	size_t workers = thread::hardware_concurrency();
 
-	if (argv[1]) 
+	for (int i = 1; i < argc; i++)
 	{
-		sourceFilePath = argv[1];
+		string argument = argv[i];
+
+		if (argument == "--max-steps")
+		{
+			limits.maxSteps = getOptionValue(argc, argv, i);
+		}
+		else if (argument == "--timeout")
+		{
+			limits.timeoutMs = getOptionValue(argc, argv, i);
+		}
+		else if (argument == "--max-memory")
+		{
+			limits.maxMemoryMb = getOptionValue(argc, argv, i);
+		}
+		else if (argument == "--threads")
+		{
+			Interpreter::setThreadCount(getOptionValue(argc, argv, i));
+		}
+		else if (argument == "--profile")
+		{
+			profile = true;
+		}
+		else if (argument == "--no-optimize")
+		{
+			Interpreter::setOptimization(false);
+		}
+		else if (argument == "--stats")
+		{
+			statistics = true;
+		}
+		else if (argument == "--trace")
+		{
+			traceFile = getOptionArgument(argc, argv, i);
+		}
+		else if (argument == "--sample")
+		{
+			sampleFile = getOptionArgument(argc, argv, i);
+		}
+		else if (argument == "--sample-interval")
+		{
+			sampleInterval = getOptionValue(argc, argv, i);
+		}
+		else if (argument == "--each-line")
+		{
+			eachLine = true;
+		}
+		else if (argument == "--separator")
+		{
+			separator = getSeparator(argc, argv, i);
+		}
+		else if (argument == "--load-snapshot")
+		{
+			loadSnapshotFile = getOptionArgument(argc, argv, i);
+		}
+		else if (argument == "--save-snapshot")
+		{
+			saveSnapshotFile = getOptionArgument(argc, argv, i);
+		}
+		else if (argument == "--serve")
+		{
+			serveSocket = getOptionArgument(argc, argv, i);
+		}
+		else if (argument == "--workers")
+		{
+			workers = getOptionValue(argc, argv, i);
+		}
+		else
+		{
+			sourceFilePath = argument;
+		}
+	}
+
+	// The daemon keeps the interpreter and the converted scripts around for all of its requests
+	if (!serveSocket.empty())
+	{
+		Interpreter::setExecutionLimits(limits);
+		if (!loadSnapshotFile.empty())
+		{
+			Interpreter::loadSnapshot(loadSnapshotFile);
+		}
+		Interpreter::serve(serveSocket, workers);
+		return 0;
 	}
-	else 
+
+	if (sourceFilePath.empty())
 	{
 		throw ParsingException("No scriptfile was provided to run the XecutionScript Interpreter!");
 	}
 
-	cout << "-- XecutionScript Interpreter 0.1 --" << endl;
-	cout << "Loading Scriptfile: " << sourceFilePath << "..." << endl;
-	cout << "Output:" << endl;
+	Interpreter::setExecutionLimits(limits);
+	Interpreter::setProfiling(profile);
+
+	if (!traceFile.empty())
+	{
+		Interpreter::startTrace(traceFile);
+	}
+
+	// The output of --each-line is usually piped on, it only contains what the script prints
+	if (eachLine)
+	{
+		ios::sync_with_stdio(false);
+		ScriptHelper::setBufferedOutput(true);
+	}
+	else
+	{
+		cout << "-- XecutionScript Interpreter 0.1 --" << endl;
+		cout << "Loading Scriptfile: " << sourceFilePath << "..." << endl;
+		cout << "Output:" << endl;
+	}
 
 	string sourceFileData = ScriptHelper::readScriptFile(sourceFilePath);
 
 	if (sourceFileData.empty()) { throw ParsingException("The file that was provided is empty. Nothing to Parse!"); };
 
-	processScript(sourceFileData);
+	// The globals of a snapshot are there before the script starts, e.g. the tables a preamble computed
+	if (!loadSnapshotFile.empty())
+	{
+		Interpreter::loadSnapshot(loadSnapshotFile);
+	}
+
+	if (!sampleFile.empty())
+	{
+		Interpreter::startSampling(sampleInterval);
+	}
+
+	if (eachLine)
+	{
+		processRecords(sourceFileData, separator);
+	}
+	else
+	{
+		processScript(sourceFileData);
+	}
+
+	if (!saveSnapshotFile.empty())
+	{
+		Interpreter::saveSnapshot(saveSnapshotFile);
+	}
+
+	Interpreter::stopTrace();
+
+	if (profile)
+	{
+		Interpreter::printProfile(cout);
+	}
+
+	if (statistics)
+	{
+		Interpreter::printStatistics(cout);
+	}
+
+	if (!sampleFile.empty())
+	{
+		ofstream samples(sampleFile);
+		if (!samples)
+		{
+			throw ParsingException("Could not write the samples to [" + sampleFile + "]");
+		}
+		Interpreter::stopSampling(samples);
+	}
 }
 
-void processScript(const string& scriptData) 
+void processScript(const string& scriptData)
 {
 	Variable result;
 	result = Interpreter::evaluate(scriptData);
-}
\ No newline at end of file
+}
+
+void processRecords(const string& scriptData, char separator)
+{
+	RecordReader records(stdin);
+	Interpreter::evaluateEachLine(scriptData, records, separator);
+	cout.flush();
+}
+
+//Reads the character of --separator, "\t" stands for a tab
+char getSeparator(int argc, char* argv[], int& index)
+{
+	string value = getOptionArgument(argc, argv, index);
+	if (value == "\\t")
+	{
+		return '\t';
+	}
+	if (value.size() != 1)
+	{
+		throw ParsingException("Option --separator expects a single character but got [" + value + "]");
+	}
+
+	return value[0];
+}
+
+//Reads the value that follows an option like --sample profile.folded
+string getOptionArgument(int argc, char* argv[], int& index)
+{
+	if (index + 1 >= argc)
+	{
+		throw ParsingException("Option " + string(argv[index]) + " expects a value!");
+	}
+
+	return argv[++index];
+}
+
+//Reads the numeric value that follows an option like --max-steps 1000000
+size_t getOptionValue(int argc, char* argv[], int& index)
+{
+	string value = getOptionArgument(argc, argv, index);
+	if (value.empty() || value.find_first_not_of("0123456789") != string::npos)
+	{
+		throw ParsingException("Option " + string(argv[index - 1]) + " expects a positive number but got [" + value + "]");
+	}
+
+	return (size_t)stoull(value);
+}
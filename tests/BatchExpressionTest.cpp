@@ -0,0 +1,96 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "BatchExpression.h"
+#include "Test.h"
+
+static vector<double> evaluate(const BatchExpression& expression, const vector<vector<double>>& columns)
+{
+	vector<const double*> inputs;
+	for (const vector<double>& column : columns)
+	{
+		inputs.push_back(column.data());
+	}
+
+	vector<double> output(columns[0].size());
+	expression.evaluate(inputs, output.size(), output.data());
+	return output;
+}
+
+static void testVectorized()
+{
+	//more rows than one block
+	vector<double> price(600), qty(600), discount(600);
+	for (size_t i = 0; i < price.size(); i++)
+	{
+		price[i] = i % 100;
+		qty[i] = i % 7;
+		discount[i] = (i % 10) / 10.0;
+	}
+
+	BatchExpression score("base = price * qty; base - base * discount", { "price", "qty", "discount" });
+	CHECK(score.isVectorized());
+
+	vector<double> output = evaluate(score, { price, qty, discount });
+	bool equal = true;
+	for (size_t i = 0; i < output.size(); i++)
+	{
+		double base = price[i] * qty[i];
+		equal = equal && output[i] == base - base * discount[i];
+	}
+	CHECK(equal);
+
+	//variables of the script are read once per call
+	Interpreter::evaluate("k = 3;");
+	BatchExpression scaled("a * k + (a < 2)", { "a" });
+	CHECK(scaled.isVectorized());
+	CHECK(evaluate(scaled, { { 1, 2, 5 } }) == vector<double>({ 4, 6, 15 }));
+}
+
+static void testRowByRow()
+{
+	BatchExpression call("abs(a - 10)", { "a" });
+	CHECK(!call.isVectorized());
+	CHECK(evaluate(call, { { 5, 20, 12 } }) == vector<double>({ 5, 10, 2 }));
+
+	//a script variable that is not a number makes a vectorized expression run row by row
+	Interpreter::evaluate("k = \"text\";");
+	BatchExpression text("size(k) + a", { "a" });
+	CHECK(evaluate(text, { { 1, 2 } }) == vector<double>({ 5, 6 }));
+}
+
+static void testResultVariable()
+{
+	//control flow has no value, the rows get the value of the result variable
+	BatchExpression branches("if (price > 10) { r = price * 2; } else { r = price; }", { "price" }, "r");
+	CHECK(!branches.isVectorized());
+	CHECK(evaluate(branches, { { 5, 20, 12 } }) == vector<double>({ 5, 40, 24 }));
+
+	BatchExpression loop("n = price; while (n > 10) { n -= 10; }", { "price" }, "n");
+	CHECK(evaluate(loop, { { 5, 20, 12 } }) == vector<double>({ 5, 10, 2 }));
+
+	//the value of the previous row is cleared
+	BatchExpression fee("if (qty > 10) { fee = 7; }", { "qty" }, "fee");
+	CHECK(evaluate(fee, { { 20, 30 } }) == vector<double>({ 7, 7 }));
+	CHECK_THROWS(evaluate(fee, { { 20, 5, 30 } }), "didn't set [fee] in row 1");
+
+	//a script that ends with an expression has its own value
+	BatchExpression own("fee = qty * 2", { "qty" }, "fee");
+	CHECK(evaluate(own, { { 20, 5 } }) == vector<double>({ 40, 10 }));
+
+	BatchExpression none("if (price > 10) { r = price; }", { "price" });
+	CHECK_THROWS(evaluate(none, { { 5 } }), "must be numeric, got VOID");
+
+	BatchExpression text("\"p\" + price", { "price" });
+	CHECK_THROWS(evaluate(text, { { 5 } }), "must be numeric, got STRING");
+}
+
+int main()
+{
+	startTests();
+
+	testVectorized();
+	testRowByRow();
+	testResultVariable();
+
+	return finishTests();
+}
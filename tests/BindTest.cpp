@@ -0,0 +1,73 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+static vector<int> g_calls; //arguments of testRecord() in the order it was called
+
+static double scale(double value, int factor)
+{
+	return value * factor;
+}
+
+static void testTypes()
+{
+	Interpreter::bind("testScale", scale);
+	Interpreter::bind("testJoin", [](const string& a, string b) { return a + "-" + b; });
+	Interpreter::bind("testType", [](Variable value) { return Tokens::typeToString(value.m_type); });
+
+	CHECK(value("testScale(2.5, 4)").m_numericValue == 10);
+	CHECK(value("testScale(1 + 1, 2 * 3)").m_numericValue == 12);
+	CHECK(value("testJoin(\"a\", \"b\")").m_stringValue == "a-b");
+	CHECK(value("testJoin(\"x\", 7)").m_stringValue == "x-7");
+	CHECK(value("testType(\"text\")").m_stringValue == "STRING");
+	CHECK(value("testJoin(\"(,)\", testJoin(\"c\", \"d\"))").m_stringValue == "(,)-c-d");
+}
+
+static void testCalls()
+{
+	//the arguments are evaluated from left to right, a void function returns nothing
+	Interpreter::bind("testRecord", [](int value) { g_calls.push_back(value); return value; });
+	Interpreter::bind("testClear", []() { g_calls.clear(); });
+
+	Interpreter::evaluate("testClear(); testScale(testRecord(1), testRecord(2));");
+	CHECK(g_calls == vector<int>({ 1, 2 }));
+	CHECK(value("testClear()").m_type == Tokens::VOID);
+	CHECK(g_calls.empty());
+}
+
+static void testErrors()
+{
+	//the argument count is checked before any argument is evaluated
+	Interpreter::evaluate("testClear();");
+	CHECK_THROWS(Interpreter::evaluate("testScale(testRecord(1));"), "arguments mismatch: 2 expected, 1 was found");
+	CHECK_THROWS(Interpreter::evaluate("testScale(1, testRecord(2), 3);"), "arguments mismatch: 2 expected, 3 was found");
+	CHECK(g_calls.empty());
+	CHECK_THROWS(Interpreter::evaluate("testScale(\"a\", 2);"), "Argument 1 of [testScale] has to be a number");
+
+	//integer parameters only take integers their type can hold
+	CHECK_THROWS(Interpreter::evaluate("testScale(1, 2.7);"), "Expecting an integer");
+	CHECK_THROWS(Interpreter::evaluate("testScale(1, 0/0);"), "Expecting an integer");
+	CHECK_THROWS(Interpreter::evaluate("testScale(1, 1e20);"), "Argument 2 of [testScale] is out of the range of its type");
+	CHECK_THROWS(Interpreter::evaluate("testScale(1, 2147483648);"), "out of the range of its type");
+	CHECK(value("testScale(1, -2147483648)").m_numericValue == -2147483648.0);
+
+	Interpreter::bind("testUnsigned", [](unsigned char value) { return value; });
+	CHECK(value("testUnsigned(255)").m_numericValue == 255);
+	CHECK_THROWS(Interpreter::evaluate("testUnsigned(256);"), "out of the range of its type");
+	CHECK_THROWS(Interpreter::evaluate("testUnsigned(-1);"), "out of the range of its type");
+	Interpreter::bind("testFlag", [](bool value) { return value ? 1 : 0; });
+	CHECK(value("testFlag(0.5) + testFlag(0)").m_numericValue == 1);
+
+	CHECK_THROWS(Interpreter::bind("testScale", scale), "Global name [testScale] already exists");
+}
+
+int main()
+{
+	startTests();
+
+	testTypes();
+	testCalls();
+	testErrors();
+
+	return finishTests();
+}
@@ -0,0 +1,71 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+static void testValues()
+{
+	//values are received in the order they were sent
+	Interpreter::evaluate("c = channel(4); send(c, 1); send(c, \"two\"); send(c, array(3));");
+	CHECK(value("recv(c)").m_numericValue == 1);
+	CHECK(value("recv(c)").m_stringValue == "two");
+	CHECK(value("a = recv(c); a[0]").m_numericValue == 3);
+
+	CHECK(value("tryRecv(c)").m_type == Tokens::VOID);
+	CHECK(value("tryRecv(c, -1)").m_numericValue == -1);
+	CHECK(value("send(c, 5); tryRecv(c, -1)").m_numericValue == 5);
+
+	//the capacity is a power of two, at least 2
+	CHECK(value("channel(5)").toString() == "channel(8)");
+	CHECK(value("channel(1)").toString() == "channel(2)");
+	CHECK(value("c = channel(1); send(c, 1); send(c, 2); recv(c) + recv(c)").m_numericValue == 3);
+	CHECK_THROWS(Interpreter::evaluate("channel(0);"), "The capacity of a channel has to be at least 1");
+	CHECK_THROWS(Interpreter::evaluate("channel(-2);"), "Expecting a non negative number");
+}
+
+static void testClose()
+{
+	//the values sent before close() can still be received
+	Interpreter::evaluate("c = channel(4); send(c, 1); send(c, 2); close(c);");
+	CHECK_THROWS(Interpreter::evaluate("send(c, 3);"), "Can't send to a closed channel");
+	CHECK(value("recv(c)").m_numericValue == 1);
+	CHECK(value("s = 0; for (v : c) { s += v; } s").m_numericValue == 2);
+	CHECK_THROWS(Interpreter::evaluate("recv(c);"), "recv() on a closed and empty channel(4)");
+	CHECK(value("tryRecv(c, 7)").m_numericValue == 7);
+}
+
+static void testWaitForever()
+{
+	//without tasks nothing could ever change the channel of the main thread
+	CHECK_THROWS(Interpreter::evaluate("c = channel(2); recv(c);"), "recv() on channel(2) would wait forever");
+	CHECK_THROWS(Interpreter::evaluate("c = channel(2); send(c, 1); send(c, 2); send(c, 3);"), "send() on channel(2) would wait forever");
+	CHECK_THROWS(Interpreter::evaluate("send(5, 1);"), "Function [send] expects a channel but got [5]");
+}
+
+static void testProducers()
+{
+	//a task fills a small channel while the main thread drains it
+	CHECK(value("c = channel(2); p = spawn() { for (i = 0; i < 100; i++) { send(c, i); } close(c); }; "
+		"s = 0; for (v : c) { s += v; } s").m_numericValue == 4950);
+
+	//the chunks of a pfor send from several threads at once
+	Interpreter::evaluate("c = channel(1024); pfor (i : range(0, 1000)) { send(c, i); } close(c);");
+	CHECK(value("s = 0; n = 0; for (v : c) { s += v; n++; } s + n * 1000000").m_numericValue == 1000499500);
+
+	//several producer tasks and a consumer task
+	CHECK(value("c = channel(4); done = channel(2); "
+		"producers = array(); for (p = 0; p < 4; p++) { push(producers, spawn() { for (i = 1; i <= 50; i++) { send(c, i); } }); } "
+		"consumer = spawn() { s = 0; for (v : c) { s += v; } send(done, s); }; "
+		"for (t : producers) { await(t); } close(c); recv(done)").m_numericValue == 5100);
+}
+
+int main()
+{
+	startTests();
+
+	testValues();
+	testClose();
+	testWaitForever();
+	testProducers();
+
+	return finishTests();
+}
@@ -0,0 +1,109 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+static void testMap()
+{
+	//entries keep the order they were added in, 0 and -0 are the same key
+	Interpreter::evaluate("m = map(); m[\"b\"] = 1; m[\"a\"] = 2; m[3] = 3; m[0] = 4; m[0 - 0] = 5;");
+	CHECK(value("k = \"\"; for (x : m) { k += x; } k").m_stringValue == "ba30");
+	CHECK(value("size(m) * 10 + m[0]").m_numericValue == 45);
+	CHECK(value("m").toString() == "{\"b\": 1, \"a\": 2, 3: 3, 0: 5}");
+	CHECK_THROWS(Interpreter::evaluate("m[array(1)] = 1;"), "Only strings and numbers can be used as map keys, found [ARRAY]");
+
+	//so are all NaNs
+	Interpreter::evaluate("n = 0/0; m = map(); m[n] = 1; z = 0 - n; m[z] = 2;");
+	CHECK(value("size(m) * 10 + m[0/0]").m_numericValue == 12);
+	CHECK(value("contains(m, n)").m_numericValue == 1);
+	CHECK(value("remove(m, n); size(m)").m_numericValue == 0);
+}
+
+static void testRehash()
+{
+	//removed entries leave holes that later rehashes compact
+	Interpreter::evaluate("m = map(); for (i = 0; i < 1000; i++) { m[i] = i * 2; } for (i = 0; i < 1000; i += 2) { remove(m, i); }");
+	CHECK(value("size(m)").m_numericValue == 500);
+	CHECK(value("contains(m, 998) + contains(m, 999) * 10").m_numericValue == 10);
+	CHECK(value("for (i = 1000; i < 3000; i++) { m[\"k\" + i] = i; } s = 0; for (k : m) { s += m[k]; } s").m_numericValue == 500000 + 3999000);
+
+	//adding and removing the same keys over and over doesn't grow the map
+	CHECK(value("t = map(); for (r = 0; r < 200; r++) { for (i = 0; i < 10; i++) { t[i] = r; } for (i = 0; i < 10; i++) { remove(t, i); } } "
+		"t[5] = 1; size(t) + t[5]").m_numericValue == 2);
+}
+
+static void testChangeWhileIterating()
+{
+	//a rehash while the map is iterated doesn't move the entries that are still to come
+	Interpreter::evaluate("m = map(); for (i = 0; i < 12; i++) { m[i] = i; } for (i = 0; i < 5; i++) { remove(m, i); }");
+	CHECK(value("seen = \"\"; n = 0; for (k : m) { seen += k + \",\"; n++; if (n < 4) { m[\"x\" + n] = 1; } } seen").m_stringValue ==
+		"5,6,7,8,9,10,11,x1,x2,x3,");
+
+	Interpreter::evaluate("m = map(); for (i = 0; i < 6; i++) { m[i] = i; } for (i = 0; i < 4; i++) { remove(m, i); }");
+	CHECK(value("n = 0; for (k : m) { n++; if (n == 1) { for (j = 0; j < 20; j++) { m[\"y\" + j] = j; } } } n").m_numericValue == 22);
+
+	//the current entry and the ones that were already seen can be removed
+	CHECK(value("m = map(); for (i = 0; i < 6; i++) { m[i] = i; } n = 0; for (k : m) { n++; remove(m, k); } n * 10 + size(m)").m_numericValue == 60);
+	CHECK(value("m = map(); for (i = 0; i < 6; i++) { m[i] = i; } seen = \"\"; for (k : m) { seen += k; remove(m, k + 1); } seen").m_stringValue == "024");
+
+	//once the loop is done the holes are compacted again
+	CHECK(value("for (i = 0; i < 40; i++) { m[\"w\" + i] = i; remove(m, \"w\" + i); } m").toString() == "{0: 0, 2: 2, 4: 4}");
+}
+
+static void testArray()
+{
+	//assigning right after the last element appends
+	Interpreter::evaluate("a = array(1, 2); a[2] = 3;");
+	CHECK(value("size(a)").m_numericValue == 3);
+	CHECK_THROWS(Interpreter::evaluate("a[5] = 1;"), "Index [5] is out of bounds, the array has 3 elements");
+	CHECK(value("contains(array(1, \"x\"), \"x\") + contains(array(1, \"x\"), 2)").m_numericValue == 1);
+
+	//the loop sees the elements pushed by its body, a removed one moves the rest down like in an index loop
+	CHECK(value("a = array(1, 2, 3); s = 0; for (v : a) { s += v; if (v == 1) { push(a, 10); } } s").m_numericValue == 16);
+	CHECK(value("a = array(1, 2, 3, 4); seen = \"\"; for (v : a) { seen += v; remove(a, 0); } seen").m_stringValue == "13");
+	CHECK(value("a = array(array(1, 2), array(3)); s = 0; for (x : a) { for (y : x) { s += y; } } s").m_numericValue == 6);
+}
+
+static void testIterators()
+{
+	//a range computes its items while iterating, so does a loop over it inside of itself
+	CHECK(value("r = range(0, 3); s = \"\"; for (a : r) { for (b : r) { s += a * 10 + b + \",\"; } } s").m_stringValue == "0,1,2,10,11,12,20,21,22,");
+	CHECK(value("for (v : range(0, 1, 0.25)) { last = v; } last").m_numericValue == 0.75);
+	CHECK(value("n = 0; for (v : range(5)) { if (v == 3) { break; } n++; } n").m_numericValue == 3);
+	CHECK(value("n = 0; for (v : range(5)) { if (v == 3) { continue; } n++; } n").m_numericValue == 4);
+
+	CHECK(value("seen = \"\"; for (c : \"abc\") { seen += c + \".\"; } seen").m_stringValue == "a.b.c.");
+	CHECK_THROWS(Interpreter::evaluate("for (x : 5) { }"), "Can't iterate over [5]");
+	CHECK_THROWS(Interpreter::evaluate("r = range(3); r[3];"), "Index [3] is out of bounds, the range has 3 elements");
+	CHECK_THROWS(Interpreter::evaluate("r = range(3); r[1.5];"), "Expecting an integer");
+}
+
+static void testRange()
+{
+	CHECK(value("size(range(5)) + size(range(2, 5)) + size(range(10, 0, -3))").m_numericValue == 12);
+	CHECK(value("r = range(1, 2, 0.25); r[3]").m_numericValue == 1.75);
+	CHECK(value("size(range(5, 0))").m_numericValue == 0);
+
+	//the largest range whose items are still exact
+	CHECK(value("size(range(0, 9007199254740991))").m_numericValue == 9007199254740991.0);
+	CHECK_THROWS(Interpreter::evaluate("size(range(0, 1e30));"), "can't have more than 2^53 elements");
+	CHECK_THROWS(Interpreter::evaluate("size(range(-1e308, 1e308, 1e300));"), "can't have more than 2^53 elements");
+
+	CHECK_THROWS(Interpreter::evaluate("n = 0; for (i : range(0, 1/0)) { n++; }"), "must be finite numbers");
+	CHECK_THROWS(Interpreter::evaluate("range(0/0);"), "must be finite numbers");
+	CHECK_THROWS(Interpreter::evaluate("range(0, 10, 1/0);"), "must be finite numbers");
+	CHECK_THROWS(Interpreter::evaluate("range(0, 10, 0);"), "can't be 0");
+}
+
+int main()
+{
+	startTests();
+
+	testMap();
+	testRehash();
+	testChangeWhileIterating();
+	testArray();
+	testIterators();
+	testRange();
+
+	return finishTests();
+}
@@ -0,0 +1,69 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "CompiledExpression.h"
+#include "Test.h"
+
+static void testExpressions()
+{
+	Interpreter::evaluate("x = 4; y = 3;");
+
+	CompiledExpression sum("x + 2 * y");
+	CHECK(sum.isCompiled());
+	CHECK(sum.evaluate().m_numericValue == 10);
+
+	//the variables are read on every evaluation
+	Interpreter::evaluate("y = 10;");
+	CHECK(sum.evaluate().m_numericValue == 24);
+
+	CompiledExpression increment("x++");
+	CHECK(increment.isCompiled());
+	increment.evaluate();
+	CHECK(value("x").m_numericValue == 5);
+
+	//function calls run through the Parser
+	CompiledExpression call("size(\"abc\")");
+	CHECK(!call.isCompiled());
+	CHECK(call.evaluate().m_numericValue == 3);
+}
+
+//the value of the for loop has to be the one of the same loop written with while
+static void compareLoops(const string& init, const string& condition, const string& step, const string& body, const string& result)
+{
+	double counted = value("s = 0; for (" + init + "; " + condition + "; " + step + ") { " + body + " } " + result).m_numericValue;
+	double plain = value(init + "; s = 0; while (" + condition + ") { " + body + " " + step + "; } " + result).m_numericValue;
+	CHECK(counted == plain);
+}
+
+static void testCountedFor()
+{
+	CHECK(value("s = 0; for (i = 10; i > 0; i -= 3) { s += i; } s * 100 + i").m_numericValue == 2198);
+	CHECK(value("s = 0; for (i = 0; i != 6; i += 2) { s++; } s").m_numericValue == 3);
+
+	//the bound is evaluated on every iteration
+	CHECK(value("n = 3; s = 0; for (i = 0; i < n; i++) { n = 5; s++; } s").m_numericValue == 5);
+
+	//a body that sets the counter to an integer stays in the counted loop
+	CHECK(value("s = 0; for (i = 0; i < 10; i++) { i += 2; s++; } s * 100 + i").m_numericValue == 412);
+	compareLoops("i = 0", "i < 10", "i++", "i += 2; s++;", "s * 100 + i");
+
+	//a body that makes it a fraction continues in the regular loop
+	CHECK(value("s = 0; for (i = 0; i < 5; i++) { i = i + 0.5; s++; } s * 100 + i").m_numericValue == 406);
+	CHECK(value("s = 0; for (i = 0; i < 4; i++) { i = i * 1.5; s++; } s * 100 + i").m_numericValue == 304.75);
+	compareLoops("i = 0", "i < 5", "i++", "i = i + 0.5; s++;", "s * 100 + i");
+	compareLoops("i = 0", "i < 4", "i++", "i = i * 1.5; s++;", "s * 100 + i");
+
+	//loops that never qualify
+	CHECK(value("s = 0; for (i = 0.5; i < 3; i++) { s++; } s * 100 + i").m_numericValue == 303.5);
+	CHECK(value("s = 0; for (i = 0; i < 2; i += 0.5) { s++; } s").m_numericValue == 4);
+	CHECK(value("x = \"c\"; s = 0; for (i = 0; i < x; i++) { s++; if (s > 5) { break; } } s").m_numericValue == 6);
+}
+
+int main()
+{
+	startTests();
+
+	testExpressions();
+	testCountedFor();
+
+	return finishTests();
+}
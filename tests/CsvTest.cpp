@@ -0,0 +1,97 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <fstream>
+
+#include "Csv.h"
+#include "Test.h"
+
+static vector<vector<Variable>> scan(const string& data, char separator = ',')
+{
+	CsvScanner scanner(data.data(), data.size(), separator);
+	vector<vector<Variable>> rows;
+	vector<Variable> fields;
+	while (scanner.nextRow(fields))
+	{
+		rows.push_back(fields);
+	}
+	return rows;
+}
+
+static void writeFile(const string& path, const string& text)
+{
+	ofstream out(path, ios::binary);
+	out << text;
+}
+
+static void testFields()
+{
+	//the fields run over the 16 byte blocks of the scanner
+	vector<vector<Variable>> rows = scan("name,amount,note\r\n\nsome longer name than a block,-12.5e1,\n\"a, \"\"quoted\"\"\nfield\",7,inf\n");
+	CHECK(rows.size() == 3);
+	CHECK(rows[0].size() == 3 && rows[0][2].m_stringValue == "note");
+
+	CHECK(rows[1][0].m_stringValue == "some longer name than a block");
+	CHECK(rows[1][1].m_type == Tokens::NUMERIC && rows[1][1].m_numericValue == -125);
+	CHECK(rows[1].size() == 3 && rows[1][2].m_type == Tokens::STRING && rows[1][2].m_stringValue.empty());
+
+	CHECK(rows[2][0].m_stringValue == "a, \"quoted\"\nfield");
+	CHECK(rows[2][1].m_numericValue == 7);
+	CHECK(rows[2][2].m_type == Tokens::STRING && rows[2][2].m_stringValue == "inf");
+
+	//quoted numbers stay strings, the last row may end without a new line
+	rows = scan("\"42\"\tnan\t-.5\t+1", '\t');
+	CHECK(rows.size() == 1 && rows[0].size() == 4);
+	CHECK(rows[0][0].m_type == Tokens::STRING && rows[0][0].m_stringValue == "42");
+	CHECK(rows[0][1].m_type == Tokens::STRING);
+	CHECK(rows[0][2].m_numericValue == -0.5 && rows[0][3].m_numericValue == 1);
+
+	CHECK(scan("").empty());
+	CHECK(scan("\n\r\n\n").empty());
+}
+
+static void testColumns()
+{
+	//more rows than the sample the columns are reserved from
+	string text = "id,price,label\n";
+	for (int i = 0; i < 200; i++)
+	{
+		text += to_string(i) + "," + to_string(i * 2) + (i % 50 == 0 ? "\n" : ",row" + to_string(i) + "\n");
+	}
+	writeFile("CsvTest.csv", text);
+
+	Interpreter::evaluate("table = csvRead(\"CsvTest.csv\");");
+	CHECK(value("size(table[\"id\"])").m_numericValue == 200);
+	CHECK(value("table[\"price\"][199]").m_numericValue == 398);
+	CHECK(value("table[\"label\"][3]").m_stringValue == "row3");
+	CHECK(value("table[\"label\"][50]").m_stringValue.empty());
+
+	//the rows are arrays of the fields, the header is one of them
+	CHECK(value("n = 0; total = 0; for (row : csvRows(\"CsvTest.csv\")) { n++; if (n > 1) { total += row[1]; } } total").m_numericValue == 39800);
+	CHECK(value("n").m_numericValue == 201);
+
+	writeFile("CsvTest.tsv", "a\tb\n1\t2\n");
+	CHECK(value("tsv = csvRead(\"CsvTest.tsv\", \"\\t\"); tsv[\"b\"][0]").m_numericValue == 2);
+
+	writeFile("CsvTest.csv", "");
+	CHECK(value("size(csvRead(\"CsvTest.csv\"))").m_numericValue == 0);
+
+	remove("CsvTest.csv");
+	remove("CsvTest.tsv");
+}
+
+static void testErrors()
+{
+	CHECK_THROWS(Interpreter::evaluate("csvRead(\"CsvTest.missing\");"), "CsvTest.missing");
+	CHECK_THROWS(Interpreter::evaluate("csvRead(\"CsvTest.csv\", \";;\");"), "expects a single character as separator");
+}
+
+int main()
+{
+	startTests();
+
+	testFields();
+	testColumns();
+	testErrors();
+
+	return finishTests();
+}
@@ -0,0 +1,50 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "ExecutionBudget.h"
+#include "Test.h"
+
+static void testSteps()
+{
+	ExecutionLimits limits;
+	limits.maxSteps = 1000;
+	Interpreter::setExecutionLimits(limits);
+
+	//every evaluation starts with the whole budget
+	CHECK(value("n = 0; for (i = 0; i < 400; i++) { n++; } n").m_numericValue == 400);
+	CHECK(value("n = 0; for (i = 0; i < 400; i++) { n++; } n").m_numericValue == 400);
+
+	CHECK_THROWS(Interpreter::evaluate("for (i = 0; i < 100000; i++) { }"), "Execution budget of 1000 steps exceeded");
+	CHECK_THROWS(Interpreter::evaluate("while (1) { }"), "Execution budget of 1000 steps exceeded");
+	CHECK_THROWS(Interpreter::evaluate("for (v : range(5000)) { }"), "Execution budget of 1000 steps exceeded");
+
+	//the steps of the pfor workers count for the script that started them
+	CHECK_THROWS(Interpreter::evaluate("pfor (v : range(5000)) { }"), "Execution budget of 1000 steps exceeded");
+	CHECK_THROWS(Interpreter::evaluate("pfor (v : range(600)) { } for (i = 0; i < 600; i++) { }"), "Execution budget of 1000 steps exceeded");
+	CHECK(value("s = 0; pfor (v : range(400); sum(s)) { s += 1; } s").m_numericValue == 400);
+
+	Interpreter::setExecutionLimits(ExecutionLimits());
+	CHECK(value("n = 0; for (i = 0; i < 100000; i++) { n++; } n").m_numericValue == 100000);
+}
+
+static void testTimeout()
+{
+	ExecutionLimits limits;
+	limits.timeoutMs = 50;
+	Interpreter::setExecutionLimits(limits);
+
+	CHECK_THROWS(Interpreter::evaluate("while (1) { }"), "Execution time limit of 50 ms exceeded");
+	CHECK_THROWS(Interpreter::evaluate("pfor (v : range(100000000)) { }"), "Execution time limit of 50 ms exceeded");
+	CHECK(value("n = 0; for (i = 0; i < 1000; i++) { n++; } n").m_numericValue == 1000);
+
+	Interpreter::setExecutionLimits(ExecutionLimits());
+}
+
+int main()
+{
+	startTests();
+
+	testSteps();
+	testTimeout();
+
+	return finishTests();
+}
@@ -0,0 +1,101 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <thread>
+
+#include "Test.h"
+
+//the value of the script with the variables of the environment, like value()
+static Variable evaluateIn(Environment& environment, const string& script)
+{
+	Interpreter::swapEnvironment(environment);
+	Variable result;
+	try
+	{
+		result = Interpreter::evaluate(script + ";");
+	}
+	catch (...)
+	{
+		Interpreter::swapEnvironment(environment);
+		throw;
+	}
+	Interpreter::swapEnvironment(environment);
+	return result;
+}
+
+static void testCopyOnWrite()
+{
+	Interpreter::evaluate("count = 1; items = array(1, 2, 3); table = map(); table[\"k\"] = \"v\"; nested = array(array(1));");
+	Environment child = Interpreter::fork();
+
+	//the fork reads the values of the parent and writes its own copies
+	CHECK(evaluateIn(child, "size(items)").m_numericValue == 3);
+	evaluateIn(child, "count = 2; items[0] = 10; push(items, 4); table[\"k\"] = \"w\"; added = 5;");
+	CHECK(evaluateIn(child, "items[0] + size(items) + count").m_numericValue == 16);
+	CHECK(evaluateIn(child, "table[\"k\"]").m_stringValue == "w");
+
+	CHECK(value("count").m_numericValue == 1);
+	CHECK(value("items[0] + size(items)").m_numericValue == 4);
+	CHECK(value("table[\"k\"]").m_stringValue == "v");
+	CHECK(ParserFunction::getGlobalValues().count("added") == 0);
+
+	//writes of the parent after the fork aren't seen by the child either
+	Interpreter::evaluate("items[1] = 20; remove(items, 0); count = 3;");
+	CHECK(evaluateIn(child, "items[1] + count").m_numericValue == 4);
+	CHECK(value("items[0] + count").m_numericValue == 23);
+
+	Interpreter::evaluate("nested[0][0] = 7;");
+	CHECK(evaluateIn(child, "nested[0][0]").m_numericValue == 1);
+
+	//a fork of a fork
+	Environment grandchild;
+	Interpreter::swapEnvironment(child);
+	grandchild = Interpreter::fork();
+	Interpreter::swapEnvironment(child);
+	evaluateIn(grandchild, "items[0] = 100;");
+	CHECK(evaluateIn(grandchild, "items[0] + added").m_numericValue == 105);
+	CHECK(evaluateIn(child, "items[0]").m_numericValue == 10);
+}
+
+static void testThreads()
+{
+	Interpreter::evaluate("values = array(); for (i = 0; i < 1000; i++) { push(values, i); }");
+
+	//every thread runs its own forks, all of them read the same array
+	const size_t THREADS = 4;
+	vector<Environment> forks;
+	for (size_t i = 0; i < THREADS; i++)
+	{
+		forks.push_back(Interpreter::fork());
+	}
+
+	vector<double> sums(THREADS);
+	vector<thread> threads;
+	for (size_t i = 0; i < THREADS; i++)
+	{
+		threads.emplace_back([&forks, &sums, i]()
+		{
+			ParsingException::setRecoverable(true);
+			sums[i] = evaluateIn(forks[i], "values[0] = " + to_string(i) + "; s = 0; for (v : values) { s += v; } s").m_numericValue;
+		});
+	}
+	for (thread& worker : threads)
+	{
+		worker.join();
+	}
+
+	for (size_t i = 0; i < THREADS; i++)
+	{
+		CHECK(sums[i] == 499500 + i);
+	}
+	CHECK(value("values[0]").m_numericValue == 0);
+}
+
+int main()
+{
+	startTests();
+
+	testCopyOnWrite();
+	testThreads();
+
+	return finishTests();
+}
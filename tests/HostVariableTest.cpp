@@ -0,0 +1,62 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+static double  g_rate = 1.5;
+static int64_t g_count = 0;
+static string  g_name = "start";
+static double  g_limit = 100;
+
+static void testReadWrite()
+{
+	Interpreter::bindVariable("rate", g_rate);
+	Interpreter::bindVariable("count", g_count);
+	Interpreter::bindVariable("name", g_name);
+	Interpreter::bindVariable("limit", g_limit, true);
+
+	CHECK(value("rate * 2").m_numericValue == 3);
+	CHECK(value("name").m_stringValue == "start");
+
+	//assignments of every kind write to the memory of the host
+	Interpreter::evaluate("rate = 2.5; count += 3; count++; name = name + \"ed\";");
+	CHECK(g_rate == 2.5);
+	CHECK(g_count == 4);
+	CHECK(g_name == "started");
+
+	Interpreter::evaluate("for (count = 0; count < 10; count++) { }");
+	CHECK(g_count == 10);
+
+	//changes of the host are seen by the next evaluation
+	g_rate = 7;
+	g_name = "host";
+	CHECK(value("rate").m_numericValue == 7);
+	CHECK(value("name + limit").m_stringValue == "host100");
+}
+
+static void testParallel()
+{
+	g_limit = 3;
+	CHECK(value("s = 0; pfor (i : range(0, 100); sum(s)) { s += limit; } s").m_numericValue == 300);
+}
+
+static void testErrors()
+{
+	CHECK_THROWS(Interpreter::evaluate("limit = 5;"), "The host variable [limit] is read only");
+	CHECK(g_limit == 3);
+
+	CHECK_THROWS(Interpreter::evaluate("rate = \"fast\";"), "expects a number but got [fast]");
+	CHECK_THROWS(Interpreter::evaluate("name = 4;"), "expects a string but got [4]");
+	CHECK_THROWS(Interpreter::evaluate("count = 2.5;"), "Expecting an integer");
+	CHECK(g_count == 10);
+}
+
+int main()
+{
+	startTests();
+
+	testReadWrite();
+	testParallel();
+	testErrors();
+
+	return finishTests();
+}
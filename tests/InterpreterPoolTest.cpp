@@ -0,0 +1,100 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <thread>
+
+#include "InterpreterPool.h"
+#include "Test.h"
+
+static void testReset()
+{
+	Interpreter::evaluate("limit = 10; table = array(1, 2, 3);");
+	InterpreterPool pool(2);
+	CHECK(pool.available() == 2);
+
+	//the variables of the preamble are there, whatever a request changes is gone afterwards
+	{
+		InterpreterPool::Lease lease(pool);
+		CHECK(pool.available() == 1);
+		CHECK(lease.evaluate("limit + size(table);").m_numericValue == 13);
+		lease.evaluate("limit = 0; table[0] = 100; push(table, 4); request = 1;");
+		CHECK(lease.evaluate("limit + table[0];").m_numericValue == 100);
+	}
+	CHECK(pool.available() == 2);
+
+	for (int i = 0; i < 3; i++)
+	{
+		InterpreterPool::Lease lease(pool);
+		CHECK(lease.evaluate("limit + table[0] + size(table);").m_numericValue == 14);
+		CHECK(ParserFunction::getGlobalValues().count("request") == 0);
+		lease.evaluate("request = 1;");
+	}
+
+	//the lease gives the thread its own variables back
+	CHECK(value("limit").m_numericValue == 10);
+	CHECK(ParserFunction::getGlobalValues().count("request") == 0);
+
+	//an error of a request doesn't keep the environment
+	CHECK_THROWS(InterpreterPool::Lease lease(pool); lease.evaluate("limit = 1; size(limit, 2);"), "arguments mismatch");
+	CHECK(value("limit").m_numericValue == 10);
+	CHECK(pool.available() == 2);
+}
+
+static void testExhausted()
+{
+	InterpreterPool pool(1);
+	Environment first = pool.acquire();
+	Environment second = pool.acquire();
+	CHECK(pool.available() == 0);
+
+	pool.release(move(first));
+	pool.release(move(second));
+	CHECK(pool.available() == 2);
+}
+
+static void testThreads()
+{
+	InterpreterPool pool(2);
+
+	//more threads than environments, every request finds the preamble as it was
+	const size_t THREADS = 4;
+	const size_t REQUESTS = 50;
+	vector<size_t> fresh(THREADS);
+	vector<thread> threads;
+	for (size_t i = 0; i < THREADS; i++)
+	{
+		threads.emplace_back([&pool, &fresh, i]()
+		{
+			ParsingException::setRecoverable(true);
+			for (size_t j = 0; j < REQUESTS; j++)
+			{
+				InterpreterPool::Lease lease(pool);
+				if (lease.evaluate("limit + size(table);").m_numericValue == 13)
+				{
+					fresh[i]++;
+				}
+				lease.evaluate("limit = " + to_string(i) + "; push(table, 1);");
+			}
+		});
+	}
+	for (thread& worker : threads)
+	{
+		worker.join();
+	}
+
+	for (size_t i = 0; i < THREADS; i++)
+	{
+		CHECK(fresh[i] == REQUESTS);
+	}
+	CHECK(pool.available() >= 2);
+}
+
+int main()
+{
+	startTests();
+
+	testReset();
+	testExhausted();
+	testThreads();
+
+	return finishTests();
+}
@@ -0,0 +1,86 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Json.h"
+#include "ParserFunction.h"
+#include "Test.h"
+
+static ScriptJson* toJson(const Variable& value)
+{
+	return value.m_type == Tokens::JSON ? static_cast<ScriptJson*>(value.m_object.get()) : nullptr;
+}
+
+static void testParse()
+{
+	Variable document = Json::parse(" {\"name\": \"a\\\"b\\u00e9\", \"items\": [1, -2.5e2, true, null, {\"deep\": [[]]}], \"empty\": {}} ");
+	ScriptJson* root = toJson(document);
+	CHECK(root != nullptr && root->isObject() && root->size() == 3);
+	CHECK(root->keyAt(1).m_stringValue == "items");
+	CHECK(root->contains(Variable(string("empty"))) && !root->contains(Variable(string("missing"))));
+
+	CHECK(root->getElement(Variable(string("name"))).m_stringValue == "a\"b\xc3\xa9");
+	CHECK(root->getElement(Variable(string("missing"))).m_type == Tokens::VOID);
+
+	Variable list = root->getElement(Variable(string("items")));
+	ScriptJson* items = toJson(list);
+	CHECK(items != nullptr && !items->isObject() && items->size() == 5);
+	CHECK(items->getElement(Variable(1.0)).m_numericValue == -250);
+	CHECK(items->valueAt(2).m_type == Tokens::NUMERIC && items->valueAt(2).m_numericValue == 1);
+	CHECK(items->valueAt(3).m_type == Tokens::VOID);
+	CHECK(toJson(items->valueAt(4))->toString() == "{\"deep\":[[]]}");
+
+	//scalars are not wrapped into a document
+	CHECK(Json::parse("42").m_numericValue == 42);
+	CHECK(Json::parse("\"text\"").m_stringValue == "text");
+}
+
+static void testScripts()
+{
+	//the quotes of JSON can't be written in a string of a script
+	ParserFunction::assignVariable("text", Variable(string("{\"a\": [10, 20, 30], \"b\": {\"c\": \"x\"}}")));
+	Interpreter::evaluate("doc = jsonParse(text);");
+	CHECK(value("doc[\"a\"][2]").m_numericValue == 30);
+	CHECK(value("doc[\"b\"][\"c\"]").m_stringValue == "x");
+	CHECK(value("total = 0; for (v : doc[\"a\"]) { total += v; } total").m_numericValue == 60);
+	CHECK(value("keys = \"\"; for (k : doc) { keys += k; } keys").m_stringValue == "ab");
+
+	//the text of a parsed value is written back as it is
+	CHECK(value("jsonStringify(doc[\"b\"])").m_stringValue == "{\"c\":\"x\"}");
+
+	Interpreter::evaluate("m = map(); m[\"n\"] = 1.5; m[\"s\"] = \"q\"; m[\"l\"] = array(1, \"two\");");
+	string text = value("jsonStringify(m)").m_stringValue;
+	CHECK(text.find("\"n\":1.5") != string::npos);
+	CHECK(text.find("\"s\":\"q\"") != string::npos);
+	CHECK(text.find("\"l\":[1,\"two\"]") != string::npos);
+	CHECK(Json::stringify(Json::parse(text)) == text);
+
+	CHECK(Json::stringify(Variable(string("a\"\\\n\x01"))) == "\"a\\\"\\\\\\n\\u0001\"");
+	CHECK(Json::stringify(Variable(0.1)) == "0.1");
+	CHECK(strtod(Json::stringify(Variable(1.0 / 3)).c_str(), nullptr) == 1.0 / 3);
+}
+
+static void testErrors()
+{
+	CHECK_THROWS(Json::parse("{\"a\": 1,}"), "expecting the key of a member");
+	CHECK_THROWS(Json::parse("[1, 2"), "Invalid JSON at position 5");
+	CHECK_THROWS(Json::parse("[1] x"), "unexpected text after the value");
+	CHECK_THROWS(Json::parse("\"\\q\""), "invalid escape sequence");
+	CHECK_THROWS(Json::parse("-"), "expecting a digit");
+
+	//the outermost value has the depth 0
+	CHECK_THROWS(Json::parse(string(JsonDocument::MAX_DEPTH + 2, '[') + string(JsonDocument::MAX_DEPTH + 2, ']')), "nested too deep");
+	CHECK(toJson(Json::parse(string(JsonDocument::MAX_DEPTH + 1, '[') + string(JsonDocument::MAX_DEPTH + 1, ']'))) != nullptr);
+
+	CHECK_THROWS(Interpreter::evaluate("doc[\"a\"][0] = 1;"), "Values of jsonParse() are read only");
+	CHECK_THROWS(Interpreter::evaluate("doc[\"a\"][3];"), "Index [3] is out of bounds, the array has 3 elements");
+}
+
+int main()
+{
+	startTests();
+
+	testParse();
+	testScripts();
+	testErrors();
+
+	return finishTests();
+}
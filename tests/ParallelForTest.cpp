@@ -0,0 +1,62 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+static void testReductions()
+{
+	//every chunk starts a sum from zero, the total adds the value before the loop
+	CHECK(value("s = 100; pfor (i : range(0, 1000); sum(s)) { s += i; } s").m_numericValue == 499600);
+	CHECK(value("n = 0; pfor (i : range(0, 0); sum(n)) { n += 1; } n").m_numericValue == 0);
+	CHECK(value("m = map(); m[\"a\"] = 1; m[\"b\"] = 2; s = 0; pfor (k : m; sum(s)) { s += m[k]; } s").m_numericValue == 3);
+
+	//strings are joined in the order of the items, whichever chunk finished first
+	CHECK(value("t = \"x\"; pfor (w : array(\"a\", \"b\", \"c\", \"d\"); sum(t)) { t += w; } t").m_stringValue == "xabcd");
+
+	//min and max start from the value before the loop
+	CHECK(value("lo = 5000; pfor (i : range(1, 1000); min(lo)) { v = i * 7 % 1001; if (v < lo) { lo = v; } } lo").m_numericValue == 0);
+	CHECK(value("hi = 0; pfor (i : range(0, 1000); max(hi)) { v = i * 7 % 1001; if (v > hi) { hi = v; } } hi").m_numericValue == 994);
+	CHECK(value("lo = -3; pfor (i : range(0, 100); min(lo)) { if (i < lo) { lo = i; } } lo").m_numericValue == -3);
+	CHECK(value("w = \"m\"; pfor (s : array(\"k\", \"q\", \"a\"); max(w)) { if (s > w) { w = s; } } w").m_stringValue == "q");
+
+	//other variables of the body are copies
+	CHECK(value("x = 0; pfor (i : range(0, 10)) { x += i; } x").m_numericValue == 0);
+}
+
+static void testSharedArray()
+{
+	//the chunks write to distinct elements of the same array
+	Interpreter::evaluate("a = array(); for (i = 0; i < 500; i++) { push(a, 0); } pfor (i : range(0, 500)) { a[i] = i * 2; }");
+	CHECK(value("c = 0; for (v : a) { c += v; } c").m_numericValue == 249500);
+	CHECK(value("a[0] + a[499]").m_numericValue == 998);
+}
+
+static void testNested()
+{
+	//an inner pfor runs on the worker of its chunk like a for loop
+	CHECK(value("total = 0; pfor (i : range(0, 10); sum(total)) { pfor (j : range(0, 10)) { total += j * i; } } total").m_numericValue == 2025);
+	CHECK(value("total = 0; pfor (i : range(0, 10); sum(total)) { pfor (j : range(0, 10); sum(total)) { total += 1; } } total").m_numericValue == 100);
+}
+
+static void testErrors()
+{
+	CHECK_THROWS(Interpreter::evaluate("pfor (i : range(0, 100)) { if (i == 50) { break; } }"), "break is not supported in a pfor loop");
+	CHECK_THROWS(Interpreter::evaluate("pfor (i : range(0, 10); avg(x)) { }"), "Expecting a reduction like sum(name), min(name) or max(name) but got [avg(x)]");
+	CHECK_THROWS(Interpreter::evaluate("pfor (i : range(0, 10); min(undefinedName)) { }"), "[undefinedName] has to be set before the pfor loop");
+	CHECK_THROWS(Interpreter::evaluate("pfor (i = 0; i < 10; i++) { }"), "Expecting \"pfor (item : collection; reductions)\"");
+
+	//an error of a worker reaches the caller
+	CHECK_THROWS(Interpreter::evaluate("pfor (i : range(0, 100)) { size(i, 2); }"), "arguments mismatch");
+	CHECK(value("s = 0; pfor (i : range(0, 4); sum(s)) { s += 1; } s").m_numericValue == 4);
+}
+
+int main()
+{
+	startTests();
+
+	testReductions();
+	testSharedArray();
+	testNested();
+	testErrors();
+
+	return finishTests();
+}
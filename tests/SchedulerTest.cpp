@@ -0,0 +1,71 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+//a script with the expression nested in depth parentheses
+static string nested(const string& expression, size_t depth)
+{
+	return string(depth, '(') + expression + string(depth, ')');
+}
+
+static void testAwait()
+{
+	CHECK(value("t = spawn() { 6 * 7; }; await(t)").m_numericValue == 42);
+
+	//the result stays with the task after it is done
+	CHECK(value("await(t) + await(t)").m_numericValue == 84);
+
+	//a task starts with the variables of its creator, collections are shared
+	Interpreter::evaluate("base = 10; log = array(); t = spawn() { push(log, base); base = 0; base; };");
+	CHECK(value("await(t)").m_numericValue == 0);
+	CHECK(value("base + size(log) + log[0]").m_numericValue == 21);
+}
+
+static void testOrder()
+{
+	//yield() lets the other tasks run, sleep() wakes the earliest first
+	Interpreter::evaluate("order = array(); "
+		"a = spawn() { push(order, \"a1\"); yield(); push(order, \"a2\"); }; "
+		"b = spawn() { push(order, \"b1\"); yield(); push(order, \"b2\"); }; "
+		"await(a); await(b);");
+	CHECK(value("order").toString() == "[\"a1\", \"b1\", \"a2\", \"b2\"]");
+
+	Interpreter::evaluate("order = array(); "
+		"slow = spawn() { sleep(30); push(order, \"slow\"); }; "
+		"fast = spawn() { sleep(5); push(order, \"fast\"); }; "
+		"await(slow);");
+	CHECK(value("order").toString() == "[\"fast\", \"slow\"]");
+}
+
+static void testDeepNesting()
+{
+	//a task has a stack as large as the one of the main thread
+	string expression = nested("y", 1000);
+	CHECK(value("t = spawn() { y = 5; x = " + expression + "; x; }; await(t)").m_numericValue == 5);
+	CHECK(value("y = 3; " + expression).m_numericValue == 3);
+
+	//many tasks at once only use the stack they need
+	CHECK(value("tasks = array(); for (i = 0; i < 2000; i++) { push(tasks, spawn() { yield(); 1; }); } "
+		"s = 0; for (t : tasks) { s += await(t); } s").m_numericValue == 2000);
+}
+
+static void testErrors()
+{
+	CHECK_THROWS(Interpreter::evaluate("await(5);"), "await() expects a task created by spawn()");
+
+	//an error of a task reaches the script that awaits it
+	CHECK_THROWS(Interpreter::evaluate("t = spawn() { size(1, 2); }; await(t);"), "arguments mismatch");
+	CHECK(value("t = spawn() { 1; }; await(t)").m_numericValue == 1);
+}
+
+int main()
+{
+	startTests();
+
+	testAwait();
+	testOrder();
+	testDeepNesting();
+	testErrors();
+
+	return finishTests();
+}
@@ -0,0 +1,82 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Test.h"
+
+//the converted script, after the optimization
+static string converted(const string& script)
+{
+	return Interpreter::prepare(script + ";").data;
+}
+
+//the value of the script with the optimization, it has to be the same without it
+static Variable compare(const string& script)
+{
+	Interpreter::setOptimization(false);
+	Variable plain = value(script);
+	Interpreter::setOptimization(true);
+	Variable optimized = value(script);
+
+	CHECK(plain.m_type == optimized.m_type && plain.toString() == optimized.toString());
+	return optimized;
+}
+
+static void testFolding()
+{
+	CHECK(converted("x = 20 + 10 * 5") == "x=70;");
+	CHECK(compare("x = 20 + 10 * 5; x").m_numericValue == 70);
+	CHECK(converted("x * (2 - 5)") == "x*(-3);");
+	CHECK(compare("x = 2; x * (2 - 5)").m_numericValue == -6);
+	CHECK(compare("7 / 2").m_numericValue == 3.5);
+
+	//&& and || skip the rest of the expression, % could divide by zero
+	CHECK(converted("a = 1 && 0") == "a=1&&0;");
+	CHECK(compare("a = 1 && 0; a").m_numericValue == 0);
+	CHECK(converted("b = 7 % 3") == "b=1;");
+}
+
+static void testStrings()
+{
+	//strings are joined from the left, like at runtime
+	CHECK(converted("s = \"a\" + \"b\" + 1") == "s=\"ab1\";");
+	CHECK(compare("s = \"a\" + \"b\" + 1; s").m_stringValue == "ab1");
+	CHECK(compare("s = \"5\" + 1 + 2; s").m_stringValue == "512");
+	CHECK(compare("s = 1 + 2 + \"5\"; s").m_stringValue == "35");
+
+	//the multiplication is folded first, the string stays an action of the script
+	CHECK(converted("s = \"n\" + 2 * 3") == "s=\"n\"+6;");
+	CHECK(compare("s = \"n\" + 2 * 3; s").m_stringValue == "n6");
+	CHECK(compare("s = \"v=\" + (1 + 2) * 2; s").m_stringValue == "v=6");
+	CHECK(compare("\"ab\" == \"ab\"").m_numericValue == 1);
+}
+
+static void testBranches()
+{
+	//branches that never run are removed
+	CHECK(converted("x = 0; if (0) { x = 1; } x") == "x=0;x;");
+	CHECK(compare("x = 0; if (0) { x = 1; } x").m_numericValue == 0);
+	CHECK(converted("x = 0; while (0) { x = 1; } x") == "x=0;x;");
+	CHECK(compare("x = 0; if (0) { x = 1; } eif (0) { x = 2; } x").m_numericValue == 0);
+
+	//the first branch that always runs ends the chain
+	CHECK(converted("x = 0; if (0) { x = 1; } eif (1) { x = 2; } else { x = 3; } x") == "x=0;if(1){x=2;}x;");
+	CHECK(compare("x = 0; if (0) { x = 1; } eif (1) { x = 2; } else { x = 3; } x").m_numericValue == 2);
+	CHECK(compare("x = 0; if (1) { x = 1; } else { x = 2; } x = x + 10; x").m_numericValue == 11);
+	CHECK(compare("x = 3; if (0) { x = 1; } else { x = 4; } x").m_numericValue == 4);
+
+	//a condition that isn't constant keeps its branch
+	CHECK(converted("x = 5; if (x > 3) { x = 1; } eif (1) { x = 2; } else { x = 3; } x") == "x=5;if(x>3){x=1;}else{x=2;}x;");
+	CHECK(compare("x = 5; if (x > 3) { x = 1; } eif (1) { x = 2; } else { x = 3; } x").m_numericValue == 1);
+	CHECK(compare("x = 1; if (x > 3) { x = 1; } eif (1) { x = 2; } else { x = 3; } x").m_numericValue == 2);
+	CHECK(compare("n = 0; for (i : range(0, 3)) { if (n > 0) { n += 1; } n++; } n").m_numericValue == 5);
+}
+
+int main()
+{
+	startTests();
+
+	testFolding();
+	testStrings();
+	testBranches();
+
+	return finishTests();
+}
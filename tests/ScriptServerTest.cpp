@@ -0,0 +1,254 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "ScriptServer.h"
+#include "Test.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char* SOCKET_PATH = "ScriptServerTest.sock";
+
+//the answer of the daemon to one request
+struct Answer
+{
+	string output;
+	string status; //done, error or closed if the connection ended before
+	string error;
+};
+
+static void writeFile(const string& path, const string& text)
+{
+	ofstream out(path, ios::binary);
+	out << text;
+}
+
+static int connectToServer()
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, SOCKET_PATH, sizeof(address.sun_path) - 1);
+
+	//the daemon starts listening on its own thread
+	for (int attempt = 0; attempt < 500; attempt++)
+	{
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (connect(fd, (sockaddr*)&address, sizeof(address)) == 0)
+		{
+			return fd;
+		}
+		close(fd);
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+	return -1;
+}
+
+static bool sendText(int fd, const string& text)
+{
+	size_t sent = 0;
+	while (sent < text.size())
+	{
+		ssize_t count = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+		if (count <= 0)
+		{
+			return false;
+		}
+		sent += count;
+	}
+	return true;
+}
+
+//reads a line or the number of bytes, false if the connection ended before
+static bool receive(int fd, string& buffer, size_t bytes, string& text)
+{
+	while (true)
+	{
+		size_t end = bytes > 0 ? (buffer.size() >= bytes ? bytes : string::npos) : buffer.find('\n');
+		if (end != string::npos)
+		{
+			text = buffer.substr(0, end);
+			buffer.erase(0, bytes > 0 ? end : end + 1);
+			return true;
+		}
+
+		char chunk[4096];
+		ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+		if (count <= 0)
+		{
+			return false;
+		}
+		buffer.append(chunk, count);
+	}
+}
+
+static Answer readAnswer(int fd, string& buffer)
+{
+	Answer answer;
+	string line;
+	while (receive(fd, buffer, 0, line))
+	{
+		if (line == "done")
+		{
+			answer.status = line;
+			return answer;
+		}
+
+		size_t space = line.find(' ');
+		size_t length = space != string::npos ? stoul(line.substr(space + 1)) : 0;
+		string text;
+		if (length > 0 && !receive(fd, buffer, length, text))
+		{
+			break;
+		}
+		if (line.compare(0, space, "output") == 0)
+		{
+			answer.output += text;
+			continue;
+		}
+
+		answer.status = line.substr(0, space);
+		answer.error = text;
+		return answer;
+	}
+
+	answer.status = "closed";
+	return answer;
+}
+
+static void testRequests()
+{
+	writeFile("ScriptServerTest.xes", "print(\"hello \", who); total = n * 2; print(total);");
+	writeFile("ScriptServerTest2.xes", "print(\"before\"); x = size(1, 2);");
+
+	int fd = connectToServer();
+	CHECK(fd >= 0);
+	string buffer;
+
+	//the requests of a connection are answered one after another, in order
+	CHECK(sendText(fd, "{\"script\": \"ScriptServerTest.xes\", \"vars\": {\"who\": \"ann\", \"n\": 5}}\n\n"
+		"{\"script\": \"ScriptServerTest2.xes\"}\n"
+		"not json\n"
+		"{\"vars\": {}}\n"
+		"{\"script\": \"ScriptServerTest.missing\"}\n"
+		"{\"script\": \"ScriptServerTest.xes\", \"vars\": {\"who\": \"bob\", \"n\": 1}}\n"));
+
+	Answer answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "done" && answer.output == "hello ann\n10\n");
+
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "error" && answer.output == "before\n");
+	CHECK(answer.error.find("arguments mismatch") != string::npos);
+
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "error" && answer.error.find("Invalid JSON") != string::npos);
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "error" && answer.error.find("has no \"script\"") != string::npos);
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "error" && answer.error.find("Could not read the script") != string::npos);
+
+	//the variables of a request are gone in the next one
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "done" && answer.output == "hello bob\n2\n");
+
+	//a changed script is converted again, the last request may end without a new line
+	writeFile("ScriptServerTest.xes", "print(\"changed \", who);");
+	CHECK(sendText(fd, "{\"script\": \"ScriptServerTest.xes\", \"vars\": {\"who\": \"cy\"}}"));
+	shutdown(fd, SHUT_WR);
+	answer = readAnswer(fd, buffer);
+	CHECK(answer.status == "done" && answer.output == "changed cy\n");
+	CHECK(readAnswer(fd, buffer).status == "closed");
+	close(fd);
+
+	remove("ScriptServerTest.xes");
+	remove("ScriptServerTest2.xes");
+}
+
+static void testLongLine()
+{
+	//a line that never ends drops the connection, others are still served
+	int fd = connectToServer();
+	string line(ScriptServer::MAX_REQUEST_LINE + 1, 'x');
+	sendText(fd, line);
+	string buffer;
+	CHECK(readAnswer(fd, buffer).status == "closed");
+	close(fd);
+
+	fd = connectToServer();
+	CHECK(sendText(fd, "{\"vars\": {}}\n"));
+	CHECK(readAnswer(fd, buffer).status == "error");
+	close(fd);
+}
+
+//a socket file without a daemon, like one that was left behind by a crash
+static void createStaleSocket()
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, SOCKET_PATH, sizeof(address.sun_path) - 1);
+
+	remove(SOCKET_PATH);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	bind(fd, (sockaddr*)&address, sizeof(address));
+	close(fd);
+}
+
+static void testSocketFile()
+{
+	//a file that isn't a socket is never replaced or removed
+	writeFile("ScriptServerTest.txt", "precious");
+	{
+		ScriptServer other("ScriptServerTest.txt", 1);
+		CHECK_THROWS(other.run(), "Could not listen on [ScriptServerTest.txt]");
+	}
+	ifstream file("ScriptServerTest.txt");
+	string text;
+	CHECK(getline(file, text) && text == "precious");
+	remove("ScriptServerTest.txt");
+
+	//neither is the socket of a running daemon
+	{
+		ScriptServer other(SOCKET_PATH, 1);
+		CHECK_THROWS(other.run(), "Another daemon is serving");
+	}
+	int fd = connectToServer();
+	string buffer;
+	CHECK(sendText(fd, "{\"vars\": {}}\n"));
+	CHECK(readAnswer(fd, buffer).status == "error");
+	close(fd);
+}
+
+int main()
+{
+	startTests();
+
+	//the daemon replaces the stale socket
+	createStaleSocket();
+	ScriptServer server(SOCKET_PATH, 2);
+	thread daemon([&server]() { server.run(); });
+
+	testRequests();
+	testLongLine();
+	testSocketFile();
+
+	//the daemon stops like on SIGTERM
+	raise(SIGTERM);
+	daemon.join();
+
+	return finishTests();
+}
+
+#else
+
+int main()
+{
+	cout << "--serve is only supported on Linux" << endl;
+	return 0;
+}
+
+#endif
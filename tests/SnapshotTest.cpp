@@ -0,0 +1,58 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include "Snapshot.h"
+#include "Test.h"
+
+static void testRoundTrip()
+{
+	Interpreter::evaluate("count = 42; name = \"table\"; shared = array(1, 2); table = map(); table[\"a\"] = shared; table[\"b\"] = shared; "
+		"table[\"c\"] = \"text\"; steps = range(0, 10, 2); self = array(); push(self, self);");
+	Interpreter::saveSnapshot("SnapshotTest.bin");
+
+	Interpreter::evaluate("count = 0; name = 1; table = 2; later = 3;");
+	Interpreter::loadSnapshot("SnapshotTest.bin");
+	remove("SnapshotTest.bin");
+
+	CHECK(value("count").m_numericValue == 42);
+	CHECK(value("name").m_stringValue == "table");
+	CHECK(value("table[\"c\"]").m_stringValue == "text");
+	CHECK(value("size(steps)").m_numericValue == 5);
+
+	//a collection referenced twice is still shared after the restore
+	Interpreter::evaluate("push(table[\"a\"], 3);");
+	CHECK(value("size(table[\"b\"])").m_numericValue == 3);
+	CHECK(value("size(shared)").m_numericValue == 3);
+	CHECK(value("size(self[0][0])").m_numericValue == 1);
+
+	//the globals are replaced, not merged
+	CHECK(ParserFunction::getGlobalValues().count("later") == 0);
+}
+
+static void testErrors()
+{
+	string data = Snapshot::save();
+	CHECK_THROWS(Snapshot::restore(data.substr(0, data.size() - 1)), "The snapshot is corrupt");
+	CHECK_THROWS(Snapshot::restore(data + "x"), "unexpected data after its variables");
+	CHECK_THROWS(Snapshot::restore("XES?" + data.substr(4)), "not a snapshot");
+	CHECK_THROWS(Interpreter::loadSnapshot("SnapshotTest.missing"), "Could not read the snapshot");
+
+	//values that belong to the running process
+	Interpreter::evaluate("task = spawn() { 1; }");
+	CHECK_THROWS(Snapshot::save(), "Variable [task] holds a TASK");
+	Interpreter::evaluate("task = 0;");
+
+	Interpreter::evaluate("deep = array(); for (i = 0; i < 1100; i++) { deep = array(deep); }");
+	CHECK_THROWS(Snapshot::save(), "Variable [deep] is nested too deep");
+	Interpreter::evaluate("deep = 0;");
+	CHECK(Snapshot::save().size() > 0);
+}
+
+int main()
+{
+	startTests();
+
+	testRoundTrip();
+	testErrors();
+
+	return finishTests();
+}
@@ -0,0 +1,55 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#pragma once
+
+#include <iostream>
+
+#include "Interpreter.h"
+#include "ScriptHelper.h"
+
+/*
+*  Checks shared by the test programs, ctest runs every one of them.
+*  A failed check is printed with its line, the program keeps going and
+*  returns 1 at the end. Errors of the scripts become exceptions, so a
+*  test can expect them with CHECK_THROWS.
+*/
+static int g_failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_THROWS(statement, text) \
+	do \
+	{ \
+		bool thrown = false; \
+		try { statement; } \
+		catch (ParsingException& ex) { thrown = string(ex.what()).find(text) != string::npos; } \
+		check(thrown, #statement " throws [" text "]", __FILE__, __LINE__); \
+	} \
+	while (false)
+
+static inline void check(bool ok, const char* condition, const char* file, int line)
+{
+	if (!ok)
+	{
+		cout << file << ":" << line << ": check failed: " << condition << endl;
+		g_failures++;
+	}
+}
+
+static inline void startTests()
+{
+	Interpreter::initialize();
+	ParsingException::setRecoverable(true);
+}
+
+static inline int finishTests()
+{
+	cout << (g_failures == 0 ? "all checks passed" : to_string(g_failures) + " checks failed") << endl;
+	return g_failures == 0 ? 0 : 1;
+}
+
+//the value of an expression or a variable after the scripts of a test ran
+static inline Variable value(const string& expression)
+{
+	return Interpreter::evaluate(expression + ";");
+}
@@ -0,0 +1,53 @@
+//NOTE: project was based on https://github.com/vassilych/cscscpp
+
+#include <fstream>
+#include <sstream>
+
+#include "Test.h"
+
+static const char* TRACE_PATH = "TracerTest.json";
+
+static size_t count(const string& text, const string& what)
+{
+	size_t result = 0;
+	for (size_t i = text.find(what); i != string::npos; i = text.find(what, i + 1))
+	{
+		result++;
+	}
+	return result;
+}
+
+static void testErrors()
+{
+	Interpreter::startTrace(TRACE_PATH);
+
+	//errors of builtin functions leave the scopes of the statement, the loop and the script
+	CHECK_THROWS(Interpreter::evaluate("x = 1;\nsize(1, 2);"), "arguments mismatch");
+	CHECK_THROWS(Interpreter::evaluate("for (i = 0; i < 3; i++) { if (i == 2) { size(i, 2); } }"), "arguments mismatch");
+	CHECK(value("size(array(1, 2))").m_numericValue == 2);
+
+	Interpreter::stopTrace();
+
+	ifstream file(TRACE_PATH);
+	stringstream text;
+	text << file.rdbuf();
+	string trace = text.str();
+
+	//every begin event is closed, the trace still shows the failing calls
+	size_t begins = count(trace, "\"ph\":\"B\"");
+	CHECK(begins > 0);
+	CHECK(begins == count(trace, "\"ph\":\"E\""));
+	CHECK(count(trace, "\"name\":\"size\"") == 3);
+
+	file.close();
+	remove(TRACE_PATH);
+}
+
+int main()
+{
+	startTests();
+
+	testErrors();
+
+	return finishTests();
+}